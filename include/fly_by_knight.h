@@ -78,6 +78,17 @@ bool fbk_commit_move(fbk_instance_s * fbk, ftk_move_s * move);
  */
 bool fbk_undo_move(fbk_instance_s * fbk);
 
+/**
+ * @brief Switches between neural network and classical evaluation.  Scores in the move tree came from the previous 
+ *        evaluator, so analysis is stopped and the tree's analysis is flushed, keeping only the game's path
+ * 
+ * @param fbk 
+ * @param nnue true to evaluate with the neural network
+ * @return true if successful
+ * @return false if the neural network is requested but not loaded
+ */
+bool fbk_set_evaluator(fbk_instance_s * fbk, bool nnue);
+
 /**
  * @brief Get the time spent on the current move in ms
  * 
@@ -0,0 +1,44 @@
+/*
+ fly_by_knight_affinity.h
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ CPU core detection and thread affinity for Fly by Knight
+*/
+
+#ifndef __FLY_BY_KNIGHT_AFFINITY_H__
+#define __FLY_BY_KNIGHT_AFFINITY_H__
+
+#include "fly_by_knight_types.h"
+
+/**
+ * @brief Captures the CPU cores available to this process and their NUMA topology.  Must be called before any thread
+ *        is pinned.
+ */
+void fbk_init_cpu_affinity();
+
+/**
+ * @brief Returns the number of cores available to this process based on the CPU affinity mask and cgroup CPU quota
+ *
+ * @return number of available cores, at least 1
+ */
+unsigned int fbk_get_available_core_count();
+
+/**
+ * @brief Pins the calling thread to a single available core.  Physical cores of all NUMA nodes are assigned before
+ *        any SMT sibling, grouped by NUMA node.
+ *
+ * @param thread_index index of calling thread, indices beyond the available cores wrap around
+ * @return true if thread was pinned
+ */
+bool fbk_pin_thread(fbk_thread_index_t thread_index);
+
+/**
+ * @brief Restores the calling thread's affinity to all cores available to this process
+ *
+ * @return true if successful
+ */
+bool fbk_unpin_thread();
+
+#endif /* __FLY_BY_KNIGHT_AFFINITY_H__ */
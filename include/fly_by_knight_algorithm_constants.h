@@ -58,32 +58,22 @@
 
 /* Doubled pawn base penalty (base*2^(doubled_pawn_count-2))*/
 #define FBK_SCORE_DOUBLE_PAWN_BASE_PENALTY (FBK_SCORE_PAWN/50)
+/* Penalty for each pawn without friendly pawns on adjacent files */
+#define FBK_SCORE_ISOLATED_PAWN_PENALTY    (FBK_SCORE_PAWN/20)
+/* Bonus for each pawn without enemy pawns ahead on its own or adjacent files, by rank from the pawn's side */
+#define FBK_SCORE_PASSED_PAWN_SECOND_ROW   (( 1*FBK_SCORE_PAWN) / 20)
+#define FBK_SCORE_PASSED_PAWN_THIRD_ROW    (( 1*FBK_SCORE_PAWN) / 20)
+#define FBK_SCORE_PASSED_PAWN_FOURTH_ROW   (( 2*FBK_SCORE_PAWN) / 20)
+#define FBK_SCORE_PASSED_PAWN_FIFTH_ROW    (( 4*FBK_SCORE_PAWN) / 20)
+#define FBK_SCORE_PASSED_PAWN_SIXTH_ROW    (( 7*FBK_SCORE_PAWN) / 20)
+#define FBK_SCORE_PASSED_PAWN_SEVENTH_ROW  ((12*FBK_SCORE_PAWN) / 20)
 
-#define FBK_SCORE_PAWN_CENTER_SQUARE ((10*FBK_SCORE_PAWN) / 50)
-
-#define FBK_SCORE_PAWN_SEVENTH_ROW   (( 5*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_PAWN_SIXTH_ROW     (( 4*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_PAWN_FIFTH_ROW     (( 3*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_PAWN_FOURTH_ROW    (( 2*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_PAWN_THIRD_ROW     (( 1*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_PAWN_SECOND_ROW    (( 0*FBK_SCORE_PAWN) / 50)
-
-#define FBK_SCORE_KNIGHT_EIGHTH_ROW  (( 0*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_SEVENTH_ROW (( 3*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_SIXTH_ROW   ((10*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FIFTH_ROW   (( 7*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FOURTH_ROW  (( 5*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_THIRD_ROW   (( 3*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_SECOND_ROW  (( 0*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FIRST_ROW   (( 0*FBK_SCORE_PAWN) / 50)
-
-#define FBK_SCORE_KNIGHT_FILE_A      (( 0*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FILE_B      (( 1*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FILE_C      (( 3*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FILE_D      (( 5*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FILE_E      (( 5*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FILE_F      (( 3*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FILE_G      (( 1*FBK_SCORE_PAWN) / 50)
-#define FBK_SCORE_KNIGHT_FILE_H      (( 0*FBK_SCORE_PAWN) / 50)
+/* Game phase weight of each piece type, phase is the sum over all pieces on the board.  Piece-square scores are 
+   interpolated between middlegame (FBK_PHASE_MAX and above) and endgame (0) tables */
+#define FBK_PHASE_KNIGHT 1
+#define FBK_PHASE_BISHOP 1
+#define FBK_PHASE_ROOK   2
+#define FBK_PHASE_QUEEN  4
+#define FBK_PHASE_MAX    (4*FBK_PHASE_KNIGHT + 4*FBK_PHASE_BISHOP + 4*FBK_PHASE_ROOK + 2*FBK_PHASE_QUEEN)
 
 #endif //_FLY_BY_KNIGHT_ALGORITHM_CONSTANTS_H_
\ No newline at end of file
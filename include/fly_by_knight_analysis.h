@@ -13,7 +13,7 @@
 #include "fly_by_knight_types.h"
 
 /**
- * @brief Initialized Look-Up Tables for Fly by Knight analysis
+ * @brief Initializes Fly by Knight analysis.  Piece-square tables are static data, this selects the evaluation kernels
  * 
  * @return true if successful
  */
@@ -28,16 +28,165 @@ bool fbk_init_analysis_lut();
  */
 fbk_score_t fbk_score_game(const ftk_game_s * game);
 
+/* Evaluation cache lookups counted by each thread */
+typedef struct
+{
+  /* Pawn structure scores found in and missing from the thread's pawn hash table */
+  uint_fast64_t pawn_hash_hits;
+  uint_fast64_t pawn_hash_misses;
+  /* Position evaluations found in and missing from the shared evaluation cache */
+  uint_fast64_t eval_cache_hits;
+  uint_fast64_t eval_cache_misses;
+} fbk_eval_counts_s;
+
+/**
+ * @brief Returns and resets the calling thread's evaluation cache lookup counts
+ * 
+ * @param counts output lookup counts
+ */
+void fbk_take_eval_counts(fbk_eval_counts_s * counts);
+
+/**
+ * @brief Allocates the shared evaluation cache, replacing any previous cache.  Must only be called while analysis is 
+ *        stopped
+ * 
+ * @param size_mb cache size in MiB, rounded down to a power of 2 entry count.  0 disables the cache
+ */
+void fbk_init_eval_cache(unsigned int size_mb);
+
+/**
+ * @brief Estimates how full the evaluation cache is from a sample of its entries
+ * 
+ * @return occupied entries per thousand, 0 if the cache is disabled
+ */
+unsigned int fbk_eval_cache_permille();
+
+/* Maximum number of squares changed by a single move (castling) */
+#define FBK_INCREMENTAL_EVAL_MAX_MOVE_SQUARES 4
+
+/**
+ * @brief Initializes incremental evaluation with a full scan of given game, building piece bitboards
+ * 
+ * @param eval incremental evaluation to initialize
+ * @param game game to scan
+ */
+void fbk_init_incremental_eval(fbk_incremental_eval_s * eval, const ftk_game_s * game);
+
+/**
+ * @brief Lists the squares which may change when move is applied or undone
+ * 
+ * @param board   board the move is applied to or undone from
+ * @param move    move of interest
+ * @param applied true if move is currently applied to board
+ * @param squares output array of squares
+ * 
+ * @return number of squares listed
+ */
+unsigned int fbk_incremental_eval_move_squares(const ftk_board_s * board, const ftk_move_s * move, bool applied, 
+                                               ftk_square_e squares[FBK_INCREMENTAL_EVAL_MAX_MOVE_SQUARES]);
+
+/**
+ * @brief Adds or removes the contribution of given squares to incremental evaluation.  Called with sign -1 before a 
+ *        move is applied or undone and sign 1 after
+ * 
+ * @param eval    incremental evaluation to update
+ * @param board   current board
+ * @param squares squares to update
+ * @param count   number of squares
+ * @param sign    1 to add, -1 to remove
+ */
+void fbk_update_incremental_eval(fbk_incremental_eval_s * eval, const ftk_board_s * board, const ftk_square_e squares[], unsigned int count, int sign);
+
+/**
+ * @brief Score game position for white or black advantage using incremental evaluation and piece bitboards.  Board 
+ *        masks must be updated.  Matches fbk_score_game exactly with the evaluation kernels selected for this CPU
+ * 
+ * @param game to analyze
+ * @param eval incremental evaluation matching game
+ * @return fbk_score_t 
+ */
+fbk_score_t fbk_score_game_incremental(const ftk_game_s * game, const fbk_incremental_eval_s * eval);
+
+/**
+ * @brief Cross-checks a score from fbk_score_game_incremental against a rescan with scalar evaluation kernels and, 
+ *        for the classical evaluation, against the reference evaluator fbk_score_game.  Mismatches are logged
+ * 
+ * @param game  game that was scored, board masks must be updated
+ * @param eval  incremental evaluation the score was computed from
+ * @param score score to verify
+ * @return true if all evaluations match
+ */
+bool fbk_verify_score_game(const ftk_game_s * game, const fbk_incremental_eval_s * eval, fbk_score_t score);
+
+/* Longest random playout used to verify evaluation before restarting from the given game */
+#define FBK_VERIFY_EVALUATION_MAX_PLY 200
+
+/**
+ * @brief Differential test of the evaluation on given game and random playouts from it.  Each position is scored 
+ *        incrementally with the selected kernels and compared against scalar kernels and fbk_score_game
+ * 
+ * @param game           starting position
+ * @param position_count number of positions to verify
+ * @return number of positions with mismatching evaluations
+ */
+unsigned int fbk_verify_evaluation(const ftk_game_s * game, unsigned int position_count);
+
+/* Distinct positions cycled through by the evaluation benchmark */
+#define FBK_BENCH_EVALUATION_POSITIONS 256
+
+/**
+ * @brief Measures evaluation speed on positions from random playouts of given game.  Only scoring is timed, positions 
+ *        and their incremental evaluations are prepared beforehand
+ * 
+ * @param game       starting position
+ * @param eval_count number of positions to score
+ * @param nnue       true to time the neural network evaluation, false for the classical evaluation
+ * @return evaluations per second, 0 if the neural network is requested but not loaded
+ */
+double fbk_bench_evaluation(const ftk_game_s * game, unsigned int eval_count, bool nnue);
+
 /**
  * @brief Evaluates node represented by given game
  * 
  * @param node Node to evaluate
  * @param game Game representing this node (Assumes move is already applied)
+ * @param eval Incremental evaluation matching game, NULL to score with a full board scan.  Debug builds verify 
+ *             incremental scores against a full scan
+ * @param history Positions before this node for repetition detection, NULL to walk the node's ancestors
  * @param locked True if caller is holding the node's lock, else lock will be obtained
  * 
  * @return true if node was evaluated now, false if node is invalid or previously evaluated
  */
-bool fbk_evaluate_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, bool locked);
+bool fbk_evaluate_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, const fbk_incremental_eval_s * eval, 
+                                 const fbk_key_history_s * history, bool locked);
+
+/**
+ * @brief Creates child nodes of node represented by given game, evaluating the node first if needed.  Children are 
+ *        ordered captures and promotions first, then quiet moves, and are not evaluated
+ * 
+ * @param node   Node to expand
+ * @param game   Game representing this node (Assumes move is already applied)
+ * @param eval   Incremental evaluation matching game, NULL to score with a full board scan
+ * @param locked True if caller is holding the node's lock, else lock will be obtained
+ * 
+ * @return true if node was expanded now, false if previously expanded
+ */
+bool fbk_expand_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, const fbk_incremental_eval_s * eval, bool locked);
+
+/**
+ * @brief Evaluates all unevaluated children of an expanded node as one batch.  Positions are scored first without 
+ *        touching child nodes, then each child is locked once to record its result.  Assumes caller holds the node's 
+ *        lock and the node is not compressed
+ * 
+ * @param node Expanded node whose children to evaluate
+ * @param game Game representing this node, restored on return
+ * @param eval Incremental evaluation matching game, restored on return
+ * @param history Positions up to and including this node for repetition detection, NULL to walk ancestors
+ * 
+ * @return number of children evaluated now
+ */
+unsigned int fbk_evaluate_child_nodes(fbk_move_tree_node_s * node, ftk_game_s * game, fbk_incremental_eval_s * eval, 
+                                      const fbk_key_history_s * history);
 
 /**
  * @brief Clears evaluation and deletes all child nodes
@@ -47,7 +196,7 @@ bool fbk_evaluate_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game,
 void fbk_unevaluate_move_tree_node(fbk_move_tree_node_s * node);
 
 /**
- * @brief Evaluates all children of node
+ * @brief Expands node and evaluates all its children
  * 
  * @param node 
  * @param game 
@@ -0,0 +1,99 @@
+/*
+ fly_by_knight_analysis_simd.h
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Vectorized bitboard kernels for Fly by Knight evaluation
+*/
+
+#ifndef __FLY_BY_KNIGHT_ANALYSIS_SIMD_H__
+#define __FLY_BY_KNIGHT_ANALYSIS_SIMD_H__
+
+#include "fly_by_knight_types.h"
+
+/* Instruction set used by evaluation kernels */
+typedef enum
+{
+  FBK_SIMD_LEVEL_SCALAR,
+  FBK_SIMD_LEVEL_POPCNT,
+  FBK_SIMD_LEVEL_AVX2,
+  FBK_SIMD_LEVEL_NEON,
+
+  FBK_SIMD_LEVEL_COUNT,
+} fbk_simd_level_e;
+
+/* Evaluation kernels.  All implementations return identical results, they only differ in speed */
+typedef struct
+{
+  fbk_simd_level_e level;
+
+  /**
+   * @brief Sums set bits of masks[i] & targets over all squares i in sources
+   *
+   * @param masks   mask per square
+   * @param sources squares whose mask is counted
+   * @param targets bits counted in each mask
+   * @return total number of bits
+   */
+  unsigned int (*popcount_sum)(const ftk_board_mask_t masks[FTK_STD_BOARD_SIZE], ftk_board_mask_t sources, ftk_board_mask_t targets);
+
+  /**
+   * @brief Sums values[i] over all squares i in squares
+   *
+   * @param values  value per square
+   * @param squares squares to sum
+   * @return sum of values
+   */
+  fbk_score_t  (*score_sum)(const fbk_score_t values[FTK_STD_BOARD_SIZE], ftk_board_mask_t squares);
+
+  /**
+   * @brief Adds or subtracts a row of neural network feature weights to an accumulator
+   *
+   * @param accumulator hidden layer accumulator
+   * @param weights     feature weights
+   * @param sign        1 to add, -1 to subtract
+   */
+  void         (*nnue_accumulate)(int16_t accumulator[FBK_NNUE_HIDDEN_SIZE], const int16_t weights[FBK_NNUE_HIDDEN_SIZE], int sign);
+
+  /**
+   * @brief Sums clipped hidden layer activations of both perspectives times output weights
+   *
+   * @param us      accumulator from side to move's perspective
+   * @param them    accumulator from opponent's perspective
+   * @param weights output weights, side to move's first
+   * @return weighted sum
+   */
+  int32_t      (*nnue_output)(const int16_t us[FBK_NNUE_HIDDEN_SIZE], const int16_t them[FBK_NNUE_HIDDEN_SIZE], 
+                              const int8_t weights[FBK_EVAL_COLOR_COUNT*FBK_NNUE_HIDDEN_SIZE]);
+
+} fbk_simd_kernels_s;
+
+/**
+ * @brief Selects the fastest evaluation kernels supported by this CPU.  Safe to call multiple times
+ */
+void fbk_init_analysis_simd();
+
+/**
+ * @brief Returns the evaluation kernels selected for this CPU
+ */
+const fbk_simd_kernels_s * fbk_get_simd_kernels();
+
+/**
+ * @brief Returns the portable scalar evaluation kernels, used as reference for verifying the selected kernels
+ */
+const fbk_simd_kernels_s * fbk_get_scalar_simd_kernels();
+
+/**
+ * @brief Limits evaluation kernels to the given instruction set, kernels beyond the CPU's support are never selected
+ *
+ * @param level highest instruction set to use
+ */
+void fbk_limit_simd_level(fbk_simd_level_e level);
+
+/**
+ * @brief Returns printable name of an instruction set
+ */
+const char * fbk_simd_level_string(fbk_simd_level_e level);
+
+#endif /* __FLY_BY_KNIGHT_ANALYSIS_SIMD_H__ */
@@ -10,13 +10,18 @@
 #ifndef __FLY_BY_KNIGHT_ANALYSIS_WORKER_H__
 #define __FLY_BY_KNIGHT_ANALYSIS_WORKER_H__
 
+#include <stdalign.h>
+#include <stdatomic.h>
+
 #include "fly_by_knight_types.h"
 
+/* Type for analysis statistics counters */
+typedef uint_fast64_t fbk_analysis_counter_t;
+
 typedef enum
 {
   FBK_ANALYSIS_JOB_COMPLETE,
   FBK_ANALYSIS_JOB_ABORTED,
-  FBK_ANALYSIS_JOB_NO_LOCK,
 
 } fbk_analysis_job_result_e;
 
@@ -33,12 +38,31 @@ typedef struct
   /* Thread index processing this job for logging */
   fbk_thread_index_t        thread_index;
 
+  /* Retiring flag of the worker processing this job, the job is stopped and requeued when set */
+  const bool               *retiring;
+
   /* Indicates if this is the top call or a recursive call */
   bool                      top_call;
 
+  /* Positions along the game and search path before the node being processed, for repetition detection */
+  fbk_key_history_s         history;
+  /* True if the node being processed was reached by an irreversible move */
+  bool                      node_irreversible;
+
   /* Number of nodes evaluated by this job */
   fbk_node_count_t nodes_evaluated;
 
+  /* Number of child node arrays compressed by this job */
+  fbk_analysis_counter_t    compressions;
+
+  /* Analysis root of the job queue when this job was claimed, valid while the job is active */
+  const fbk_move_tree_node_s *root;
+
+  /* Number of queued jobs skipped while claiming this job because their node was claimed by another worker */
+  fbk_analysis_counter_t    claim_collisions;
+  /* True if this job was claimed in place of an earlier queued job whose node was claimed by another worker */
+  bool                      diverted;
+
 } fbk_analysis_job_context_s;
 
 typedef unsigned int fbk_analysis_job_id_t;
@@ -50,12 +74,16 @@ typedef struct
   fbk_analysis_job_id_t      job_id;
   /* Reference game to begin analysis on */
   ftk_game_s                 game;
+  /* Incremental evaluation state matching 'game' */
+  fbk_incremental_eval_s     eval;
   /* Node to begin analysis on */
   fbk_move_tree_node_s      *node;
   /* Depth to search */
   fbk_depth_t                depth;
   /* Breadth to search */
   fbk_breadth_t              breadth;
+  /* Duration of the previous run of this job, 0 if not run yet */
+  fbk_time_ms_t              last_duration;
 } fbk_analysis_job_s;
 
 /* Node for job queue */
@@ -85,8 +113,8 @@ typedef struct
   /* Condition when new job processing is stopped (either successfully or in failure) */
   pthread_cond_t job_ended;
 
-  /* Indicate the job queue has been cleared and need new initial jobs */
-  bool                           queue_cleared;
+  /* Root node queued jobs were created for, NULL if the queue was cleared and needs new initial jobs */
+  fbk_move_tree_node_s          *jobs_root;
   /* Number of active jobs popped from the queue but not yet freed */
   fbk_analysis_job_count_t       active_job_count;
 
@@ -136,28 +164,96 @@ typedef struct
   /* Thread Handle */
   pthread_t worker_thread;
 
+  /* True if this worker thread is currently pinned to a core */
+  bool      pinned;
+
+  /* Set to request this worker thread to requeue its job and exit, protected by both analysis state and job queue locks */
+  bool      retiring;
+
 } fbk_worker_thread_data_s;
 
-/* Structure for storing analysis statistics */
+/* Number of buckets in the job duration histogram.  Bucket 0 counts jobs under 1ms, bucket N counts jobs of [2^(N-1), 2^N) ms and the last bucket counts all longer jobs */
+#define FBK_JOB_DURATION_HISTOGRAM_SIZE 16
+
+/* Counters kept by each worker thread */
+typedef enum
+{
+  /* Nodes evaluated */
+  FBK_ANALYSIS_COUNTER_NODES,
+  /* Child node arrays compressed */
+  FBK_ANALYSIS_COUNTER_COMPRESSIONS,
+  /* Queued jobs skipped because their node was claimed by another worker */
+  FBK_ANALYSIS_COUNTER_CLAIM_COLLISIONS,
+  /* Jobs claimed in place of an earlier job whose node was claimed by another worker */
+  FBK_ANALYSIS_COUNTER_DIVERTED_JOBS,
+  /* Pawn structure scores found in and missing from worker pawn hash tables */
+  FBK_ANALYSIS_COUNTER_PAWN_HASH_HITS,
+  FBK_ANALYSIS_COUNTER_PAWN_HASH_MISSES,
+  /* Position evaluations found in and missing from the shared evaluation cache */
+  FBK_ANALYSIS_COUNTER_EVAL_CACHE_HITS,
+  FBK_ANALYSIS_COUNTER_EVAL_CACHE_MISSES,
+
+  FBK_ANALYSIS_COUNTER_COUNT,
+} fbk_analysis_counter_e;
+
+/* Assumed cache line size for padding data written by different threads */
+#define FBK_CACHE_LINE_SIZE 64
+/* Number of statistics shards.  Worker threads beyond this count share shards */
+#define FBK_ANALYSIS_STATS_SHARD_COUNT 64
+
+/* Statistics written by a single worker thread, padded to its own cache lines so workers never share a line */
 typedef struct 
 {
-  /* Lock for accessing analysis statistics */
-  fbk_mutex_t lock;
+  alignas(FBK_CACHE_LINE_SIZE) atomic_uint_fast64_t counter[FBK_ANALYSIS_COUNTER_COUNT];
+  /* Histogram of job durations */
+  atomic_uint_fast64_t job_duration_histogram[FBK_JOB_DURATION_HISTOGRAM_SIZE];
 
+} fbk_analysis_stats_shard_s;
+
+/* Structure for storing analysis statistics.  Counters only increase, per turn and per game counts are relative to a 
+   baseline recorded on reset */
+typedef struct 
+{
+  /* Statistics per worker thread, aggregated on read */
+  fbk_analysis_stats_shard_s shard[FBK_ANALYSIS_STATS_SHARD_COUNT];
+
+  /* Total nodes analyzed at the start of this turn */
+  atomic_uint_fast64_t turn_nodes_baseline;
+  /* Total nodes analyzed at the start of this game */
+  atomic_uint_fast64_t game_nodes_baseline;
+
+} fbk_analysis_stats_s;
+
+/* Aggregated snapshot of analysis statistics */
+typedef struct 
+{
   /* Nodes analyzed since start of this turn */
-  fbk_node_count_t analyzed_nodes;
+  fbk_node_count_t       analyzed_nodes;
   /* Nodes analyzed since game start */
-  fbk_node_count_t game_analyzed_nodes;
+  fbk_node_count_t       game_analyzed_nodes;
   /* Nodes analyzed since process start */
-  fbk_node_count_t total_analyzed_nodes;
+  fbk_node_count_t       total_analyzed_nodes;
 
-} fbk_analysis_stats_s;
+  /* Counters since process start */
+  fbk_analysis_counter_t counter[FBK_ANALYSIS_COUNTER_COUNT];
+
+  /* Histogram of job durations since process start */
+  fbk_analysis_counter_t job_duration_histogram[FBK_JOB_DURATION_HISTOGRAM_SIZE];
+
+} fbk_analysis_stats_snapshot_s;
 
 /**
  * @brief Returns the number of nodes analyzed since the start of this turn
 */
 fbk_node_count_t get_analyzed_nodes();
 
+/**
+ * @brief Aggregates all worker thread statistics into a snapshot
+ * 
+ * @param snapshot output snapshot
+*/
+void get_analysis_stats(fbk_analysis_stats_snapshot_s *snapshot);
+
 /**
  * @brief Resets the number of nodes analyzed this turn (reset when committing a move)
 */
@@ -168,6 +264,67 @@ void reset_analyzed_nodes();
 */
 void reset_game_analyzed_nodes();
 
+/* Maximum moves kept in a published best line */
+#define FBK_BEST_LINE_SNAPSHOT_MAX_LENGTH 64
+
+/* Immutable best line of the analysis root.  Workers publish a new snapshot whenever it changes so readers never take 
+   move tree locks */
+typedef struct fbk_best_line_snapshot_struct fbk_best_line_snapshot_s;
+struct fbk_best_line_snapshot_struct
+{
+  /* Analysis root the snapshot describes, only for comparison by readers */
+  const fbk_move_tree_node_s *       root;
+  /* Increases with every published snapshot */
+  uint_fast64_t                      sequence;
+  /* Increases only when the root or the moves of the best line change */
+  uint_fast64_t                      line_sequence;
+  /* Number of legal moves at the root */
+  fbk_move_tree_node_count_t         root_child_count;
+  /* Root child indices of the best and second best moves, root_child_count if none */
+  fbk_move_tree_node_count_t         best_root_child;
+  fbk_move_tree_node_count_t         second_root_child;
+
+  /* Analysis of the root's best child */
+  fbk_move_tree_node_analysis_data_s analysis_data;
+  /* Number of child nodes of the root's best child */
+  fbk_move_tree_node_count_t         child_count;
+  /* Score lead of the best move over the second best for the side to move, 0 if unknown or either result is decided */
+  fbk_score_t                        score_gap;
+  /* True if score_gap was measured, i.e. neither result is decided */
+  bool                               gap_is_score;
+  /* Share of nodes searched under the root since analysis started there that were under the best move */
+  unsigned int                       best_move_effort_permille;
+
+  /* Best line, starting with the best move */
+  unsigned int                       line_length;
+  ftk_move_s                         line[FBK_BEST_LINE_SNAPSHOT_MAX_LENGTH];
+
+  /* Next replaced snapshot waiting for readers to finish, protected by the publish lock */
+  fbk_best_line_snapshot_s *         next_retired;
+};
+
+/* Published best line and replaced snapshots not yet freed */
+typedef struct
+{
+  /* Serializes publishers, never taken by readers */
+  fbk_mutex_t                          publish_lock;
+
+  /* Current snapshot, NULL if none */
+  _Atomic(fbk_best_line_snapshot_s *)  current;
+  /* Number of readers holding a snapshot */
+  atomic_uint                          readers;
+  /* Replaced snapshots, freed once no reader holds a snapshot */
+  fbk_best_line_snapshot_s *           retired;
+  /* Sequence numbers of last published snapshot */
+  uint_fast64_t                        sequence;
+  uint_fast64_t                        line_sequence;
+
+  /* Nodes searched by jobs under each child of the jobs' root, by child index.  Reset when the job queue is re-rooted */
+  _Atomic(fbk_node_count_t)            effort_nodes[FBK_MOVE_TREE_MAX_NODE_COUNT];
+  _Atomic(fbk_node_count_t)            effort_total;
+
+} fbk_best_line_publication_s;
+
 /* Root structure for Fly by Knight analysis data */
 typedef struct 
 {
@@ -194,6 +351,9 @@ typedef struct
   /* Queue of analysis jobs for worker threads*/
   fbk_analysis_job_queue_s  job_queue;
 
+  /* Best line of the analysis root published by workers */
+  fbk_best_line_publication_s best_line;
+
 } fbk_analysis_data_s;
 
 
@@ -213,6 +373,13 @@ bool fbk_init_analysis_data(fbk_instance_s *fbk);
 */
 void fbk_update_worker_thread_count(unsigned int count);
 
+/**
+ * @brief Enables or disables pinning of worker threads to cores.  Running workers apply the change before their next job
+ * 
+ * @param pin true to pin each worker thread to its own core
+*/
+void fbk_set_worker_thread_pinning(bool pin);
+
 /**
  * @brief Starts analysis at given move tree node
  * @param node Move tree node of interest
@@ -227,4 +394,17 @@ void fbk_start_analysis(const ftk_game_s *game, fbk_move_tree_node_s * node);
 */
 bool fbk_stop_analysis(bool clear_pending_jobs);
 
+/**
+ * @brief Returns the published best line without taking any move tree lock.  The snapshot stays valid until 
+ *        fbk_release_best_line_snapshot() is called
+ * 
+ * @return Best line snapshot or NULL if none is published
+*/
+const fbk_best_line_snapshot_s * fbk_acquire_best_line_snapshot();
+
+/**
+ * @brief Releases a snapshot returned by fbk_acquire_best_line_snapshot()
+*/
+void fbk_release_best_line_snapshot();
+
 #endif /* __FLY_BY_KNIGHT_ANALYSIS_WORKER_H__ */
\ No newline at end of file
@@ -0,0 +1,136 @@
+/*
+ fly_by_knight_eval_params.h
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Evaluation parameters for Fly by Knight
+*/
+
+#ifndef _FLY_BY_KNIGHT_EVAL_PARAMS_H_
+#define _FLY_BY_KNIGHT_EVAL_PARAMS_H_
+
+#include <stdio.h>
+
+#include "fly_by_knight_algorithm_constants.h"
+#include "fly_by_knight_piece_square_tables.h"
+#include "fly_by_knight_types.h"
+
+/* Weights used by evaluation.  Per piece type arrays are indexed pawn, knight, bishop, rook, queen, king */
+typedef struct
+{
+  /* Material value */
+  fbk_score_t piece_value[FBK_EVAL_PIECE_TYPE_COUNT];
+  /* Value per legal move */
+  fbk_score_t move_value[FBK_EVAL_PIECE_TYPE_COUNT];
+  /* Value of a potential capture of an opponent's piece */
+  fbk_score_t capture_value[FBK_EVAL_PIECE_TYPE_COUNT];
+  /* Value of a potential loss of an own piece */
+  fbk_score_t loss_value[FBK_EVAL_PIECE_TYPE_COUNT];
+
+  /* Value per unmoved rook while the king has not moved */
+  fbk_score_t can_castle;
+  fbk_score_t castled_kingside;
+  fbk_score_t castled_queenside;
+
+  /* Pawn structure, see score_pawn_structure() */
+  fbk_score_t double_pawn_base_penalty;
+  fbk_score_t isolated_pawn_penalty;
+  /* Passed pawn bonus by rank from the pawn's side, rank 1 first */
+  fbk_score_t passed_pawn[8];
+
+  /* Middlegame and endgame piece-square scores per piece type, color (white first) and square.  Black's tables
+     always mirror white's */
+  fbk_score_t pst_mg[FBK_EVAL_PIECE_TYPE_COUNT][FBK_EVAL_COLOR_COUNT][FTK_STD_BOARD_SIZE];
+  fbk_score_t pst_eg[FBK_EVAL_PIECE_TYPE_COUNT][FBK_EVAL_COLOR_COUNT][FTK_STD_BOARD_SIZE];
+
+} fbk_eval_params_s;
+
+/* Initializer for the default evaluation parameters */
+#define FBK_DEFAULT_EVAL_PARAMS \
+{ \
+  .piece_value   = { FBK_SCORE_PAWN, FBK_SCORE_KNIGHT, FBK_SCORE_BISHOP, FBK_SCORE_ROOK, FBK_SCORE_QUEEN, FBK_SCORE_KING }, \
+  .move_value    = { FBK_SCORE_PAWN_MOVE, FBK_SCORE_KNIGHT_MOVE, FBK_SCORE_BISHOP_MOVE, FBK_SCORE_ROOK_MOVE, FBK_SCORE_QUEEN_MOVE, FBK_SCORE_KING_MOVE }, \
+  .capture_value = { FBK_SCORE_CAPTURE_PAWN, FBK_SCORE_CAPTURE_KNIGHT, FBK_SCORE_CAPTURE_BISHOP, FBK_SCORE_CAPTURE_ROOK, FBK_SCORE_CAPTURE_QUEEN, FBK_SCORE_CAPTURE_KING }, \
+  .loss_value    = { FBK_SCORE_LOSS_PAWN, FBK_SCORE_LOSS_KNIGHT, FBK_SCORE_LOSS_BISHOP, FBK_SCORE_LOSS_ROOK, FBK_SCORE_LOSS_QUEEN, FBK_SCORE_LOSS_KING }, \
+  .can_castle                = FBK_SCORE_CAN_CASTLE, \
+  .castled_kingside          = FBK_SCORE_CASTLED_KINGSIDE, \
+  .castled_queenside         = FBK_SCORE_CASTLED_QUEENSIDE, \
+  .double_pawn_base_penalty  = FBK_SCORE_DOUBLE_PAWN_BASE_PENALTY, \
+  .isolated_pawn_penalty     = FBK_SCORE_ISOLATED_PAWN_PENALTY, \
+  .passed_pawn   = { 0, FBK_SCORE_PASSED_PAWN_SECOND_ROW, FBK_SCORE_PASSED_PAWN_THIRD_ROW, FBK_SCORE_PASSED_PAWN_FOURTH_ROW, \
+                     FBK_SCORE_PASSED_PAWN_FIFTH_ROW, FBK_SCORE_PASSED_PAWN_SIXTH_ROW, FBK_SCORE_PASSED_PAWN_SEVENTH_ROW, 0 }, \
+  .pst_mg        = { FBK_PST_PAWN_MG, FBK_PST_KNIGHT_MG, FBK_PST_BISHOP_MG, FBK_PST_ROOK_MG, FBK_PST_QUEEN_MG, FBK_PST_KING_MG }, \
+  .pst_eg        = { FBK_PST_PAWN_EG, FBK_PST_KNIGHT_EG, FBK_PST_BISHOP_EG, FBK_PST_ROOK_EG, FBK_PST_QUEEN_EG, FBK_PST_KING_EG }, \
+}
+
+#ifdef FBK_RUNTIME_EVAL_PARAMS
+/* Parameters used by evaluation, only built with runtime evaluation parameters.  Otherwise evaluation uses
+   FBK_DEFAULT_EVAL_PARAMS as constants.  Must not be changed while positions are evaluated */
+extern fbk_eval_params_s fbk_eval_params;
+#endif
+
+/* Maximum length of a parameter name including terminator, e.g. "pst_mg[5][63]" */
+#define FBK_EVAL_PARAM_NAME_SIZE 32
+
+/**
+ * @brief Returns the number of individually settable evaluation parameters.  Piece-square parameters are counted from
+ *        white's perspective only
+ */
+unsigned int fbk_eval_param_count();
+
+/**
+ * @brief Writes the name of a parameter, e.g. "piece_value[1]" or "can_castle"
+ *
+ * @param index parameter index, less than fbk_eval_param_count()
+ * @param name  output name of at least FBK_EVAL_PARAM_NAME_SIZE characters
+ */
+void fbk_eval_param_name(unsigned int index, char name[FBK_EVAL_PARAM_NAME_SIZE]);
+
+/**
+ * @brief Finds a parameter by name
+ *
+ * @param name  parameter name
+ * @param index output parameter index
+ * @return true if found
+ */
+bool fbk_find_eval_param(const char * name, unsigned int * index);
+
+/**
+ * @brief Returns the value of a parameter
+ */
+fbk_score_t fbk_get_eval_param(const fbk_eval_params_s * params, unsigned int index);
+
+/**
+ * @brief Sets the value of a parameter.  Piece-square parameters are set for white and mirrored for black
+ */
+void fbk_set_eval_param(fbk_eval_params_s * params, unsigned int index, fbk_score_t value);
+
+/**
+ * @brief Parses and applies a parameter assignment of the form "name=value" or "name value"
+ *
+ * @param params     parameters to update
+ * @param assignment assignment string
+ * @return true if successful
+ */
+bool fbk_parse_eval_param(fbk_eval_params_s * params, const char * assignment);
+
+/**
+ * @brief Loads parameter assignments from a file, one per line.  Blank lines and lines starting with '#' are ignored
+ *        and parameters not listed keep their value
+ *
+ * @param params parameters to update
+ * @param path   file to load
+ * @return true if every line was applied
+ */
+bool fbk_load_eval_params(fbk_eval_params_s * params, const char * path);
+
+/**
+ * @brief Writes all parameters in the format read by fbk_load_eval_params()
+ *
+ * @param params parameters to write
+ * @param stream output stream
+ */
+void fbk_write_eval_params(const fbk_eval_params_s * params, FILE * stream);
+
+#endif //_FLY_BY_KNIGHT_EVAL_PARAMS_H_
@@ -12,6 +12,28 @@
 #ifndef __FLY_BY_KNIGHT_HASH_H__
 #define __FLY_BY_KNIGHT_HASH_H__
 
+/**
+ * @brief Computes the Zobrist key of given game from scratch.  Castling rights are derived from unmoved kings and rooks
+ *        and the en passant file from the last move
+ * 
+ * @param game      Game to hash
+ * @param last_move Move which led to game, NULL if unknown
+ * @return key
+ */
+ftk_zobrist_hash_key_t fbk_hash_game(const ftk_game_s * game, const ftk_move_s * last_move);
+
+/**
+ * @brief Computes the key terms a move may change: pieces on the squares it touches, castling rights, en passant file 
+ *        and side to move.  A child's key is its parent's key XOR the terms before the move XOR the terms after it
+ * 
+ * @param game      Game before or after the move
+ * @param squares   Squares touched by the move, see fbk_incremental_eval_move_squares()
+ * @param count     Number of squares
+ * @param last_move Move which led to game, NULL if unknown
+ * @return key terms
+ */
+ftk_zobrist_hash_key_t fbk_hash_move_terms(const ftk_game_s * game, const ftk_square_e squares[], unsigned int count, const ftk_move_s * last_move);
+
 /**
  * @brief Hash node represented by given game
  * 
@@ -23,4 +45,74 @@
  */
 bool fbk_hash_move_tree_node(fbk_move_tree_node_s * node, const ftk_game_s * game, bool locked);
 
+/**
+ * @brief Returns the pawn-only Zobrist key component of a pawn on given square.  Pawn keys are updated incrementally 
+ *        by XORing the components of pawns leaving and entering squares
+ * 
+ * @param color  pawn color
+ * @param square pawn square
+ * @return key component
+ */
+ftk_zobrist_hash_key_t fbk_pawn_hash_square_key(ftk_color_e color, ftk_square_e square);
+
+/**
+ * @brief Computes the pawn-only Zobrist key of a pawn structure
+ * 
+ * @param white_pawns squares of white pawns
+ * @param black_pawns squares of black pawns
+ * @return pawn key
+ */
+ftk_zobrist_hash_key_t fbk_pawn_hash_key(ftk_board_mask_t white_pawns, ftk_board_mask_t black_pawns);
+
+/**
+ * @brief Returns true if no position before move can repeat after it, i.e. the move is a capture, a pawn move or loses 
+ *        castling rights
+ * 
+ * @param board Board before move
+ * @param move  Move to check
+ */
+bool fbk_irreversible_move(const ftk_board_s * board, const ftk_move_s * move);
+
+/**
+ * @brief Initializes an empty key history
+ * 
+ * @param history History to initialize
+ */
+void fbk_init_key_history(fbk_key_history_s * history);
+
+/**
+ * @brief Initializes key history with positions along the move tree before given node, back to the last irreversible 
+ *        move.  Ancestors must be hashed
+ * 
+ * @param history History to initialize
+ * @param node    Node to collect history of, not included in history
+ * @param game    Game representing node
+ */
+void fbk_init_key_history_from_tree(fbk_key_history_s * history, const fbk_move_tree_node_s * node, const ftk_game_s * game);
+
+/**
+ * @brief Pushes position onto key history.  The oldest position is dropped if history is full
+ * 
+ * @param history      History to update
+ * @param key          Key of position
+ * @param irreversible True if position was reached by an irreversible move
+ */
+void fbk_push_key_history(fbk_key_history_s * history, ftk_zobrist_hash_key_t key, bool irreversible);
+
+/**
+ * @brief Pops the newest position from key history
+ * 
+ * @param history History to update
+ */
+void fbk_pop_key_history(fbk_key_history_s * history);
+
+/**
+ * @brief Counts occurrences of a position in key history since the last irreversible move
+ * 
+ * @param history History to search
+ * @param key     Key of position
+ * @return number of occurrences
+ */
+unsigned int fbk_key_history_count(const fbk_key_history_s * history, ftk_zobrist_hash_key_t key);
+
 #endif /* __FLY_BY_KNIGHT_HASH_H__ */
\ No newline at end of file
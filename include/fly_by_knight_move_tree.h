@@ -28,26 +28,48 @@ void fbk_init_move_tree_node(fbk_move_tree_node_s * node, fbk_move_tree_node_s *
  */
 void fbk_delete_move_tree_node(fbk_move_tree_node_s * node);
 
+/**
+ * @brief Applies move to given game
+ * 
+ * @param move Move to apply
+ * @param game Game to modify with move
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
+ * @return     True if successful
+ */
+bool fbk_apply_game_move(const ftk_move_s * move, ftk_game_s * game, fbk_incremental_eval_s * eval);
+
+/**
+ * @brief Reverts move from given game
+ * 
+ * @param move Move to undo
+ * @param game Game to modify with move
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
+ * @return     True if successful
+ */
+bool fbk_undo_game_move(const ftk_move_s * move, ftk_game_s * game, fbk_incremental_eval_s * eval);
+
 /**
  * @brief Applies move to given game
  * 
  * @param node Node to apply
  * @param game Game to modify with move tree node
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
  * @return     True if successful
  */
-bool fbk_apply_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game);
+bool fbk_apply_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, fbk_incremental_eval_s * eval);
 
 /**
  * @brief Reverts move from given game
  * 
  * @param node Node to undo
  * @param game Game to modify with move tree node
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
  * @return     True if successful
  */
-bool fbk_undo_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game);
+bool fbk_undo_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, fbk_incremental_eval_s * eval);
 
 /**
- * @brief Returns child node for given move, NULL if no child node for move or current node is not evaluated
+ * @brief Returns child node for given move, NULL if no child node for move or current node is not expanded
  * 
  * @param current_node 
  * @param move 
@@ -0,0 +1,88 @@
+/*
+ fly_by_knight_nnue.h
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Efficiently updatable neural network evaluation for Fly by Knight
+*/
+
+#ifndef __FLY_BY_KNIGHT_NNUE_H__
+#define __FLY_BY_KNIGHT_NNUE_H__
+
+#include "fly_by_knight_analysis_simd.h"
+#include "fly_by_knight_types.h"
+
+/* Network file layout, all values little-endian:
+     magic           "FBKNNUE1"
+     uint32          hidden size, must be FBK_NNUE_HIDDEN_SIZE
+     int32           output scale, centipawns per FBK_NNUE_QA*FBK_NNUE_QB output units
+     int16           feature weights [FBK_NNUE_INPUT_SIZE][FBK_NNUE_HIDDEN_SIZE]
+     int16           feature biases  [FBK_NNUE_HIDDEN_SIZE]
+     int8            output weights  [2][FBK_NNUE_HIDDEN_SIZE], side to move first
+     int32           output bias
+   Feature index is ((relative color * 6) + piece type) * 64 + square, where relative color is 0 for the perspective's own
+   pieces, piece types run pawn through king and squares are mirrored vertically for black's perspective */
+#define FBK_NNUE_FILE_MAGIC "FBKNNUE1"
+
+/**
+ * @brief Loads the neural network from a file.  Only one network may be loaded, before analysis starts
+ *
+ * @param path network file
+ * @return true if successful
+ */
+bool fbk_load_nnue_network(const char * path);
+
+/**
+ * @brief Returns true if a neural network is loaded
+ */
+bool fbk_nnue_network_loaded();
+
+/**
+ * @brief Selects the neural network (true) or classical (false) evaluation.  Positions initialized with the other
+ *        evaluation are rescanned when scored until their incremental evaluation is reinitialized
+ *
+ * @param enabled true to evaluate with the neural network
+ * @return true if successful, false if enabling without a loaded network
+ */
+bool fbk_set_nnue_enabled(bool enabled);
+
+/**
+ * @brief Returns true if positions are evaluated with the neural network
+ */
+bool fbk_nnue_enabled();
+
+/**
+ * @brief Computes accumulators from scratch
+ *
+ * @param accumulator accumulator to compute, marked valid
+ * @param piece_mask  squares occupied by each color (white first) and piece type (pawn through king)
+ * @param kernels     evaluation kernels
+ */
+void fbk_nnue_refresh(fbk_nnue_accumulator_s * accumulator, const ftk_board_mask_t piece_mask[FBK_EVAL_COLOR_COUNT][FBK_EVAL_PIECE_TYPE_COUNT],
+                      const fbk_simd_kernels_s * kernels);
+
+/**
+ * @brief Adds or removes a piece from accumulators of both perspectives
+ *
+ * @param accumulator accumulator to update
+ * @param color       piece color, 0 for white
+ * @param piece       piece type, 0 for pawn through 5 for king
+ * @param square      square of piece
+ * @param sign        1 to add, -1 to remove
+ * @param kernels     evaluation kernels
+ */
+void fbk_nnue_update(fbk_nnue_accumulator_s * accumulator, unsigned int color, unsigned int piece, ftk_square_e square, int sign,
+                     const fbk_simd_kernels_s * kernels);
+
+/**
+ * @brief Scores position from its accumulators for white or black advantage
+ *
+ * @param accumulator valid accumulators of position
+ * @param turn        side to move
+ * @param kernels     evaluation kernels
+ * @return fbk_score_t
+ */
+fbk_score_t fbk_nnue_score(const fbk_nnue_accumulator_s * accumulator, ftk_color_e turn, const fbk_simd_kernels_s * kernels);
+
+#endif /* __FLY_BY_KNIGHT_NNUE_H__ */
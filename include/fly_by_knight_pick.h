@@ -43,6 +43,8 @@ typedef struct
 
   /* First move in best line */
   fbk_picker_best_line_node_s        *first_move;
+  /* Changes whenever the moves of the best line or the position it starts from change, never 0 */
+  uint_fast64_t                       line_sequence;
 
 } fbk_picker_best_line_s;
 
@@ -118,7 +120,34 @@ void fbk_start_picker(const fbk_picker_client_config_s *pick_client_config);
 void fbk_stop_picker();
 
 /**
- * @brief Trigger the picker to reevaluate best move
+ * @brief Returns the expected move at the current position from the published best line, including a best line published 
+ *        before the engine's last move was committed.  Assumes caller holds the game lock
+ * 
+ * @param fbk Fly by Knight instance
+ * @return Expected move, invalid if no best line covers the current position
+*/
+ftk_move_s fbk_get_expected_reply(const fbk_instance_s *fbk);
+
+/**
+ * @brief Starts pondering on the opponent's turn.  The opponent's reply is predicted from the best line and analysis is 
+ *        focused on the position after it.  Analyzes all replies if no reply is evaluated yet
+ * 
+ * @param fbk Fly by Knight instance
+*/
+void fbk_start_pondering(fbk_instance_s *fbk);
+
+/**
+ * @brief Resolves a pending ponder prediction with the opponent's move.  On a hit, time spent pondering is credited to 
+ *        the engine's move.  Assumes caller holds the game lock
+ * 
+ * @param fbk Fly by Knight instance
+ * @param move move played by the opponent
+*/
+void fbk_resolve_ponder(fbk_instance_s *fbk, const ftk_move_s *move);
+
+/**
+ * @brief Trigger the picker to reevaluate best move.  Pending job ended triggers are coalesced into one reevaluation and 
+ *        timed triggers make the next timed check due immediately
  * 
  * @param trigger Trigger data
 */
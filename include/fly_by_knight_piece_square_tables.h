@@ -0,0 +1,153 @@
+/*
+ fly_by_knight_piece_square_tables.h
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+ 
+ Piece-square tables for Fly by Knight
+*/
+
+#ifndef _FLY_BY_KNIGHT_PIECE_SQUARE_TABLES_H_
+#define _FLY_BY_KNIGHT_PIECE_SQUARE_TABLES_H_
+
+#include "fly_by_knight_algorithm_constants.h"
+
+/* Piece-square values are given in 1/50 of a pawn */
+#define FBK_PST(x) (((x)*FBK_SCORE_PAWN) / 50)
+
+/* Expands 8 files of a rank, file A first */
+#define FBK_PST_RANK(a, b, c, d, e, f, g, h) \
+  FBK_PST(a), FBK_PST(b), FBK_PST(c), FBK_PST(d), FBK_PST(e), FBK_PST(f), FBK_PST(g), FBK_PST(h)
+
+/* Expands ranks given from white's perspective (rank 1 first) into a table per color indexed by square, white first.
+   Black's table is white's mirrored across the board's horizontal center */
+#define FBK_PST_COLOR_TABLES(r1, r2, r3, r4, r5, r6, r7, r8) \
+  { { r1, r2, r3, r4, r5, r6, r7, r8 }, { r8, r7, r6, r5, r4, r3, r2, r1 } }
+
+/* Pawns advance and take the center early, advancing is worth more as the board empties */
+#define FBK_PST_PAWN_MG_RANK_8 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_PAWN_MG_RANK_7 FBK_PST_RANK(  5,   5,   5,   5,   5,   5,   5,   5)
+#define FBK_PST_PAWN_MG_RANK_6 FBK_PST_RANK(  4,   4,   4,   4,   4,   4,   4,   4)
+#define FBK_PST_PAWN_MG_RANK_5 FBK_PST_RANK(  3,   3,   3,  10,  10,   3,   3,   3)
+#define FBK_PST_PAWN_MG_RANK_4 FBK_PST_RANK(  2,   2,   2,  10,  10,   2,   2,   2)
+#define FBK_PST_PAWN_MG_RANK_3 FBK_PST_RANK(  1,   1,   1,   1,   1,   1,   1,   1)
+#define FBK_PST_PAWN_MG_RANK_2 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_PAWN_MG_RANK_1 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_PAWN_MG FBK_PST_COLOR_TABLES(FBK_PST_PAWN_MG_RANK_1, FBK_PST_PAWN_MG_RANK_2, FBK_PST_PAWN_MG_RANK_3, FBK_PST_PAWN_MG_RANK_4, FBK_PST_PAWN_MG_RANK_5, FBK_PST_PAWN_MG_RANK_6, FBK_PST_PAWN_MG_RANK_7, FBK_PST_PAWN_MG_RANK_8)
+
+#define FBK_PST_PAWN_EG_RANK_8 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_PAWN_EG_RANK_7 FBK_PST_RANK( 20,  20,  20,  20,  20,  20,  20,  20)
+#define FBK_PST_PAWN_EG_RANK_6 FBK_PST_RANK( 12,  12,  12,  12,  12,  12,  12,  12)
+#define FBK_PST_PAWN_EG_RANK_5 FBK_PST_RANK(  7,   7,   7,   7,   7,   7,   7,   7)
+#define FBK_PST_PAWN_EG_RANK_4 FBK_PST_RANK(  4,   4,   4,   4,   4,   4,   4,   4)
+#define FBK_PST_PAWN_EG_RANK_3 FBK_PST_RANK(  2,   2,   2,   2,   2,   2,   2,   2)
+#define FBK_PST_PAWN_EG_RANK_2 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_PAWN_EG_RANK_1 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_PAWN_EG FBK_PST_COLOR_TABLES(FBK_PST_PAWN_EG_RANK_1, FBK_PST_PAWN_EG_RANK_2, FBK_PST_PAWN_EG_RANK_3, FBK_PST_PAWN_EG_RANK_4, FBK_PST_PAWN_EG_RANK_5, FBK_PST_PAWN_EG_RANK_6, FBK_PST_PAWN_EG_RANK_7, FBK_PST_PAWN_EG_RANK_8)
+
+/* Knights centralize, follow Kasparov's 'Knight on F6 is worth a Pawn' in the middlegame */
+#define FBK_PST_KNIGHT_MG_RANK_8 FBK_PST_RANK(  0,   1,   3,   5,   5,   3,   1,   0)
+#define FBK_PST_KNIGHT_MG_RANK_7 FBK_PST_RANK(  3,   4,   6,   8,   8,   6,   4,   3)
+#define FBK_PST_KNIGHT_MG_RANK_6 FBK_PST_RANK( 10,  11,  13,  15,  15,  50,  11,  10)
+#define FBK_PST_KNIGHT_MG_RANK_5 FBK_PST_RANK(  7,   8,  10,  12,  12,  10,   8,   7)
+#define FBK_PST_KNIGHT_MG_RANK_4 FBK_PST_RANK(  5,   6,   8,  10,  10,   8,   6,   5)
+#define FBK_PST_KNIGHT_MG_RANK_3 FBK_PST_RANK(  3,   4,   6,   8,   8,   6,   4,   3)
+#define FBK_PST_KNIGHT_MG_RANK_2 FBK_PST_RANK(  0,   1,   3,   5,   5,   3,   1,   0)
+#define FBK_PST_KNIGHT_MG_RANK_1 FBK_PST_RANK(  0,   1,   3,   5,   5,   3,   1,   0)
+#define FBK_PST_KNIGHT_MG FBK_PST_COLOR_TABLES(FBK_PST_KNIGHT_MG_RANK_1, FBK_PST_KNIGHT_MG_RANK_2, FBK_PST_KNIGHT_MG_RANK_3, FBK_PST_KNIGHT_MG_RANK_4, FBK_PST_KNIGHT_MG_RANK_5, FBK_PST_KNIGHT_MG_RANK_6, FBK_PST_KNIGHT_MG_RANK_7, FBK_PST_KNIGHT_MG_RANK_8)
+
+#define FBK_PST_KNIGHT_EG_RANK_8 FBK_PST_RANK(-25, -20, -15, -15, -15, -15, -20, -25)
+#define FBK_PST_KNIGHT_EG_RANK_7 FBK_PST_RANK(-20, -10,   0,   0,   0,   0, -10, -20)
+#define FBK_PST_KNIGHT_EG_RANK_6 FBK_PST_RANK(-15,   0,   5,   7,   7,   5,   0, -15)
+#define FBK_PST_KNIGHT_EG_RANK_5 FBK_PST_RANK(-15,   2,   7,  10,  10,   7,   2, -15)
+#define FBK_PST_KNIGHT_EG_RANK_4 FBK_PST_RANK(-15,   0,   7,  10,  10,   7,   0, -15)
+#define FBK_PST_KNIGHT_EG_RANK_3 FBK_PST_RANK(-15,   2,   5,   7,   7,   5,   2, -15)
+#define FBK_PST_KNIGHT_EG_RANK_2 FBK_PST_RANK(-20, -10,   0,   2,   2,   0, -10, -20)
+#define FBK_PST_KNIGHT_EG_RANK_1 FBK_PST_RANK(-25, -20, -15, -15, -15, -15, -20, -25)
+#define FBK_PST_KNIGHT_EG FBK_PST_COLOR_TABLES(FBK_PST_KNIGHT_EG_RANK_1, FBK_PST_KNIGHT_EG_RANK_2, FBK_PST_KNIGHT_EG_RANK_3, FBK_PST_KNIGHT_EG_RANK_4, FBK_PST_KNIGHT_EG_RANK_5, FBK_PST_KNIGHT_EG_RANK_6, FBK_PST_KNIGHT_EG_RANK_7, FBK_PST_KNIGHT_EG_RANK_8)
+
+/* Bishops avoid edges and prefer long diagonals */
+#define FBK_PST_BISHOP_MG_RANK_8 FBK_PST_RANK(-10,  -5,  -5,  -5,  -5,  -5,  -5, -10)
+#define FBK_PST_BISHOP_MG_RANK_7 FBK_PST_RANK( -5,   0,   0,   0,   0,   0,   0,  -5)
+#define FBK_PST_BISHOP_MG_RANK_6 FBK_PST_RANK( -5,   0,   2,   5,   5,   2,   0,  -5)
+#define FBK_PST_BISHOP_MG_RANK_5 FBK_PST_RANK( -5,   2,   2,   5,   5,   2,   2,  -5)
+#define FBK_PST_BISHOP_MG_RANK_4 FBK_PST_RANK( -5,   0,   5,   5,   5,   5,   0,  -5)
+#define FBK_PST_BISHOP_MG_RANK_3 FBK_PST_RANK( -5,   5,   5,   5,   5,   5,   5,  -5)
+#define FBK_PST_BISHOP_MG_RANK_2 FBK_PST_RANK( -5,   2,   0,   0,   0,   0,   2,  -5)
+#define FBK_PST_BISHOP_MG_RANK_1 FBK_PST_RANK(-10,  -5,  -5,  -5,  -5,  -5,  -5, -10)
+#define FBK_PST_BISHOP_MG FBK_PST_COLOR_TABLES(FBK_PST_BISHOP_MG_RANK_1, FBK_PST_BISHOP_MG_RANK_2, FBK_PST_BISHOP_MG_RANK_3, FBK_PST_BISHOP_MG_RANK_4, FBK_PST_BISHOP_MG_RANK_5, FBK_PST_BISHOP_MG_RANK_6, FBK_PST_BISHOP_MG_RANK_7, FBK_PST_BISHOP_MG_RANK_8)
+
+#define FBK_PST_BISHOP_EG_RANK_8 FBK_PST_RANK( -7,  -5,  -5,  -5,  -5,  -5,  -5,  -7)
+#define FBK_PST_BISHOP_EG_RANK_7 FBK_PST_RANK( -5,   0,   0,   0,   0,   0,   0,  -5)
+#define FBK_PST_BISHOP_EG_RANK_6 FBK_PST_RANK( -5,   0,   2,   2,   2,   2,   0,  -5)
+#define FBK_PST_BISHOP_EG_RANK_5 FBK_PST_RANK( -5,   0,   2,   5,   5,   2,   0,  -5)
+#define FBK_PST_BISHOP_EG_RANK_4 FBK_PST_RANK( -5,   0,   2,   5,   5,   2,   0,  -5)
+#define FBK_PST_BISHOP_EG_RANK_3 FBK_PST_RANK( -5,   0,   2,   2,   2,   2,   0,  -5)
+#define FBK_PST_BISHOP_EG_RANK_2 FBK_PST_RANK( -5,   0,   0,   0,   0,   0,   0,  -5)
+#define FBK_PST_BISHOP_EG_RANK_1 FBK_PST_RANK( -7,  -5,  -5,  -5,  -5,  -5,  -5,  -7)
+#define FBK_PST_BISHOP_EG FBK_PST_COLOR_TABLES(FBK_PST_BISHOP_EG_RANK_1, FBK_PST_BISHOP_EG_RANK_2, FBK_PST_BISHOP_EG_RANK_3, FBK_PST_BISHOP_EG_RANK_4, FBK_PST_BISHOP_EG_RANK_5, FBK_PST_BISHOP_EG_RANK_6, FBK_PST_BISHOP_EG_RANK_7, FBK_PST_BISHOP_EG_RANK_8)
+
+/* Rooks seek the seventh rank and central files */
+#define FBK_PST_ROOK_MG_RANK_8 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_MG_RANK_7 FBK_PST_RANK(  2,   5,   5,   5,   5,   5,   5,   2)
+#define FBK_PST_ROOK_MG_RANK_6 FBK_PST_RANK( -2,   0,   0,   0,   0,   0,   0,  -2)
+#define FBK_PST_ROOK_MG_RANK_5 FBK_PST_RANK( -2,   0,   0,   0,   0,   0,   0,  -2)
+#define FBK_PST_ROOK_MG_RANK_4 FBK_PST_RANK( -2,   0,   0,   0,   0,   0,   0,  -2)
+#define FBK_PST_ROOK_MG_RANK_3 FBK_PST_RANK( -2,   0,   0,   0,   0,   0,   0,  -2)
+#define FBK_PST_ROOK_MG_RANK_2 FBK_PST_RANK( -2,   0,   0,   0,   0,   0,   0,  -2)
+#define FBK_PST_ROOK_MG_RANK_1 FBK_PST_RANK(  0,   0,   0,   2,   2,   0,   0,   0)
+#define FBK_PST_ROOK_MG FBK_PST_COLOR_TABLES(FBK_PST_ROOK_MG_RANK_1, FBK_PST_ROOK_MG_RANK_2, FBK_PST_ROOK_MG_RANK_3, FBK_PST_ROOK_MG_RANK_4, FBK_PST_ROOK_MG_RANK_5, FBK_PST_ROOK_MG_RANK_6, FBK_PST_ROOK_MG_RANK_7, FBK_PST_ROOK_MG_RANK_8)
+
+#define FBK_PST_ROOK_EG_RANK_8 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_EG_RANK_7 FBK_PST_RANK(  5,   5,   5,   5,   5,   5,   5,   5)
+#define FBK_PST_ROOK_EG_RANK_6 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_EG_RANK_5 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_EG_RANK_4 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_EG_RANK_3 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_EG_RANK_2 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_EG_RANK_1 FBK_PST_RANK(  0,   0,   0,   0,   0,   0,   0,   0)
+#define FBK_PST_ROOK_EG FBK_PST_COLOR_TABLES(FBK_PST_ROOK_EG_RANK_1, FBK_PST_ROOK_EG_RANK_2, FBK_PST_ROOK_EG_RANK_3, FBK_PST_ROOK_EG_RANK_4, FBK_PST_ROOK_EG_RANK_5, FBK_PST_ROOK_EG_RANK_6, FBK_PST_ROOK_EG_RANK_7, FBK_PST_ROOK_EG_RANK_8)
+
+/* Queens centralize slightly, avoiding early edge squares */
+#define FBK_PST_QUEEN_MG_RANK_8 FBK_PST_RANK(-10,  -5,  -5,  -2,  -2,  -5,  -5, -10)
+#define FBK_PST_QUEEN_MG_RANK_7 FBK_PST_RANK( -5,   0,   0,   0,   0,   0,   0,  -5)
+#define FBK_PST_QUEEN_MG_RANK_6 FBK_PST_RANK( -5,   0,   2,   2,   2,   2,   0,  -5)
+#define FBK_PST_QUEEN_MG_RANK_5 FBK_PST_RANK( -2,   0,   2,   2,   2,   2,   0,  -2)
+#define FBK_PST_QUEEN_MG_RANK_4 FBK_PST_RANK(  0,   0,   2,   2,   2,   2,   0,  -2)
+#define FBK_PST_QUEEN_MG_RANK_3 FBK_PST_RANK( -5,   2,   2,   2,   2,   2,   0,  -5)
+#define FBK_PST_QUEEN_MG_RANK_2 FBK_PST_RANK( -5,   0,   2,   0,   0,   0,   0,  -5)
+#define FBK_PST_QUEEN_MG_RANK_1 FBK_PST_RANK(-10,  -5,  -5,  -2,  -2,  -5,  -5, -10)
+#define FBK_PST_QUEEN_MG FBK_PST_COLOR_TABLES(FBK_PST_QUEEN_MG_RANK_1, FBK_PST_QUEEN_MG_RANK_2, FBK_PST_QUEEN_MG_RANK_3, FBK_PST_QUEEN_MG_RANK_4, FBK_PST_QUEEN_MG_RANK_5, FBK_PST_QUEEN_MG_RANK_6, FBK_PST_QUEEN_MG_RANK_7, FBK_PST_QUEEN_MG_RANK_8)
+
+#define FBK_PST_QUEEN_EG_RANK_8 FBK_PST_RANK(-10,  -5,  -5,  -5,  -5,  -5,  -5, -10)
+#define FBK_PST_QUEEN_EG_RANK_7 FBK_PST_RANK( -5,   0,   0,   0,   0,   0,   0,  -5)
+#define FBK_PST_QUEEN_EG_RANK_6 FBK_PST_RANK( -5,   0,   5,   5,   5,   5,   0,  -5)
+#define FBK_PST_QUEEN_EG_RANK_5 FBK_PST_RANK( -5,   0,   5,   7,   7,   5,   0,  -5)
+#define FBK_PST_QUEEN_EG_RANK_4 FBK_PST_RANK( -5,   0,   5,   7,   7,   5,   0,  -5)
+#define FBK_PST_QUEEN_EG_RANK_3 FBK_PST_RANK( -5,   0,   5,   5,   5,   5,   0,  -5)
+#define FBK_PST_QUEEN_EG_RANK_2 FBK_PST_RANK( -5,   0,   0,   0,   0,   0,   0,  -5)
+#define FBK_PST_QUEEN_EG_RANK_1 FBK_PST_RANK(-10,  -5,  -5,  -5,  -5,  -5,  -5, -10)
+#define FBK_PST_QUEEN_EG FBK_PST_COLOR_TABLES(FBK_PST_QUEEN_EG_RANK_1, FBK_PST_QUEEN_EG_RANK_2, FBK_PST_QUEEN_EG_RANK_3, FBK_PST_QUEEN_EG_RANK_4, FBK_PST_QUEEN_EG_RANK_5, FBK_PST_QUEEN_EG_RANK_6, FBK_PST_QUEEN_EG_RANK_7, FBK_PST_QUEEN_EG_RANK_8)
+
+/* Kings shelter behind pawns in the middlegame and centralize in the endgame */
+#define FBK_PST_KING_MG_RANK_8 FBK_PST_RANK(-15, -20, -20, -25, -25, -20, -20, -15)
+#define FBK_PST_KING_MG_RANK_7 FBK_PST_RANK(-15, -20, -20, -25, -25, -20, -20, -15)
+#define FBK_PST_KING_MG_RANK_6 FBK_PST_RANK(-15, -20, -20, -25, -25, -20, -20, -15)
+#define FBK_PST_KING_MG_RANK_5 FBK_PST_RANK(-15, -20, -20, -25, -25, -20, -20, -15)
+#define FBK_PST_KING_MG_RANK_4 FBK_PST_RANK(-10, -15, -15, -20, -20, -15, -15, -10)
+#define FBK_PST_KING_MG_RANK_3 FBK_PST_RANK( -5, -10, -10, -10, -10, -10, -10,  -5)
+#define FBK_PST_KING_MG_RANK_2 FBK_PST_RANK( 10,  10,   0,   0,   0,   0,  10,  10)
+#define FBK_PST_KING_MG_RANK_1 FBK_PST_RANK( 10,  15,   5,   0,   0,   5,  15,  10)
+#define FBK_PST_KING_MG FBK_PST_COLOR_TABLES(FBK_PST_KING_MG_RANK_1, FBK_PST_KING_MG_RANK_2, FBK_PST_KING_MG_RANK_3, FBK_PST_KING_MG_RANK_4, FBK_PST_KING_MG_RANK_5, FBK_PST_KING_MG_RANK_6, FBK_PST_KING_MG_RANK_7, FBK_PST_KING_MG_RANK_8)
+
+#define FBK_PST_KING_EG_RANK_8 FBK_PST_RANK(-25, -20, -15, -10, -10, -15, -20, -25)
+#define FBK_PST_KING_EG_RANK_7 FBK_PST_RANK(-15, -10,  -5,   0,   0,  -5, -10, -15)
+#define FBK_PST_KING_EG_RANK_6 FBK_PST_RANK(-15,  -5,  10,  15,  15,  10,  -5, -15)
+#define FBK_PST_KING_EG_RANK_5 FBK_PST_RANK(-15,  -5,  15,  20,  20,  15,  -5, -15)
+#define FBK_PST_KING_EG_RANK_4 FBK_PST_RANK(-15,  -5,  15,  20,  20,  15,  -5, -15)
+#define FBK_PST_KING_EG_RANK_3 FBK_PST_RANK(-15,  -5,  10,  15,  15,  10,  -5, -15)
+#define FBK_PST_KING_EG_RANK_2 FBK_PST_RANK(-15, -15,   0,   0,   0,   0, -15, -15)
+#define FBK_PST_KING_EG_RANK_1 FBK_PST_RANK(-25, -15, -15, -15, -15, -15, -15, -25)
+#define FBK_PST_KING_EG FBK_PST_COLOR_TABLES(FBK_PST_KING_EG_RANK_1, FBK_PST_KING_EG_RANK_2, FBK_PST_KING_EG_RANK_3, FBK_PST_KING_EG_RANK_4, FBK_PST_KING_EG_RANK_5, FBK_PST_KING_EG_RANK_6, FBK_PST_KING_EG_RANK_7, FBK_PST_KING_EG_RANK_8)
+
+#endif //_FLY_BY_KNIGHT_PIECE_SQUARE_TABLES_H_
@@ -0,0 +1,162 @@
+/*
+ fly_by_knight_time.h
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Time management for Fly by Knight
+*/
+
+#ifndef _FLY_BY_KNIGHT_TIME_H_
+#define _FLY_BY_KNIGHT_TIME_H_
+
+#include "fly_by_knight_algorithm_constants.h"
+#include "fly_by_knight_types.h"
+
+/* Time per move before the GUI sets a time control */
+#define FBK_TIME_DEFAULT_MOVE_TIME_MS     (10*1000)
+/* Expected moves left in the game when the time control covers the whole game */
+#define FBK_TIME_DEFAULT_MOVES_TO_GO      30
+/* Time kept back on every move for communication and scheduling latency */
+#define FBK_TIME_OVERHEAD_MS              50
+/* Move time when only depth or node limits are given, small enough that extended limits do not overflow */
+#define FBK_TIME_NO_LIMIT_MS              (((fbk_time_ms_t) 1)<<40)
+/* Shortest time allowed for any move */
+#define FBK_TIME_MIN_MOVE_TIME_MS         10
+/* Hard limit as a multiple of the soft limit */
+#define FBK_TIME_HARD_LIMIT_FACTOR        4
+/* Hard limit never uses more than this fraction of the remaining clock, except for the last move of a period */
+#define FBK_TIME_HARD_LIMIT_CLOCK_DIVISOR 3
+/* Soft limit grows by 1/FBK_TIME_INSTABILITY_DEN for each best move change, up to FBK_TIME_INSTABILITY_MAX_CHANGES */
+#define FBK_TIME_INSTABILITY_DEN          2
+#define FBK_TIME_INSTABILITY_MAX_CHANGES  4
+/* An easy move is committed early once at least 1/FBK_TIME_EASY_MOVE_SOFT_LIMIT_DEN of the soft limit is spent and the 
+   best move has been stable for FBK_TIME_EASY_MOVE_MIN_STABLE_EVALUATIONS picker evaluations with no changes this move,
+   searched to FBK_TIME_EASY_MOVE_MIN_DEPTH, leads the second best move by FBK_TIME_EASY_MOVE_MIN_SCORE_GAP and received
+   FBK_TIME_EASY_MOVE_MIN_EFFORT_PERMILLE of the searched nodes */
+#define FBK_TIME_EASY_MOVE_SOFT_LIMIT_DEN          4
+#define FBK_TIME_EASY_MOVE_MIN_STABLE_EVALUATIONS  8
+#define FBK_TIME_EASY_MOVE_MIN_DEPTH               4
+#define FBK_TIME_EASY_MOVE_MIN_SCORE_GAP           (2*FBK_SCORE_PAWN)
+#define FBK_TIME_EASY_MOVE_MIN_EFFORT_PERMILLE     600
+/* Time saved by easy moves is spread over the soft limits of the following moves, each taking 
+   1/FBK_TIME_BANKED_SHARE_DEN of the time still banked */
+#define FBK_TIME_BANKED_SHARE_DEN                  4
+
+/**
+ * @brief Time limits for the current move
+ */
+typedef struct
+{
+  /* Commit once this time is spent and the best move is stable */
+  fbk_time_ms_t soft_limit;
+  /* Always commit once this time is spent */
+  fbk_time_ms_t hard_limit;
+
+} fbk_move_time_budget_s;
+
+/**
+ * @brief Stability of the search for the current move
+ */
+typedef struct
+{
+  /* Consecutive picker evaluations that kept the same best move */
+  unsigned int  stable_evaluations;
+  /* Times the best move changed during the current move */
+  unsigned int  best_move_changes;
+  /* Depth searched below the best move */
+  fbk_depth_t   best_move_depth;
+  /* Score lead of the best move over the second best, 0 if unknown */
+  fbk_score_t   score_gap;
+  /* Share of searched nodes spent under the best move */
+  unsigned int  best_move_effort_permille;
+
+} fbk_search_stability_s;
+
+/**
+ * @brief Initializes time control with a fixed default time per move and no other limits
+ *
+ * @param time_control time control to initialize
+ */
+void fbk_init_time_control(fbk_time_control_s * time_control);
+
+/**
+ * @brief Sets a conventional, incremental or sudden death time control and resets both clocks to the base time
+ *
+ * @param time_control     time control to update
+ * @param moves_per_period moves per period, 0 if the base time covers the whole game
+ * @param base_time        base time per period
+ * @param increment        time added after each engine move
+ */
+void fbk_set_time_control_level(fbk_time_control_s * time_control, unsigned int moves_per_period, fbk_time_ms_t base_time,
+                                fbk_time_ms_t increment);
+
+/**
+ * @brief Sets an exact time per move, replacing any clock based time control
+ *
+ * @param time_control time control to update
+ * @param move_time    time per move
+ */
+void fbk_set_time_control_move_time(fbk_time_control_s * time_control, fbk_time_ms_t move_time);
+
+/**
+ * @brief Resets clocks to the base time and clears depth, node and node rate limits for a new game
+ *
+ * @param time_control time control to reset
+ */
+void fbk_reset_time_control(fbk_time_control_s * time_control);
+
+/**
+ * @brief Charges a committed engine move to the engine's clock until the GUI reports the clock again.  The share of 
+ *        banked time offered to the move is spent whether the move used it or not
+ *
+ * @param time_control time control to update
+ * @param elapsed      time spent on the move as returned by fbk_time_control_elapsed()
+ */
+void fbk_time_control_move_made(fbk_time_control_s * time_control, fbk_time_ms_t elapsed);
+
+/**
+ * @brief Returns time spent on the current move, converted from searched nodes if a node rate is set
+ *
+ * @param time_control active time control
+ * @param wall_time    wall clock time spent on the move
+ * @param nodes        nodes searched for the move
+ */
+fbk_time_ms_t fbk_time_control_elapsed(const fbk_time_control_s * time_control, fbk_time_ms_t wall_time, fbk_node_count_t nodes);
+
+/**
+ * @brief Budgets soft and hard limits for the engine's next move from the remaining time and increment
+ *
+ * @param time_control active time control
+ * @param budget       output budget
+ */
+void fbk_budget_move_time(const fbk_time_control_s * time_control, fbk_move_time_budget_s * budget);
+
+/**
+ * @brief Returns the soft limit extended for an unstable best move, never past the hard limit
+ *
+ * @param budget            budget of current move
+ * @param best_move_changes times the best move changed during the current move
+ */
+fbk_time_ms_t fbk_extended_soft_limit(const fbk_move_time_budget_s * budget, unsigned int best_move_changes);
+
+/**
+ * @brief Returns true if the best move is clearly decided and can be committed before the soft limit
+ *
+ * @param budget    budget of current move
+ * @param elapsed   time spent on the move
+ * @param stability search stability of the current move
+ */
+bool fbk_easy_move(const fbk_move_time_budget_s * budget, fbk_time_ms_t elapsed, const fbk_search_stability_s * stability);
+
+/**
+ * @brief Records an easy move committed before the soft limit.  The unspent time stays on the engine's clock and is 
+ *        spread over the following moves by fbk_budget_move_time()
+ *
+ * @param time_control time control to update
+ * @param budget       budget of the committed move
+ * @param elapsed      time spent on the move
+ */
+void fbk_time_control_easy_move(fbk_time_control_s * time_control, const fbk_move_time_budget_s * budget, fbk_time_ms_t elapsed);
+
+#endif //_FLY_BY_KNIGHT_TIME_H_
@@ -12,6 +12,7 @@
 
 #include <pthread.h>
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdint.h>
@@ -37,9 +38,9 @@ typedef unsigned int fbk_thread_index_t;
 typedef int_fast32_t fbk_score_t;
 
 /**
- * @brief Count of nodes
+ * @brief Count of nodes, 64-bit so long analysis runs do not wrap
 */
-typedef uint_fast32_t fbk_node_count_t;
+typedef uint_fast64_t fbk_node_count_t;
 
 /**
  * @brief Time in count of milliseconds
@@ -62,6 +63,14 @@ typedef uint8_t fbk_breadth_t;
 #define FBK_MAX_ANALYSIS_BREADTH     255
 #define FBK_DEFAULT_ANALYSIS_BREADTH   4
 
+/* Default size of the shared evaluation cache in MiB */
+#define FBK_DEFAULT_EVAL_CACHE_SIZE_MB 16
+#define FBK_MAX_EVAL_CACHE_SIZE_MB     65536
+
+/* Default minimum time between thinking output posts reporting search progress */
+#define FBK_DEFAULT_THINKING_OUTPUT_INTERVAL_MS 100
+#define FBK_MAX_THINKING_OUTPUT_INTERVAL_MS     60000
+
 #define FBK_MOVE_TREE_MAX_NODE_COUNT ((1<<8)-1)
 /**
  * @brief Count of Move Tree nodes
@@ -87,15 +96,99 @@ typedef struct
 
 } fbk_move_tree_node_analysis_data_s;
 
+/* Number of colors and piece types tracked by evaluation bitboards */
+#define FBK_EVAL_COLOR_COUNT      2
+#define FBK_EVAL_PIECE_TYPE_COUNT 6
+
+/* Neural network evaluation inputs (color relative to perspective, piece type and square) and hidden layer size */
+#define FBK_NNUE_INPUT_SIZE  (FBK_EVAL_COLOR_COUNT*FBK_EVAL_PIECE_TYPE_COUNT*64)
+#define FBK_NNUE_HIDDEN_SIZE 256
+/* Hidden layer activations are clipped to [0, FBK_NNUE_QA] */
+#define FBK_NNUE_QA          255
+/* Output weights are quantized by FBK_NNUE_QB */
+#define FBK_NNUE_QB          64
+
+/**
+ * @brief Hidden layer of the neural network evaluation for each perspective, updated as pieces are added and removed
+ * 
+ */
+typedef struct
+{
+  /* Accumulated feature weights from white's (first) and black's perspective */
+  int16_t value[FBK_EVAL_COLOR_COUNT][FBK_NNUE_HIDDEN_SIZE];
+  /* True if accumulators are maintained, only set when the neural network evaluation was enabled on initialization */
+  bool    valid;
+
+} fbk_nnue_accumulator_s;
+
+/**
+ * @brief Position evaluation terms maintained incrementally as moves are applied and undone, so scoring a position only
+ *        needs bitboard operations for mobility and captures
+ * 
+ */
+typedef struct
+{
+  /* Squares occupied by each color (white first) and piece type (pawn through king) */
+  ftk_board_mask_t piece_mask[FBK_EVAL_COLOR_COUNT][FBK_EVAL_PIECE_TYPE_COUNT];
+
+  /* Material score (white advantage) */
+  fbk_score_t material_score;
+  /* Middlegame and endgame piece-square scores (white advantage), interpolated by phase when scoring */
+  fbk_score_t mg_position_score;
+  fbk_score_t eg_position_score;
+  /* Game phase from remaining material, see FBK_PHASE_MAX */
+  uint8_t     phase;
+
+  /* Pawn-only Zobrist key for caching pawn structure scores */
+  ftk_zobrist_hash_key_t pawn_key;
+
+  /* Number of unmoved rooks and kings for castling */
+  uint8_t     white_rooks_not_moved;
+  uint8_t     black_rooks_not_moved;
+  uint8_t     white_king_not_moved;
+  uint8_t     black_king_not_moved;
+
+  /* Neural network accumulators */
+  fbk_nnue_accumulator_s nnue;
+
+} fbk_incremental_eval_s;
+
 /**
  * @brief Move Tree node structure
  * 
  */
+/* Positions kept by a key history and number of buckets of its lookup set (powers of 2) */
+#define FBK_KEY_HISTORY_SIZE     256
+#define FBK_KEY_HISTORY_SET_SIZE 256
+
+/**
+ * @brief Stack of position keys along the game and current search path for repetition detection.  Kept in a ring 
+ *        buffer so the oldest position is overwritten when full
+ * 
+ */
+typedef struct
+{
+  /* Position keys, oldest at head */
+  ftk_zobrist_hash_key_t key[FBK_KEY_HISTORY_SIZE];
+  /* True for positions reached by an irreversible move, earlier positions can never repeat later ones */
+  bool                   irreversible[FBK_KEY_HISTORY_SIZE];
+  /* Index of oldest position */
+  unsigned int           head;
+  /* Number of positions */
+  unsigned int           count;
+  /* Number of positions by low bits of their key, the stack is only scanned when a key may be present */
+  uint16_t               set[FBK_KEY_HISTORY_SET_SIZE];
+
+} fbk_key_history_s;
+
 typedef struct fbk_move_tree_node_struct fbk_move_tree_node_s;
 struct fbk_move_tree_node_struct{
 
   /* Lock for accessing and modifying node */
   fbk_mutex_t                         lock;
+  /* True while a worker thread is analyzing this node's subtree, other workers are diverted to sibling work.  Set and 
+     cleared without the node lock so threads briefly holding the lock do not make the node look claimed */
+  atomic_bool                         claimed;
 
   /* Move represented by this node, invalid if root node*/
   ftk_move_s                          move;
@@ -109,8 +202,11 @@ struct fbk_move_tree_node_struct{
 
   /* Parent node pointer, NULL if root node or compressed */
   fbk_move_tree_node_s               *parent;
-  /* Number of child nodes, only valid after node is evaluated */ 
+  /* Number of child nodes, only valid after node is expanded */ 
   fbk_move_tree_node_count_t          child_count;
+  /* True once child nodes are created.  Nodes are evaluated without children, which are only created when a search 
+     visits the node */
+  bool                                expanded;
   /* Array of 'child_count' child nodes, NULL if compressed */
   fbk_move_tree_node_s               *child;
   /* Size of compressed child data structure.  0 if not compressed */
@@ -159,6 +255,9 @@ typedef enum
   FBK_XBOARD_MODE_EDIT,
 } fbk_xboard_mode_e;
 
+/* Size of rendered best line in thinking output */
+#define FBK_XBOARD_THINKING_LINE_SIZE 1024
+
 typedef struct
 {
   /* Active protocol version */
@@ -179,9 +278,28 @@ typedef struct
   /* Game result reported */
   bool             result_reported;
 
+  /* Best line of last thinking output, rendered again only when its line sequence changes */
+  uint_fast64_t    thinking_line_sequence;
+  char             thinking_line[FBK_XBOARD_THINKING_LINE_SIZE];
+
 } fbk_xboard_data_s;
 #endif
 
+#ifdef FBK_UCI_PROTOCOL_SUPPORT
+typedef struct
+{
+  /* Search started by 'go' and best move not yet reported */
+  bool             searching;
+
+  /* Searching on the opponent's time until 'ponderhit' or 'stop' */
+  bool             pondering;
+
+  /* Position the move tree root was built from ('startpos' or FEN), NULL to rebuild on the next 'position' */
+  char *           position_base;
+
+} fbk_uci_data_s;
+#endif
+
 typedef union
 {
   char              unused;
@@ -189,6 +307,10 @@ typedef union
   /* Data specific to xboard */
   fbk_xboard_data_s xboard;
   #endif
+  #ifdef FBK_UCI_PROTOCOL_SUPPORT
+  /* Data specific to UCI */
+  fbk_uci_data_s    uci;
+  #endif
 
 } fbk_protocol_data_u;
 
@@ -199,6 +321,64 @@ typedef enum
   FBK_OPPONENT_COMPUTER,
 } fbk_opponent_type_e;
 
+/**
+ * @brief Clock and search limits given by the GUI, see fly_by_knight_time.h
+ * 
+ */
+typedef struct
+{
+  /* Moves per time control period, 0 if the base time covers the whole game */
+  unsigned int        moves_per_period;
+  /* Base time per period */
+  fbk_time_ms_t       base_time;
+  /* Time added after each engine move */
+  fbk_time_ms_t       increment;
+  /* Exact time per move, 0 to budget from the clock */
+  fbk_time_ms_t       move_time;
+
+  /* Maximum search depth, 0 for no limit */
+  fbk_depth_t         max_depth;
+  /* Maximum nodes searched per move, 0 for no limit */
+  fbk_node_count_t    max_nodes;
+  /* Search until stopped, only forced picks commit a move */
+  bool                infinite;
+  /* Nodes searched per second of clock time, 0 to use the wall clock */
+  fbk_node_count_t    nodes_per_second;
+
+  /* Remaining time on the engine's and opponent's clocks */
+  fbk_time_ms_t       engine_time;
+  fbk_time_ms_t       opponent_time;
+  /* Engine moves played since the clocks were reset */
+  unsigned int        engine_moves;
+  /* Time already spent pondering the current position before the engine's clock started */
+  fbk_time_ms_t       ponder_credit;
+  /* Easy moves committed before their soft limit this game, and the soft limit time they left unspent */
+  unsigned int        easy_moves;
+  fbk_time_ms_t       saved_time;
+  /* Saved time not yet budgeted, a share is added to each following move's soft limit */
+  fbk_time_ms_t       banked_time;
+
+} fbk_time_control_s;
+
+/**
+ * @brief Pondering on the opponent's time, see fbk_start_pondering()
+ * 
+ */
+typedef struct
+{
+  /* A prediction is pending until the opponent moves */
+  bool                  pending;
+  /* Predicted opponent reply being pondered, invalid when pondering all replies */
+  ftk_move_s            predicted_move;
+  /* Time pondering on the prediction started */
+  struct timespec       start_time;
+
+  /* Number of predictions resolved by an opponent move, and how many were correct */
+  unsigned int          predictions;
+  unsigned int          hits;
+
+} fbk_ponder_state_s;
+
 /**
  * @brief Configures engine behavior
  * 
@@ -213,6 +393,8 @@ typedef struct
 
   /* Output current analysis details */
   bool                thinking_output;
+  /* Minimum time between posts when the best line changes, posts for commits are never delayed */
+  fbk_time_ms_t       thinking_output_interval;
 
   /* Current opponent type */
   fbk_opponent_type_e opponent_type;
@@ -220,6 +402,12 @@ typedef struct
   /* Number of worker threads */
   unsigned int        worker_threads;
 
+  /* Size the worker pool to the cores available to this process */
+  bool                auto_worker_threads;
+
+  /* Pin each worker thread to its own core */
+  bool                pin_worker_threads;
+
 } fbk_engine_config_s;
 
 /**
@@ -244,6 +432,10 @@ typedef struct
   
   /* Time of last move or new game */
   struct timespec     last_move_time;
+  /* Time control, protected by game_lock */
+  fbk_time_control_s  time_control;
+  /* Pondering state, protected by game_lock */
+  fbk_ponder_state_s  ponder;
 
   /* Move tree for current game */
   fbk_move_tree_s     move_tree;
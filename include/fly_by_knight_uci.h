@@ -12,6 +12,13 @@
 
 #include "fly_by_knight_types.h"
 
+/**
+ * @brief Initializes FBK for UCI and identifies the engine and its options
+ * 
+ * @param fbk 
+ */
+void fbk_init_uci_protocol(fbk_instance_s *fbk);
+
 /**
  * @brief Process input string with UCI protocol
  * 
@@ -19,13 +19,18 @@
 #include <farewell_to_king.h>
 #include <farewell_to_king_strings.h>
 
+#include "fly_by_knight_affinity.h"
 #include "fly_by_knight_analysis.h"
+#include "fly_by_knight_analysis_simd.h"
 #include "fly_by_knight_analysis_worker.h"
 #include "fly_by_knight_debug.h"
 #include "fly_by_knight_error.h"
+#include "fly_by_knight_eval_params.h"
 #include "fly_by_knight_io.h"
 #include "fly_by_knight_move_tree.h"
+#include "fly_by_knight_nnue.h"
 #include "fly_by_knight_pick.h"
+#include "fly_by_knight_time.h"
 #include "fly_by_knight_types.h"
 #include "fly_by_knight_version.h"
 
@@ -159,6 +164,7 @@ void fbk_begin_standard_game(fbk_instance_s * fbk, bool flush_analysis)
   fbk_init_move_tree_node(&fbk->move_tree.root, NULL, NULL);
   fbk->move_tree.current = &fbk->move_tree.root;
   fbk->move_tree.initialized = true;
+  fbk->ponder.pending = false;
   fbk_mutex_unlock(&fbk->game_lock);
 
   /* Reset the analysis counter and clock*/
@@ -181,15 +187,17 @@ bool fbk_commit_move(fbk_instance_s * fbk, ftk_move_s * move)
   FBK_ASSERT_MSG(move != NULL, "NULL move pointer passed.");
 
   fbk_mutex_lock(&fbk->game_lock);
-  /* Evaluate this node if not evaluated to generate child nodes */
-  fbk_evaluate_move_tree_node(fbk->move_tree.current, &fbk->game, false);
+  /* Expand this node if not expanded to generate child nodes */
+  fbk_expand_move_tree_node(fbk->move_tree.current, &fbk->game, NULL, false);
 
   /* Find node for given move */
   node = fbk_get_move_tree_node_for_move(fbk->move_tree.current, move);
 
   if(node)
   {
-    /* Commit move */
+    /* Commit move, crediting time pondered on it if it was the predicted reply */
+    fbk->time_control.ponder_credit = 0;
+    fbk_resolve_ponder(fbk, move);
     ftk_move_forward(&fbk->game, move);
     fbk->move_tree.current = node;
   }
@@ -238,6 +246,7 @@ bool fbk_undo_move(fbk_instance_s * fbk)
   {
     ret_val = (FTK_SUCCESS == ftk_move_backward(&fbk->game, &fbk->move_tree.current->move));
     fbk->move_tree.current = fbk->move_tree.current->parent;
+    fbk->ponder.pending = false;
   }
   else
   {
@@ -255,6 +264,63 @@ bool fbk_undo_move(fbk_instance_s * fbk)
   return ret_val;
 }
 
+/**
+ * @brief Drops analysis of the whole move tree except the nodes on the path to the current node, which are reset to 
+ *        unevaluated.  Assumes caller holds the game lock and analysis is stopped with the job queue cleared
+ * 
+ * @param fbk 
+ */
+static void flush_move_tree_analysis(fbk_instance_s * fbk)
+{
+  fbk_move_tree_node_s * path_node = fbk->move_tree.current;
+
+  fbk_unevaluate_move_tree_node(path_node);
+  while(path_node->parent != NULL)
+  {
+    fbk_move_tree_node_s * parent = path_node->parent;
+
+    /* Child arrays on the game's path are never compressed while the current node is below them */
+    for(fbk_move_tree_node_count_t i = 0; i < parent->child_count; i++)
+    {
+      if(&parent->child[i] != path_node)
+      {
+        fbk_unevaluate_move_tree_node(&parent->child[i]);
+      }
+    }
+    memset(&parent->analysis_data, 0, sizeof(fbk_move_tree_node_analysis_data_s));
+
+    path_node = parent;
+  }
+}
+
+bool fbk_set_evaluator(fbk_instance_s * fbk, bool nnue)
+{
+  bool ret_val = true;
+
+  FBK_ASSERT_MSG(fbk != NULL, "NULL fbk_instance pointer passed.");
+
+  if(nnue != fbk_nnue_enabled())
+  {
+    /* Queued jobs carry incremental evaluations of the previous evaluator */
+    const bool analysis_active = fbk_stop_analysis(true);
+
+    fbk_mutex_lock(&fbk->game_lock);
+    ret_val = fbk_set_nnue_enabled(nnue);
+    if(ret_val)
+    {
+      flush_move_tree_analysis(fbk);
+    }
+    fbk_mutex_unlock(&fbk->game_lock);
+
+    if(analysis_active)
+    {
+      fbk_start_analysis(&fbk->game, fbk->move_tree.current);
+    }
+  }
+
+  return ret_val;
+}
+
 static inline fbk_time_ms_t timespec_diff(struct timespec *time_a, struct timespec *time_b)
 {
   FBK_ASSERT_MSG(time_a != NULL, "Time A is null");
@@ -281,6 +347,9 @@ fbk_time_ms_t fbk_get_move_time_ms(fbk_instance_s * fbk)
 typedef struct 
 {
   unsigned int worker_threads;
+  bool         auto_worker_threads;
+  bool         pin_worker_threads;
+  unsigned int eval_cache_size_mb;
 } fbk_arguments_s;
 
 /**
@@ -301,6 +370,10 @@ void init(fbk_instance_s * fbk, const fbk_arguments_s * arguments)
   fbk->config.random           = false;
   fbk->config.analysis_breadth = FBK_DEFAULT_ANALYSIS_BREADTH;
   fbk->config.opponent_type    = FBK_OPPONENT_UNKNOWN;
+  fbk->config.thinking_output_interval = FBK_DEFAULT_THINKING_OUTPUT_INTERVAL_MS;
+  fbk->config.auto_worker_threads = arguments->auto_worker_threads;
+  fbk->config.pin_worker_threads  = arguments->pin_worker_threads;
+  fbk_init_time_control(&fbk->time_control);
 
   setbuf(stdout, NULL);
 
@@ -308,6 +381,8 @@ void init(fbk_instance_s * fbk, const fbk_arguments_s * arguments)
   fbk_begin_standard_game(fbk, true);
 
   FBK_ASSERT_MSG(fbk_init_analysis_lut(), "Failed to initialize analysis look-up tables");
+  fbk_init_eval_cache(arguments->eval_cache_size_mb);
+  fbk_init_cpu_affinity();
   FBK_ASSERT_MSG(fbk_init_analysis_data(fbk), "Failed to initialize analysis data");
   fbk_update_worker_thread_count(arguments->worker_threads);
 
@@ -338,11 +413,18 @@ void display_help(bool user_requested, bool exit_fbk)
   fprintf(output_stream,
           "Usage: flybyknight [OPTION]...\n"
           "Chess engine following the xboard protocol with the UCI protocol in mind.\n"
+          "  -c#,        --cache=#       size evaluation cache to # MiB, 0 to disable (default %u)\n"
           "  -d#,        --debug=#       start with debug logging level [0(disabled) - 9(maximum)]\n"
+          "  -e [path],  --eval=[path]   load evaluation parameters from file at given 'path'\n"
           "  -h,         --help          display this help and exit\n"
-          "  -j#,        --jobs=#        start with given number of worker threads\n"
+          "  -j#,        --jobs=#        start with given number of worker threads, 'auto' for one per available core\n"
           "  -l [path],  --log=[path]    log output to file at given 'path'\n"
-          "  -v,         --version       display complete version information\n");
+          "  -n [path],  --nnue=[path]   evaluate with the neural network at given 'path'\n"
+          "  -p,         --pin           pin each worker thread to its own core\n"
+          "  -s [level], --simd=[level]  limit evaluation instruction set to 'scalar', 'popcnt', 'avx2' or 'neon' (default best supported)\n"
+          "  -v,         --version       display complete version information\n"
+          "  -w [param], --weight=[param] set one evaluation parameter, e.g. 'piece_value[1]=3200'\n",
+          FBK_DEFAULT_EVAL_CACHE_SIZE_MB);
   
   if(exit_fbk)
   {
@@ -415,24 +497,46 @@ void parse_arguments(int argc, char *argv[], fbk_arguments_s *arguments)
   FBK_ASSERT_MSG(arguments != NULL, "Empty arguments structure passed");
 
   memset(arguments, 0, sizeof(fbk_arguments_s));
-  arguments->worker_threads = 1;
+  arguments->worker_threads     = 1;
+  arguments->eval_cache_size_mb = FBK_DEFAULT_EVAL_CACHE_SIZE_MB;
 
   int option;
   int option_index = 0;
   static struct option long_options[] = {
+      {"cache",   required_argument, 0,  'c' },
       {"debug",   required_argument, 0,  'd' },
+      {"eval",    required_argument, 0,  'e' },
       {"jobs",    required_argument, 0,  'j' },
       {"log",     required_argument, 0,  'l' },
+      {"nnue",    required_argument, 0,  'n' },
+      {"pin",     no_argument,       0,  'p' },
+      {"simd",    required_argument, 0,  's' },
       {"help",    no_argument,       0,  'h' },
       {"version", no_argument,       0,  'v' },
+      {"weight",  required_argument, 0,  'w' },
       {0,         0,                 0,   0  }
   };
 
   bool argument_error = false;
-  while(!argument_error && ((option = getopt_long(argc, argv, "d:j:l:hv", long_options, &option_index)) != -1))
+  while(!argument_error && ((option = getopt_long(argc, argv, "c:d:e:j:l:n:ps:hvw:", long_options, &option_index)) != -1))
   {
     switch(option)
     {
+      case 'c':
+      {
+        char * end;
+        const long size_mb = strtol(optarg, &end, 10);
+        if((end == optarg) || (*end != '\0') || (size_mb < 0) || (size_mb > FBK_MAX_EVAL_CACHE_SIZE_MB))
+        {
+          FBK_ERROR_MSG("Invalid evaluation cache size '%s'.", optarg);
+          argument_error = true;
+        }
+        else
+        {
+          arguments->eval_cache_size_mb = size_mb;
+        }
+        break;
+      }
       case 'd':
       {
         int debug = atoi(optarg);
@@ -446,9 +550,27 @@ void parse_arguments(int argc, char *argv[], fbk_arguments_s *arguments)
         }
         break;
       }
+      case 'e':
+      {
+        #ifdef FBK_RUNTIME_EVAL_PARAMS
+        argument_error = !fbk_load_eval_params(&fbk_eval_params, optarg);
+        #else
+        FBK_ERROR_MSG("Built without runtime evaluation parameters, rebuild with RUNTIME_EVAL_PARAMETERS to load %s.", optarg);
+        argument_error = true;
+        #endif
+        break;
+      }
       case 'j':
       {
-        arguments->worker_threads = atoi(optarg);
+        arguments->auto_worker_threads = (strcmp("auto", optarg) == 0);
+        if(arguments->auto_worker_threads)
+        {
+          arguments->worker_threads = fbk_get_available_core_count();
+        }
+        else
+        {
+          arguments->worker_threads = atoi(optarg);
+        }
         if(arguments->worker_threads < 1)
         {
           FBK_ERROR_MSG("At least 1 worker thread is required but argument passed %u.", arguments->worker_threads);
@@ -461,6 +583,37 @@ void parse_arguments(int argc, char *argv[], fbk_arguments_s *arguments)
         fbk_open_log_file(optarg);
         break;
       }
+      case 'n':
+      {
+        argument_error = !(fbk_load_nnue_network(optarg) && fbk_set_nnue_enabled(true));
+        break;
+      }
+      case 'p':
+      {
+        arguments->pin_worker_threads = true;
+        break;
+      }
+      case 's':
+      {
+        fbk_simd_level_e level;
+        for(level = 0; level < FBK_SIMD_LEVEL_COUNT; level++)
+        {
+          if(strcmp(fbk_simd_level_string(level), optarg) == 0)
+          {
+            break;
+          }
+        }
+        if(level < FBK_SIMD_LEVEL_COUNT)
+        {
+          fbk_limit_simd_level(level);
+        }
+        else
+        {
+          FBK_ERROR_MSG("Unknown instruction set '%s'.", optarg);
+          argument_error = true;
+        }
+        break;
+      }
       case 'h':
       {
         display_help(true, true);
@@ -471,6 +624,16 @@ void parse_arguments(int argc, char *argv[], fbk_arguments_s *arguments)
         version_details_requested = true;
         break;
       }
+      case 'w':
+      {
+        #ifdef FBK_RUNTIME_EVAL_PARAMS
+        argument_error = !fbk_parse_eval_param(&fbk_eval_params, optarg);
+        #else
+        FBK_ERROR_MSG("Built without runtime evaluation parameters, rebuild with RUNTIME_EVAL_PARAMETERS to set %s.", optarg);
+        argument_error = true;
+        #endif
+        break;
+      }
       default:
       {
         argument_error = true;
@@ -0,0 +1,355 @@
+/*
+ fly_by_knight_affinity.c
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ CPU core detection and thread affinity for Fly by Knight
+*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fly_by_knight.h"
+#include "fly_by_knight_affinity.h"
+#include "fly_by_knight_debug.h"
+#include "fly_by_knight_error.h"
+
+#ifdef __linux__
+/* CPU affinity masks, sysfs topology and cgroups are only available on Linux */
+#define FBK_CPU_AFFINITY_SUPPORT
+#endif
+
+/* Highest NUMA node index probed in sysfs */
+#define FBK_MAX_NUMA_NODES 64
+/* Buffer size for reading single line sysfs, procfs and cgroup files */
+#define FBK_AFFINITY_LINE_SIZE 512
+
+static pthread_once_t cpu_affinity_once = PTHREAD_ONCE_INIT;
+
+/* Number of cores available based on affinity mask and CPU quota */
+static unsigned int available_core_count = 1;
+
+#ifdef FBK_CPU_AFFINITY_SUPPORT
+/* CPUs this process may run on */
+static cpu_set_t    process_cpu_set;
+/* Number of CPUs in process_cpu_set */
+static unsigned int process_cpu_count = 0;
+/* CPUs of process_cpu_set in the order threads are pinned to them */
+static int          pin_order[CPU_SETSIZE];
+
+/* Topology details for ordering CPUs */
+typedef struct
+{
+  int cpu;
+  /* NUMA node the CPU belongs to */
+  int numa_node;
+  /* Index of CPU among SMT siblings of its physical core, 0 for the first hardware thread */
+  int smt_index;
+} cpu_topology_s;
+
+/**
+ * @brief Reads the first line of a file
+ * @param path   file to read
+ * @param buffer output buffer
+ * @param size   size of output buffer
+ *
+ * @return true if a line was read
+*/
+static bool read_first_line(const char * path, char * buffer, size_t size)
+{
+  bool ret_val = false;
+  FILE * file  = fopen(path, "r");
+
+  if(file != NULL)
+  {
+    ret_val = (fgets(buffer, size, file) == buffer);
+    fclose(file);
+  }
+
+  return ret_val;
+}
+
+/**
+ * @brief Parses a kernel CPU list (e.g. "0-3,8-11") into a CPU set
+ * @param list CPU list string
+ * @param set  output CPU set
+*/
+static void parse_cpu_list(const char * list, cpu_set_t * set)
+{
+  CPU_ZERO(set);
+
+  while(*list != '\0')
+  {
+    char * end;
+    const long first = strtol(list, &end, 10);
+    long       last  = first;
+    if(end == list)
+    {
+      break;
+    }
+    if('-' == *end)
+    {
+      list = end+1;
+      last = strtol(list, &end, 10);
+      if(end == list)
+      {
+        break;
+      }
+    }
+    for(long cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); cpu++)
+    {
+      CPU_SET(cpu, set);
+    }
+
+    list = end;
+    if(',' != *list)
+    {
+      break;
+    }
+    list++;
+  }
+}
+
+/**
+ * @brief Reads the cgroup CPU bandwidth limit (cgroup v2 cpu.max, else cgroup v1 CFS quota)
+ *
+ * @return number of cores worth of CPU time allowed, 0 if not limited
+*/
+static unsigned int cgroup_quota_core_count()
+{
+  char line[FBK_AFFINITY_LINE_SIZE];
+  char path[FBK_AFFINITY_LINE_SIZE+32];
+  long long quota = -1, period = 0;
+  bool cpu_max_found = false;
+
+  /* cgroup v2, prefer the process's own cgroup over the mounted root */
+  FILE * cgroup_file = fopen("/proc/self/cgroup", "r");
+  if(cgroup_file != NULL)
+  {
+    while(fgets(line, sizeof(line), cgroup_file) == line)
+    {
+      if(strncmp("0::", line, 3) == 0)
+      {
+        line[strcspn(line, "\n")] = '\0';
+        snprintf(path, sizeof(path), "/sys/fs/cgroup%s/cpu.max", &line[3]);
+        cpu_max_found = read_first_line(path, line, sizeof(line));
+        break;
+      }
+    }
+    fclose(cgroup_file);
+  }
+  if(!cpu_max_found)
+  {
+    cpu_max_found = read_first_line("/sys/fs/cgroup/cpu.max", line, sizeof(line));
+  }
+
+  if(cpu_max_found)
+  {
+    /* Format is "<quota|max> <period>" */
+    if(strncmp("max", line, 3) != 0)
+    {
+      if(2 != sscanf(line, "%lld %lld", &quota, &period))
+      {
+        quota = -1;
+      }
+    }
+  }
+  else if(read_first_line("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", line, sizeof(line)))
+  {
+    /* cgroup v1, quota of -1 is unlimited */
+    quota = atoll(line);
+    if(read_first_line("/sys/fs/cgroup/cpu/cpu.cfs_period_us", line, sizeof(line)))
+    {
+      period = atoll(line);
+    }
+  }
+
+  if((quota > 0) && (period > 0))
+  {
+    FBK_DEBUG_MSG(FBK_DEBUG_MED, "cgroup CPU quota %lld per period %lld.", quota, period);
+    /* Round up partial cores */
+    return (unsigned int) ((quota + period - 1) / period);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Returns the SMT sibling index of a CPU on its physical core
+ * @param cpu CPU of interest
+*/
+static int cpu_smt_index(int cpu)
+{
+  char line[FBK_AFFINITY_LINE_SIZE];
+  char path[FBK_AFFINITY_LINE_SIZE];
+  cpu_set_t siblings;
+  int smt_index = 0;
+
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+  if(read_first_line(path, line, sizeof(line)))
+  {
+    parse_cpu_list(line, &siblings);
+    for(int i = 0; i < cpu; i++)
+    {
+      if(CPU_ISSET(i, &siblings))
+      {
+        smt_index++;
+      }
+    }
+  }
+
+  return smt_index;
+}
+
+/**
+ * @brief Compares CPUs for pinning order: SMT index, then NUMA node, then CPU number.  Every physical core on every 
+ *        NUMA node is used before any SMT sibling.
+*/
+static int compare_cpu_topology(const void * a, const void * b)
+{
+  const cpu_topology_s * cpu_a = (const cpu_topology_s *) a;
+  const cpu_topology_s * cpu_b = (const cpu_topology_s *) b;
+
+  if(cpu_a->smt_index != cpu_b->smt_index)
+  {
+    return cpu_a->smt_index - cpu_b->smt_index;
+  }
+  if(cpu_a->numa_node != cpu_b->numa_node)
+  {
+    return cpu_a->numa_node - cpu_b->numa_node;
+  }
+  return cpu_a->cpu - cpu_b->cpu;
+}
+#endif /* FBK_CPU_AFFINITY_SUPPORT */
+
+/**
+ * @brief One-time detection of available cores and pinning order
+*/
+static void init_cpu_affinity_once()
+{
+#ifdef FBK_CPU_AFFINITY_SUPPORT
+  if(0 == sched_getaffinity(0, sizeof(process_cpu_set), &process_cpu_set))
+  {
+    process_cpu_count = CPU_COUNT(&process_cpu_set);
+  }
+  else
+  {
+    FBK_ERROR_MSG("Failed to read CPU affinity mask.");
+    process_cpu_count = 0;
+  }
+
+  if(process_cpu_count > 0)
+  {
+    cpu_topology_s * topology = calloc(process_cpu_count, sizeof(cpu_topology_s));
+    FBK_ASSERT_MSG(topology != NULL, "Failed to allocate memory for CPU topology.");
+
+    unsigned int count = 0;
+    for(int cpu = 0; (cpu < CPU_SETSIZE) && (count < process_cpu_count); cpu++)
+    {
+      if(CPU_ISSET(cpu, &process_cpu_set))
+      {
+        topology[count].cpu       = cpu;
+        topology[count].smt_index = cpu_smt_index(cpu);
+        count++;
+      }
+    }
+
+    /* Map CPUs to NUMA nodes, CPUs without a listed node stay on node 0 */
+    char line[FBK_AFFINITY_LINE_SIZE];
+    char path[FBK_AFFINITY_LINE_SIZE];
+    for(int node = 0; node < FBK_MAX_NUMA_NODES; node++)
+    {
+      cpu_set_t node_cpu_set;
+      snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+      if(read_first_line(path, line, sizeof(line)))
+      {
+        parse_cpu_list(line, &node_cpu_set);
+        for(unsigned int i = 0; i < count; i++)
+        {
+          if(CPU_ISSET(topology[i].cpu, &node_cpu_set))
+          {
+            topology[i].numa_node = node;
+          }
+        }
+      }
+    }
+
+    qsort(topology, count, sizeof(cpu_topology_s), compare_cpu_topology);
+    for(unsigned int i = 0; i < count; i++)
+    {
+      pin_order[i] = topology[i].cpu;
+    }
+    free(topology);
+
+    available_core_count = process_cpu_count;
+  }
+
+  const unsigned int quota_core_count = cgroup_quota_core_count();
+  if((quota_core_count > 0) && (quota_core_count < available_core_count))
+  {
+    available_core_count = quota_core_count;
+  }
+#elif defined(_SC_NPROCESSORS_ONLN)
+  const long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  available_core_count = (online_cpus > 0)?online_cpus:1;
+#endif
+
+  FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Detected %u available cores.", available_core_count);
+}
+
+void fbk_init_cpu_affinity()
+{
+  pthread_once(&cpu_affinity_once, init_cpu_affinity_once);
+}
+
+unsigned int fbk_get_available_core_count()
+{
+  fbk_init_cpu_affinity();
+  return available_core_count;
+}
+
+bool fbk_pin_thread(fbk_thread_index_t thread_index)
+{
+  bool ret_val = false;
+
+  fbk_init_cpu_affinity();
+
+#ifdef FBK_CPU_AFFINITY_SUPPORT
+  if(process_cpu_count > 0)
+  {
+    cpu_set_t thread_cpu_set;
+    const int cpu = pin_order[thread_index % process_cpu_count];
+    CPU_ZERO(&thread_cpu_set);
+    CPU_SET(cpu, &thread_cpu_set);
+    ret_val = (0 == pthread_setaffinity_np(pthread_self(), sizeof(thread_cpu_set), &thread_cpu_set));
+    FBK_DEBUG_MSG(FBK_DEBUG_MED, "Pinning thread %u to CPU %d %s.", thread_index, cpu, ret_val?"succeeded":"failed");
+  }
+#else
+  FBK_UNUSED(thread_index);
+#endif
+
+  return ret_val;
+}
+
+bool fbk_unpin_thread()
+{
+  bool ret_val = false;
+
+  fbk_init_cpu_affinity();
+
+#ifdef FBK_CPU_AFFINITY_SUPPORT
+  if(process_cpu_count > 0)
+  {
+    ret_val = (0 == pthread_setaffinity_np(pthread_self(), sizeof(process_cpu_set), &process_cpu_set));
+  }
+#endif
+
+  return ret_val;
+}
@@ -7,284 +7,426 @@
  Core gama analysis for Fly by Knight
 */
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <farewell_to_king.h>
 #include <farewell_to_king_strings.h>
 
 #include "fly_by_knight_algorithm_constants.h"
 #include "fly_by_knight_analysis.h"
+#include "fly_by_knight_analysis_simd.h"
 #include "fly_by_knight_debug.h"
 #include "fly_by_knight_error.h"
+#include "fly_by_knight_eval_params.h"
 #include "fly_by_knight_hash.h"
 #include "fly_by_knight_move_tree.h"
+#include "fly_by_knight_nnue.h"
 
-/* Constant after initialized */
-static const struct fbk_analysis_lookup_table_struct
+/* Evaluation bitboard index of each piece type */
+static const ftk_type_e eval_piece_type[FBK_EVAL_PIECE_TYPE_COUNT] = 
 {
-  bool initialized;
+  FTK_TYPE_PAWN, FTK_TYPE_KNIGHT, FTK_TYPE_BISHOP, FTK_TYPE_ROOK, FTK_TYPE_QUEEN, FTK_TYPE_KING,
+};
+#ifdef FBK_RUNTIME_EVAL_PARAMS
+/* Parameters loaded at runtime */
+#define EVAL_PARAMS fbk_eval_params
+#else
+/* Default parameters as constants so the compiler folds them into evaluation */
+static const fbk_eval_params_s default_eval_params = FBK_DEFAULT_EVAL_PARAMS;
+#define EVAL_PARAMS default_eval_params
+#endif
+
+#define EVAL_WHITE 0
+#define EVAL_BLACK 1
+
+#define EVAL_PAWN   0
+#define EVAL_KNIGHT 1
+#define EVAL_ROOK   3
+#define EVAL_KING   5
+
+/* Squares of the A file */
+#define EVAL_FILE_A_MASK 0x0101010101010101ULL
 
-  fbk_score_t white_pawn_position_score  [FTK_STD_BOARD_SIZE];
-  fbk_score_t black_pawn_position_score  [FTK_STD_BOARD_SIZE];
-  fbk_score_t white_knight_position_score[FTK_STD_BOARD_SIZE];
-  fbk_score_t black_knight_position_score[FTK_STD_BOARD_SIZE];
-
-} *lut = NULL;
-
-bool fbk_init_analysis_lut()
+/**
+ * @brief Returns evaluation bitboard index of a piece type, -1 if empty
+ */
+static inline int eval_piece_index(ftk_type_e type)
 {
-  bool ret_val = true;
-
-  if(lut == NULL)
+  switch(type)
   {
-    struct fbk_analysis_lookup_table_struct *new_lut = calloc(1, sizeof(*new_lut));
-
-    for(unsigned int i = 0; i < FTK_STD_BOARD_SIZE; i++)
-    {
-      switch(i/8)
-      {
-        case 0:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FIRST_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_EIGHTH_ROW;
-          break;
-        }
-        case 1:
-        {
-          new_lut->white_pawn_position_score[i] += FBK_SCORE_PAWN_SECOND_ROW;
-          new_lut->black_pawn_position_score[i] += FBK_SCORE_PAWN_SEVENTH_ROW;
-
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_SECOND_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_SEVENTH_ROW;
-          break;
-        }
-        case 2:
-        {
-          new_lut->white_pawn_position_score[i] += FBK_SCORE_PAWN_THIRD_ROW;
-          new_lut->black_pawn_position_score[i] += FBK_SCORE_PAWN_SIXTH_ROW;
-
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_THIRD_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_SIXTH_ROW;
-          break;
-        }
-        case 3:
-        {
-          new_lut->white_pawn_position_score[i] += FBK_SCORE_PAWN_FOURTH_ROW;
-          new_lut->black_pawn_position_score[i] += FBK_SCORE_PAWN_FIFTH_ROW;
-
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FOURTH_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FIFTH_ROW;
-          break;
-        }
-        case 4:
-        {
-          new_lut->white_pawn_position_score[i] += FBK_SCORE_PAWN_FIFTH_ROW;
-          new_lut->black_pawn_position_score[i] += FBK_SCORE_PAWN_FOURTH_ROW;
-
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FIFTH_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FOURTH_ROW;
-          break;
-        }
-        case 5:
-        {
-          new_lut->white_pawn_position_score[i] += FBK_SCORE_PAWN_SIXTH_ROW;
-          new_lut->black_pawn_position_score[i] += FBK_SCORE_PAWN_THIRD_ROW;
-
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_SIXTH_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_THIRD_ROW;
-          break;
-        }
-        case 6:
-        {
-          new_lut->white_pawn_position_score[i] += FBK_SCORE_PAWN_SEVENTH_ROW;
-          new_lut->black_pawn_position_score[i] += FBK_SCORE_PAWN_SECOND_ROW;
-
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_SEVENTH_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_SECOND_ROW;
-          break;
-        }
-        case 7:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_EIGHTH_ROW;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FIRST_ROW;
-          break;
-        }
-        default:
-        {
-          FBK_FATAL_MSG("Unexpected position %u", i);
-          break;
-        }
-      }
-
-      switch(i%8)
-      {
-        case 0:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_A;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_A;
-          break;
-        }
-        case 1:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_B;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_B;
-          break;
-        }
-        case 2:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_C;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_C;
-          break;
-        }
-        case 3:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_D;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_D;
-          break;
-        }
-        case 4:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_E;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_E;
-          break;
-        }
-        case 5:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_F;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_F;
-          break;
-        }
-        case 6:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_G;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_G;
-          break;
-        }
-        case 7:
-        {
-          new_lut->white_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_H;
-          new_lut->black_knight_position_score[i] += FBK_SCORE_KNIGHT_FILE_H;
-          break;
-        }
-        default:
-        {
-          FBK_FATAL_MSG("Unexpected position %u", i);
-          break;
-        }
-      }
-    }
+    case FTK_TYPE_PAWN:   return 0;
+    case FTK_TYPE_KNIGHT: return 1;
+    case FTK_TYPE_BISHOP: return 2;
+    case FTK_TYPE_ROOK:   return 3;
+    case FTK_TYPE_QUEEN:  return 4;
+    case FTK_TYPE_KING:   return 5;
+    default:              return -1;
+  }
+}
 
+/* Game phase weight of each piece type */
+static const uint8_t eval_piece_phase[FBK_EVAL_PIECE_TYPE_COUNT] = 
+{
+  0, FBK_PHASE_KNIGHT, FBK_PHASE_BISHOP, FBK_PHASE_ROOK, FBK_PHASE_QUEEN, 0,
+};
 
-    /* Score pawn center squares */
-    new_lut->white_pawn_position_score[FTK_D4] = FBK_SCORE_PAWN_CENTER_SQUARE;
-    new_lut->white_pawn_position_score[FTK_E4] = FBK_SCORE_PAWN_CENTER_SQUARE;
-    new_lut->white_pawn_position_score[FTK_D5] = FBK_SCORE_PAWN_CENTER_SQUARE;
-    new_lut->white_pawn_position_score[FTK_E5] = FBK_SCORE_PAWN_CENTER_SQUARE;
-    new_lut->black_pawn_position_score[FTK_D4] = FBK_SCORE_PAWN_CENTER_SQUARE;
-    new_lut->black_pawn_position_score[FTK_E4] = FBK_SCORE_PAWN_CENTER_SQUARE;
-    new_lut->black_pawn_position_score[FTK_D5] = FBK_SCORE_PAWN_CENTER_SQUARE;
-    new_lut->black_pawn_position_score[FTK_E5] = FBK_SCORE_PAWN_CENTER_SQUARE;
+/**
+ * @brief Interpolates middlegame and endgame scores by game phase
+ * 
+ * @param mg_score middlegame score
+ * @param eg_score endgame score
+ * @param phase    game phase, FBK_PHASE_MAX or more is pure middlegame
+ * @return fbk_score_t 
+ */
+static inline fbk_score_t taper_score(fbk_score_t mg_score, fbk_score_t eg_score, unsigned int phase)
+{
+  if(phase > FBK_PHASE_MAX)
+  {
+    /* Promotions may raise phase above starting material */
+    phase = FBK_PHASE_MAX;
+  }
 
+  return ((mg_score * (fbk_score_t) phase) + (eg_score * (fbk_score_t) (FBK_PHASE_MAX - phase))) / FBK_PHASE_MAX;
+}
 
-    /* Follow Kasparov's 'Knight on F6 is worth a Pawn'*/
-    new_lut->white_knight_position_score[FTK_F6] = FBK_SCORE_PAWN;
-    new_lut->black_knight_position_score[FTK_F3] = FBK_SCORE_PAWN;
+/**
+ * @brief Returns mask of the given file and its adjacent files
+ */
+static inline ftk_board_mask_t adjacent_files_mask(unsigned int file)
+{
+  ftk_board_mask_t mask = EVAL_FILE_A_MASK << file;
 
-    new_lut->initialized = true;
-    lut = new_lut;
+  if(file > 0)
+  {
+    mask |= EVAL_FILE_A_MASK << (file-1);
+  }
+  if(file < 7)
+  {
+    mask |= EVAL_FILE_A_MASK << (file+1);
   }
 
-  return ret_val;
+  return mask;
 }
 
-fbk_score_t fbk_score_potential_capture_value(ftk_type_e piece_type)
+/**
+ * @brief Scores pawn structure (doubled, isolated and passed pawns) for white advantage
+ * 
+ * @param white_pawns squares of white pawns
+ * @param black_pawns squares of black pawns
+ * @return fbk_score_t 
+ */
+static fbk_score_t score_pawn_structure(ftk_board_mask_t white_pawns, ftk_board_mask_t black_pawns)
 {
   fbk_score_t score = 0;
 
-  switch (piece_type)
+  for(unsigned int file = 0; file < 8; file++)
   {
-    case FTK_TYPE_PAWN:
-    {
-      score = FBK_SCORE_CAPTURE_PAWN;
-      break;
-    }
-    case FTK_TYPE_KNIGHT:
+    const ftk_board_mask_t file_mask          = EVAL_FILE_A_MASK << file;
+    const ftk_board_mask_t neighbor_mask      = adjacent_files_mask(file) & ~file_mask;
+    const unsigned int     white_pawn_count   = ftk_get_num_bits_set(white_pawns & file_mask);
+    const unsigned int     black_pawn_count   = ftk_get_num_bits_set(black_pawns & file_mask);
+
+    if(white_pawn_count > 1)
     {
-      score = FBK_SCORE_CAPTURE_KNIGHT;
-      break;
+      /* base*2^(doubled_pawn_count-2)) */
+      score -= EVAL_PARAMS.double_pawn_base_penalty * (1 << (white_pawn_count-2));
     }
-    case FTK_TYPE_BISHOP:
+    if(black_pawn_count > 1)
     {
-      score = FBK_SCORE_CAPTURE_BISHOP;
-      break;
+      /* base*2^(doubled_pawn_count-2)) */
+      score += EVAL_PARAMS.double_pawn_base_penalty * (1 << (black_pawn_count-2));
     }
-    case FTK_TYPE_ROOK:
+
+    if(0 == (white_pawns & neighbor_mask))
     {
-      score = FBK_SCORE_CAPTURE_ROOK;
-      break;
+      score -= EVAL_PARAMS.isolated_pawn_penalty * white_pawn_count;
     }
-    case FTK_TYPE_QUEEN:
+    if(0 == (black_pawns & neighbor_mask))
     {
-      score = FBK_SCORE_CAPTURE_QUEEN;
-      break;
+      score += EVAL_PARAMS.isolated_pawn_penalty * black_pawn_count;
     }
-    case FTK_TYPE_KING:
+  }
+
+  ftk_board_mask_t pawns = white_pawns;
+  while(pawns)
+  {
+    const ftk_square_e square = ftk_get_first_set_bit_idx(pawns);
+    FTK_CLEAR_BIT(pawns, square);
+    const unsigned int rank = square / 8;
+    /* Ranks ahead of white pawn */
+    const ftk_board_mask_t ahead_mask = (rank < 7)?(~((ftk_board_mask_t) 0) << (8*(rank+1))):0;
+    if(0 == (black_pawns & ahead_mask & adjacent_files_mask(square % 8)))
     {
-      score = FBK_SCORE_CAPTURE_KING;
-      break;
+      score += EVAL_PARAMS.passed_pawn[rank];
     }
-    default:
+  }
+
+  pawns = black_pawns;
+  while(pawns)
+  {
+    const ftk_square_e square = ftk_get_first_set_bit_idx(pawns);
+    FTK_CLEAR_BIT(pawns, square);
+    const unsigned int rank = square / 8;
+    /* Ranks ahead of black pawn */
+    const ftk_board_mask_t ahead_mask = (rank > 0)?(~((ftk_board_mask_t) 0) >> (8*(8-rank))):0;
+    if(0 == (white_pawns & ahead_mask & adjacent_files_mask(square % 8)))
     {
-      break;
+      score -= EVAL_PARAMS.passed_pawn[7-rank];
     }
   }
 
   return score;
 }
 
-fbk_score_t fbk_score_potential_loss_value(ftk_type_e piece_type)
+/* Entries in each thread's pawn hash table, must be a power of 2 */
+#define FBK_PAWN_HASH_TABLE_SIZE 4096
+
+/* Cached pawn structure score */
+typedef struct
 {
-  fbk_score_t score = 0;
+  ftk_zobrist_hash_key_t key;
+  fbk_score_t            score;
+  bool                   valid;
+} pawn_hash_entry_s;
+
+/* Evaluation data private to one thread, so lookups need no locking */
+typedef struct
+{
+  /* Lookups since counts were last taken */
+  fbk_eval_counts_s counts;
+
+  /* Pawn hash table */
+  pawn_hash_entry_s pawn_hash[FBK_PAWN_HASH_TABLE_SIZE];
+} eval_thread_data_s;
+
+static pthread_once_t eval_thread_data_key_once = PTHREAD_ONCE_INIT;
+/* Thread-specific key holding each thread's evaluation data, freed on thread exit */
+static pthread_key_t  eval_thread_data_key;
+
+static void create_eval_thread_data_key()
+{
+  FBK_ASSERT_MSG(0 == pthread_key_create(&eval_thread_data_key, free), "Failed to create evaluation thread data key.");
+}
+
+/**
+ * @brief Returns the calling thread's evaluation data, allocating it on first use
+ */
+static eval_thread_data_s * get_eval_thread_data()
+{
+  eval_thread_data_s * data = pthread_getspecific(eval_thread_data_key);
 
-  switch (piece_type)
+  if(NULL == data)
   {
-    case FTK_TYPE_PAWN:
-    {
-      score = FBK_SCORE_LOSS_PAWN;
-      break;
-    }
-    case FTK_TYPE_KNIGHT:
-    {
-      score = FBK_SCORE_LOSS_KNIGHT;
-      break;
-    }
-    case FTK_TYPE_BISHOP:
-    {
-      score = FBK_SCORE_LOSS_BISHOP;
-      break;
-    }
-    case FTK_TYPE_ROOK:
+    /* Allocated by the thread using it so pinned workers touch local memory */
+    data = calloc(1, sizeof(eval_thread_data_s));
+    FBK_ASSERT_MSG(data != NULL, "Failed to allocate evaluation thread data.");
+    FBK_ASSERT_MSG(0 == pthread_setspecific(eval_thread_data_key, data), "Failed to store evaluation thread data.");
+  }
+
+  return data;
+}
+
+/**
+ * @brief Scores pawn structure of incremental evaluation through the calling thread's pawn hash table
+ * 
+ * @param eval incremental evaluation
+ * @return fbk_score_t 
+ */
+static fbk_score_t score_pawn_structure_cached(const fbk_incremental_eval_s * eval)
+{
+  eval_thread_data_s * data  = get_eval_thread_data();
+  pawn_hash_entry_s  * entry = &data->pawn_hash[eval->pawn_key & (FBK_PAWN_HASH_TABLE_SIZE-1)];
+
+  if(entry->valid && (entry->key == eval->pawn_key))
+  {
+    data->counts.pawn_hash_hits++;
+  }
+  else
+  {
+    data->counts.pawn_hash_misses++;
+    entry->key   = eval->pawn_key;
+    entry->score = score_pawn_structure(eval->piece_mask[EVAL_WHITE][EVAL_PAWN], eval->piece_mask[EVAL_BLACK][EVAL_PAWN]);
+    entry->valid = true;
+  }
+
+  return entry->score;
+}
+
+void fbk_take_eval_counts(fbk_eval_counts_s * counts)
+{
+  FBK_ASSERT_MSG(counts != NULL, "NULL counts passed.");
+
+  eval_thread_data_s * data = pthread_getspecific(eval_thread_data_key);
+
+  if(data != NULL)
+  {
+    *counts = data->counts;
+    memset(&data->counts, 0, sizeof(fbk_eval_counts_s));
+  }
+  else
+  {
+    memset(counts, 0, sizeof(fbk_eval_counts_s));
+  }
+}
+
+/* Evaluation cache entries pack a score, game result and key check bits into one word so they are read and written 
+   atomically without locks.  Concurrent writers simply overwrite each other */
+#define EVAL_CACHE_SCORE_MASK   0x00000000ffffffffULL
+#define EVAL_CACHE_RESULT_SHIFT 32
+#define EVAL_CACHE_RESULT_MASK  0xffULL
+/* High key bits stored to verify entries, the low key bits select the entry */
+#define EVAL_CACHE_CHECK_MASK   0x7fffff0000000000ULL
+#define EVAL_CACHE_VALID        0x8000000000000000ULL
+/* Key salt for neural network evaluation scores */
+#define EVAL_CACHE_NNUE_SALT    0x9e3779b97f4a7c15ULL
+
+/* Shared evaluation cache, NULL if disabled */
+static atomic_uint_fast64_t * eval_cache      = NULL;
+/* Entry count - 1, entry count is a power of 2 */
+static uint_fast64_t          eval_cache_mask = 0;
+
+_Static_assert(sizeof(ftk_zobrist_hash_key_t) >= sizeof(uint64_t), "Evaluation cache assumes 64-bit hash keys.");
+
+void fbk_init_eval_cache(unsigned int size_mb)
+{
+  free(eval_cache);
+  eval_cache      = NULL;
+  eval_cache_mask = 0;
+
+  if(size_mb > 0)
+  {
+    /* Largest power of 2 entry count fitting the requested size */
+    const uint_fast64_t max_entries = (((uint_fast64_t) size_mb)<<20)/sizeof(atomic_uint_fast64_t);
+    uint_fast64_t entries = 1;
+    while((entries<<1) <= max_entries)
     {
-      score = FBK_SCORE_LOSS_ROOK;
-      break;
+      entries <<= 1;
     }
-    case FTK_TYPE_QUEEN:
+    FBK_ASSERT_MSG(entries <= (EVAL_CACHE_CHECK_MASK & -EVAL_CACHE_CHECK_MASK), "Evaluation cache too large for key check bits.");
+
+    eval_cache = calloc(entries, sizeof(atomic_uint_fast64_t));
+    FBK_ASSERT_MSG(eval_cache != NULL, "Failed to allocate %u MiB evaluation cache.", size_mb);
+    eval_cache_mask = entries-1;
+  }
+
+  FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Evaluation cache %s with %lu entries.", (eval_cache != NULL)?"enabled":"disabled", 
+                (eval_cache != NULL)?(unsigned long) (eval_cache_mask+1):0ul);
+}
+
+/* Entries sampled to estimate evaluation cache occupancy */
+#define EVAL_CACHE_OCCUPANCY_SAMPLES 1000
+
+unsigned int fbk_eval_cache_permille()
+{
+  unsigned int ret_val = 0;
+
+  if(eval_cache != NULL)
+  {
+    const uint_fast64_t samples = ((eval_cache_mask+1) < EVAL_CACHE_OCCUPANCY_SAMPLES)?(eval_cache_mask+1):EVAL_CACHE_OCCUPANCY_SAMPLES;
+    uint_fast64_t       used    = 0;
+
+    for(uint_fast64_t i = 0; i < samples; i++)
     {
-      score = FBK_SCORE_LOSS_QUEEN;
-      break;
+      if(atomic_load_explicit(&eval_cache[i], memory_order_relaxed) & EVAL_CACHE_VALID)
+      {
+        used++;
+      }
     }
-    case FTK_TYPE_KING:
+    ret_val = (unsigned int) ((used * 1000) / samples);
+  }
+
+  return ret_val;
+}
+
+/**
+ * @brief Returns a value mixed into evaluation cache keys so scores of the classical and neural network evaluations 
+ *        never match each other
+ */
+static inline ftk_zobrist_hash_key_t eval_cache_salt()
+{
+  return fbk_nnue_enabled()?EVAL_CACHE_NNUE_SALT:0;
+}
+
+/**
+ * @brief Looks up a position in the evaluation cache
+ * 
+ * @param key    position hash key
+ * @param score  output base score if found
+ * @param result output game result if found
+ * @return true if found
+ */
+static bool probe_eval_cache(ftk_zobrist_hash_key_t key, fbk_score_t * score, ftk_game_end_e * result)
+{
+  bool ret_val = false;
+
+  key ^= eval_cache_salt();
+
+  if(eval_cache != NULL)
+  {
+    eval_thread_data_s * data  = get_eval_thread_data();
+    const uint_fast64_t  entry = atomic_load_explicit(&eval_cache[key & eval_cache_mask], memory_order_relaxed);
+
+    if((entry & EVAL_CACHE_VALID) && ((entry & EVAL_CACHE_CHECK_MASK) == (key & EVAL_CACHE_CHECK_MASK)))
     {
-      score = FBK_SCORE_LOSS_KING;
-      break;
+      *score  = (int32_t) (entry & EVAL_CACHE_SCORE_MASK);
+      *result = (ftk_game_end_e) ((entry >> EVAL_CACHE_RESULT_SHIFT) & EVAL_CACHE_RESULT_MASK);
+      data->counts.eval_cache_hits++;
+      ret_val = true;
     }
-    default:
+    else
     {
-      break;
+      data->counts.eval_cache_misses++;
     }
   }
 
-  return score;
+  return ret_val;
+}
+
+/**
+ * @brief Stores a position's evaluation in the evaluation cache, replacing any entry at its index
+ * 
+ * @param key    position hash key
+ * @param score  base score
+ * @param result game result
+ */
+static void store_eval_cache(ftk_zobrist_hash_key_t key, fbk_score_t score, ftk_game_end_e result)
+{
+  key ^= eval_cache_salt();
+
+  /* Scores outside 32 bits are not cached */
+  if((eval_cache != NULL) && (score >= INT32_MIN) && (score <= INT32_MAX) && (((uint_fast64_t) result) <= EVAL_CACHE_RESULT_MASK))
+  {
+    const uint_fast64_t entry = EVAL_CACHE_VALID | (key & EVAL_CACHE_CHECK_MASK) | 
+                                (((uint_fast64_t) result) << EVAL_CACHE_RESULT_SHIFT) | (((uint_fast64_t) (uint32_t) score) & EVAL_CACHE_SCORE_MASK);
+    atomic_store_explicit(&eval_cache[key & eval_cache_mask], entry, memory_order_relaxed);
+  }
+}
+
+bool fbk_init_analysis_lut()
+{
+  /* Piece-square tables are constant data, only evaluation kernels need runtime selection */
+  fbk_init_analysis_simd();
+  pthread_once(&eval_thread_data_key_once, create_eval_thread_data_key);
+
+  return true;
+}
+
+fbk_score_t fbk_score_potential_capture_value(ftk_type_e piece_type)
+{
+  const int piece = eval_piece_index(piece_type);
+
+  return (piece >= 0)?EVAL_PARAMS.capture_value[piece]:0;
+}
+
+fbk_score_t fbk_score_potential_loss_value(ftk_type_e piece_type)
+{
+  const int piece = eval_piece_index(piece_type);
+
+  return (piece >= 0)?EVAL_PARAMS.loss_value[piece]:0;
 }
 
 fbk_score_t fbk_score_potential_capture(ftk_square_s square, ftk_color_e turn)
@@ -329,14 +471,28 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
   unsigned int black_king_not_moved  = 0;
   unsigned int black_rooks_not_moved = 0;
 
-  unsigned int white_pawns_on_file[8] = {0};
-  unsigned int black_pawns_on_file[8] = {0};
+  ftk_board_mask_t white_pawns = 0;
+  ftk_board_mask_t black_pawns = 0;
+
+  fbk_score_t  mg_position_score = 0;
+  fbk_score_t  eg_position_score = 0;
+  unsigned int phase             = 0;
 
   for(i = 0; i < FTK_STD_BOARD_SIZE; i++)
   {
     advantage = (FTK_COLOR_WHITE == game->board.square[i].color)?1:-1;
     legal_move_count = ftk_get_num_bits_set(game->board.move_mask[i]);
 
+    const int piece = eval_piece_index(game->board.square[i].type);
+    if(piece >= 0)
+    {
+      const int color = (FTK_COLOR_WHITE == game->board.square[i].color)?EVAL_WHITE:EVAL_BLACK;
+      mg_position_score += advantage*EVAL_PARAMS.pst_mg[piece][color][i];
+      eg_position_score += advantage*EVAL_PARAMS.pst_eg[piece][color][i];
+      phase             += eval_piece_phase[piece];
+      score             += advantage*(EVAL_PARAMS.piece_value[piece] + (legal_move_count*EVAL_PARAMS.move_value[piece]));
+    }
+
     capture_mask = game->board.move_mask[i] & game->board.board_mask;
     while(capture_mask)
     { 
@@ -349,45 +505,19 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
     {
       case FTK_TYPE_PAWN:
       {
-        score += advantage*(FBK_SCORE_PAWN + (legal_move_count*FBK_SCORE_PAWN_MOVE));
-
-        if(game->board.square[i].color == FTK_COLOR_WHITE)
-        {
-          white_pawns_on_file[i % 8]++;
-          score += lut->white_pawn_position_score[i];
-        }
-        else
-        {
-          black_pawns_on_file[i % 8]++;
-          score -= lut->black_pawn_position_score[i];
-        }
-
-        break;
-      }
-      case FTK_TYPE_KNIGHT:
-      {
-        score += advantage*(FBK_SCORE_KNIGHT + (legal_move_count*FBK_SCORE_KNIGHT_MOVE));
-
         if(game->board.square[i].color == FTK_COLOR_WHITE)
         {
-          score += lut->white_knight_position_score[i];
+          white_pawns |= ((ftk_board_mask_t) 1) << i;
         }
         else
         {
-          score -= lut->black_knight_position_score[i];
+          black_pawns |= ((ftk_board_mask_t) 1) << i;
         }
 
         break;
       }
-      case FTK_TYPE_BISHOP:
-      {
-        score += advantage*(FBK_SCORE_BISHOP + (legal_move_count*FBK_SCORE_BISHOP_MOVE));
-        break;
-      }
       case FTK_TYPE_ROOK:
       {
-        score += advantage*(FBK_SCORE_ROOK + (legal_move_count*FBK_SCORE_ROOK_MOVE));
-
         if(FTK_MOVED_NOT_MOVED == game->board.square[i].moved)
         {
           if(FTK_COLOR_WHITE == game->board.square[i].color)
@@ -402,15 +532,8 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
 
         break;
       }
-      case FTK_TYPE_QUEEN:
-      {
-        score += advantage*(FBK_SCORE_QUEEN + (legal_move_count*FBK_SCORE_QUEEN_MOVE));
-        break;
-      }
       case FTK_TYPE_KING:
       {
-        score += advantage*(FBK_SCORE_KING + (legal_move_count*FBK_SCORE_KING_MOVE));
-
         if(FTK_MOVED_NOT_MOVED == game->board.square[i].moved)
         {
           if(FTK_COLOR_WHITE == game->board.square[i].color)
@@ -428,7 +551,7 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
                   (game->board.square[FTK_F1].color == FTK_COLOR_WHITE))
         {
           /* White is castled kingside */
-          score += FBK_SCORE_CASTLED_KINGSIDE;
+          score += EVAL_PARAMS.castled_kingside;
         }
         else if ( (i == FTK_G8) && 
                   (game->board.square[FTK_G8].color == FTK_COLOR_BLACK) && 
@@ -436,7 +559,7 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
                   (game->board.square[FTK_F8].color == FTK_COLOR_BLACK))
         {
           /* Black is castled kingside */
-          score -= FBK_SCORE_CASTLED_KINGSIDE;
+          score -= EVAL_PARAMS.castled_kingside;
         }
         else if ( (i == FTK_C1) && 
                   (game->board.square[FTK_C1].color == FTK_COLOR_WHITE) && 
@@ -444,7 +567,7 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
                   (game->board.square[FTK_D1].color == FTK_COLOR_WHITE))
         {
           /* White is castled queenside */
-          score += FBK_SCORE_CASTLED_QUEENSIDE;
+          score += EVAL_PARAMS.castled_queenside;
         }
         else if ( (i == FTK_C8) && 
                   (game->board.square[FTK_C8].color == FTK_COLOR_BLACK) && 
@@ -452,7 +575,7 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
                   (game->board.square[FTK_D8].color == FTK_COLOR_BLACK))
         {
           /* Black is castled queenside */
-          score -= FBK_SCORE_CASTLED_QUEENSIDE;
+          score -= EVAL_PARAMS.castled_queenside;
         }
         break;
       }
@@ -463,39 +586,491 @@ fbk_score_t fbk_score_game(const ftk_game_s * game)
     }
   }
 
-  for(unsigned int i = 0; i < 8; i++)
-  {
-    if(white_pawns_on_file[i] > 1)
-    {
-      /* base*2^(doubled_pawn_count-2)) */
-      score -= FBK_SCORE_DOUBLE_PAWN_BASE_PENALTY * (1 << (white_pawns_on_file[i]-2));
-    }
-    if(black_pawns_on_file[i] > 1)
-    {
-      /* base*2^(doubled_pawn_count-2)) */
-      score += FBK_SCORE_DOUBLE_PAWN_BASE_PENALTY * (1 << (black_pawns_on_file[i]-2));
-    }
-  }
+  score += score_pawn_structure(white_pawns, black_pawns);
 
   /* Weight the ability to castle still */
   if(white_king_not_moved)
   {
-    score += FBK_SCORE_CAN_CASTLE * white_rooks_not_moved;
+    score += EVAL_PARAMS.can_castle * white_rooks_not_moved;
   }
   if(black_king_not_moved)
   {
-    score -= FBK_SCORE_CAN_CASTLE * black_rooks_not_moved;
+    score -= EVAL_PARAMS.can_castle * black_rooks_not_moved;
   }
+
+  score += taper_score(mg_position_score, eg_position_score, phase);
    
   return score;
 }
 
-unsigned int position_repetition_count(const fbk_move_tree_node_s *node)
+/**
+ * @brief Adds (sign 1) or removes (sign -1) the contribution of one square to the incremental evaluation
+ * 
+ * @param eval    incremental evaluation to update
+ * @param square  square contents
+ * @param i       square index
+ * @param sign    1 to add, -1 to remove
+ * @param kernels evaluation kernels
+ */
+static inline void incremental_eval_square(fbk_incremental_eval_s * eval, const ftk_square_s * square, unsigned int i, int sign, 
+                                           const fbk_simd_kernels_s * kernels)
 {
-  FBK_ASSERT_MSG(node != NULL, "NULL node passed");
-  FBK_ASSERT_MSG(node->hashed, "Node not hashed to check for threefold repetition");
-
-  unsigned int repetition_count = 1;
+  const int piece = eval_piece_index(square->type);
+
+  if(piece < 0)
+  {
+    return;
+  }
+
+  const int              color     = (FTK_COLOR_WHITE == square->color)?EVAL_WHITE:EVAL_BLACK;
+  const int              advantage = (EVAL_WHITE == color)?sign:-sign;
+  const ftk_board_mask_t bit       = ((ftk_board_mask_t) 1) << i;
+
+  if(sign > 0)
+  {
+    eval->piece_mask[color][piece] |= bit;
+  }
+  else
+  {
+    eval->piece_mask[color][piece] &= ~bit;
+  }
+
+  eval->material_score    += advantage*EVAL_PARAMS.piece_value[piece];
+  eval->mg_position_score += advantage*EVAL_PARAMS.pst_mg[piece][color][i];
+  eval->eg_position_score += advantage*EVAL_PARAMS.pst_eg[piece][color][i];
+  eval->phase             += sign*eval_piece_phase[piece];
+
+  if(eval->nnue.valid)
+  {
+    fbk_nnue_update(&eval->nnue, color, piece, i, sign, kernels);
+  }
+
+  if(EVAL_PAWN == piece)
+  {
+    eval->pawn_key ^= fbk_pawn_hash_square_key(square->color, i);
+  }
+  else if(((EVAL_ROOK == piece) || (EVAL_KING == piece)) && (FTK_MOVED_NOT_MOVED == square->moved))
+  {
+    if(EVAL_ROOK == piece)
+    {
+      if(EVAL_WHITE == color)
+      {
+        eval->white_rooks_not_moved += sign;
+      }
+      else
+      {
+        eval->black_rooks_not_moved += sign;
+      }
+    }
+    else
+    {
+      if(EVAL_WHITE == color)
+      {
+        eval->white_king_not_moved += sign;
+      }
+      else
+      {
+        eval->black_king_not_moved += sign;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Initializes incremental evaluation from piece bitboards using given kernels
+ * 
+ * @param eval    incremental evaluation to initialize
+ * @param game    game to scan
+ * @param kernels evaluation kernels
+ */
+static void init_incremental_eval(fbk_incremental_eval_s * eval, const ftk_game_s * game, const fbk_simd_kernels_s * kernels)
+{
+  ftk_board_mask_t not_moved_mask = 0;
+
+  memset(eval, 0, sizeof(fbk_incremental_eval_s));
+
+  /* Board masks may be stale after quick moves, build bitboards from the squares */
+  for(unsigned int i = 0; i < FTK_STD_BOARD_SIZE; i++)
+  {
+    const int piece = eval_piece_index(game->board.square[i].type);
+    if(piece >= 0)
+    {
+      const ftk_board_mask_t bit = ((ftk_board_mask_t) 1) << i;
+      eval->piece_mask[(FTK_COLOR_WHITE == game->board.square[i].color)?EVAL_WHITE:EVAL_BLACK][piece] |= bit;
+      if(FTK_MOVED_NOT_MOVED == game->board.square[i].moved)
+      {
+        not_moved_mask |= bit;
+      }
+    }
+  }
+
+  for(unsigned int piece = 0; piece < FBK_EVAL_PIECE_TYPE_COUNT; piece++)
+  {
+    const ftk_board_mask_t white_mask = eval->piece_mask[EVAL_WHITE][piece];
+    const ftk_board_mask_t black_mask = eval->piece_mask[EVAL_BLACK][piece];
+    const unsigned int     count      = ftk_get_num_bits_set(white_mask) + ftk_get_num_bits_set(black_mask);
+
+    eval->material_score    += EVAL_PARAMS.piece_value[piece] * 
+                               (((fbk_score_t) ftk_get_num_bits_set(white_mask)) - ((fbk_score_t) ftk_get_num_bits_set(black_mask)));
+    eval->mg_position_score += kernels->score_sum(EVAL_PARAMS.pst_mg[piece][EVAL_WHITE], white_mask) - kernels->score_sum(EVAL_PARAMS.pst_mg[piece][EVAL_BLACK], black_mask);
+    eval->eg_position_score += kernels->score_sum(EVAL_PARAMS.pst_eg[piece][EVAL_WHITE], white_mask) - kernels->score_sum(EVAL_PARAMS.pst_eg[piece][EVAL_BLACK], black_mask);
+    eval->phase             += count * eval_piece_phase[piece];
+  }
+
+  eval->pawn_key = fbk_pawn_hash_key(eval->piece_mask[EVAL_WHITE][EVAL_PAWN], eval->piece_mask[EVAL_BLACK][EVAL_PAWN]);
+
+  eval->white_rooks_not_moved = ftk_get_num_bits_set(eval->piece_mask[EVAL_WHITE][EVAL_ROOK] & not_moved_mask);
+  eval->black_rooks_not_moved = ftk_get_num_bits_set(eval->piece_mask[EVAL_BLACK][EVAL_ROOK] & not_moved_mask);
+  eval->white_king_not_moved  = ftk_get_num_bits_set(eval->piece_mask[EVAL_WHITE][EVAL_KING] & not_moved_mask);
+  eval->black_king_not_moved  = ftk_get_num_bits_set(eval->piece_mask[EVAL_BLACK][EVAL_KING] & not_moved_mask);
+
+  if(fbk_nnue_enabled())
+  {
+    fbk_nnue_refresh(&eval->nnue, (const ftk_board_mask_t (*)[FBK_EVAL_PIECE_TYPE_COUNT]) eval->piece_mask, kernels);
+  }
+}
+
+void fbk_init_incremental_eval(fbk_incremental_eval_s * eval, const ftk_game_s * game)
+{
+  FBK_ASSERT_MSG(eval != NULL, "NULL incremental evaluation passed.");
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+
+  init_incremental_eval(eval, game, fbk_get_simd_kernels());
+}
+
+unsigned int fbk_incremental_eval_move_squares(const ftk_board_s * board, const ftk_move_s * move, bool applied, 
+                                               ftk_square_e squares[FBK_INCREMENTAL_EVAL_MAX_MOVE_SQUARES])
+{
+  unsigned int count = 0;
+
+  FBK_ASSERT_MSG(board != NULL, "NULL board passed.");
+  FBK_ASSERT_MSG(move != NULL,  "NULL move passed.");
+
+  squares[count++] = move->source;
+  squares[count++] = move->target;
+
+  /* Moving piece is on the source square before the move and the target square after */
+  const ftk_type_e type      = board->square[applied?move->target:move->source].type;
+  const int        file_diff = ((int) (move->target % 8)) - ((int) (move->source % 8));
+  const unsigned int rank_base = move->source - (move->source % 8);
+
+  if((FTK_TYPE_KING == type) && ((2 == file_diff) || (-2 == file_diff)))
+  {
+    /* Castling, rook moves from the corner next to the king */
+    squares[count++] = rank_base + ((file_diff > 0)?7:0);
+    squares[count++] = rank_base + ((file_diff > 0)?5:3);
+  }
+  else if((FTK_TYPE_PAWN == type) && (file_diff != 0))
+  {
+    /* Possible en passant, captured pawn is beside the source square.  Unchanged squares add no difference */
+    squares[count++] = rank_base + (move->target % 8);
+  }
+
+  return count;
+}
+
+void fbk_update_incremental_eval(fbk_incremental_eval_s * eval, const ftk_board_s * board, const ftk_square_e squares[], unsigned int count, int sign)
+{
+  FBK_ASSERT_MSG(eval != NULL,  "NULL incremental evaluation passed.");
+  FBK_ASSERT_MSG(board != NULL, "NULL board passed.");
+
+  const fbk_simd_kernels_s * kernels = fbk_get_simd_kernels();
+
+  for(unsigned int i = 0; i < count; i++)
+  {
+    incremental_eval_square(eval, &board->square[squares[i]], squares[i], sign, kernels);
+  }
+}
+
+/**
+ * @brief Scores game with the classical evaluation from incremental evaluation and piece bitboards using given kernels
+ * 
+ * @param game    game to score, board masks must be updated
+ * @param eval    incremental evaluation matching game
+ * @param kernels evaluation kernels
+ * @return fbk_score_t 
+ */
+static fbk_score_t score_game_classic(const ftk_game_s * game, const fbk_incremental_eval_s * eval, const fbk_simd_kernels_s * kernels)
+{
+  const ftk_board_mask_t all_squares = ~((ftk_board_mask_t) 0);
+  fbk_score_t score = eval->material_score + taper_score(eval->mg_position_score, eval->eg_position_score, eval->phase);
+
+  for(unsigned int color = 0; color < FBK_EVAL_COLOR_COUNT; color++)
+  {
+    const int advantage = (EVAL_WHITE == color)?1:-1;
+    for(unsigned int piece = 0; piece < FBK_EVAL_PIECE_TYPE_COUNT; piece++)
+    {
+      const ftk_board_mask_t piece_mask = eval->piece_mask[color][piece];
+      if(0 == piece_mask)
+      {
+        continue;
+      }
+
+      /* Mobility, legal moves of all pieces of this type */
+      score += advantage * EVAL_PARAMS.move_value[piece] * 
+               (fbk_score_t) kernels->popcount_sum(game->board.move_mask, piece_mask, all_squares);
+
+      /* Potential captures, moves from any square onto pieces of this type */
+      ftk_square_s target = game->board.square[ftk_get_first_set_bit_idx(piece_mask)];
+      target.type = eval_piece_type[piece];
+      score += fbk_score_potential_capture(target, game->turn) * 
+               (fbk_score_t) kernels->popcount_sum(game->board.move_mask, all_squares, piece_mask);
+    }
+  }
+
+  /* Castled kings */
+  const ftk_square_s * square = game->board.square;
+  if((FTK_TYPE_KING == square[FTK_G1].type) && (FTK_MOVED_NOT_MOVED != square[FTK_G1].moved) && (FTK_COLOR_WHITE == square[FTK_G1].color) &&
+     (FTK_TYPE_ROOK == square[FTK_F1].type) && (FTK_COLOR_WHITE == square[FTK_F1].color))
+  {
+    score += EVAL_PARAMS.castled_kingside;
+  }
+  if((FTK_TYPE_KING == square[FTK_G8].type) && (FTK_MOVED_NOT_MOVED != square[FTK_G8].moved) && (FTK_COLOR_BLACK == square[FTK_G8].color) &&
+     (FTK_TYPE_ROOK == square[FTK_F8].type) && (FTK_COLOR_BLACK == square[FTK_F8].color))
+  {
+    score -= EVAL_PARAMS.castled_kingside;
+  }
+  if((FTK_TYPE_KING == square[FTK_C1].type) && (FTK_MOVED_NOT_MOVED != square[FTK_C1].moved) && (FTK_COLOR_WHITE == square[FTK_C1].color) &&
+     (FTK_TYPE_ROOK == square[FTK_D1].type) && (FTK_COLOR_WHITE == square[FTK_D1].color))
+  {
+    score += EVAL_PARAMS.castled_queenside;
+  }
+  if((FTK_TYPE_KING == square[FTK_C8].type) && (FTK_MOVED_NOT_MOVED != square[FTK_C8].moved) && (FTK_COLOR_BLACK == square[FTK_C8].color) &&
+     (FTK_TYPE_ROOK == square[FTK_D8].type) && (FTK_COLOR_BLACK == square[FTK_D8].color))
+  {
+    score -= EVAL_PARAMS.castled_queenside;
+  }
+
+  score += score_pawn_structure_cached(eval);
+
+  /* Weight the ability to castle still */
+  if(eval->white_king_not_moved)
+  {
+    score += EVAL_PARAMS.can_castle * eval->white_rooks_not_moved;
+  }
+  if(eval->black_king_not_moved)
+  {
+    score -= EVAL_PARAMS.can_castle * eval->black_rooks_not_moved;
+  }
+
+  return score;
+}
+
+/**
+ * @brief Scores game with the neural network evaluation, rescanning the position if its accumulators are not maintained
+ * 
+ * @param game    game to score
+ * @param eval    incremental evaluation matching game
+ * @param kernels evaluation kernels
+ * @return fbk_score_t 
+ */
+static fbk_score_t score_game_nnue(const ftk_game_s * game, const fbk_incremental_eval_s * eval, const fbk_simd_kernels_s * kernels)
+{
+  if(eval->nnue.valid)
+  {
+    return fbk_nnue_score(&eval->nnue, game->turn, kernels);
+  }
+
+  /* Initialized while the classical evaluation was selected */
+  fbk_nnue_accumulator_s accumulator;
+  fbk_nnue_refresh(&accumulator, (const ftk_board_mask_t (*)[FBK_EVAL_PIECE_TYPE_COUNT]) eval->piece_mask, kernels);
+  return fbk_nnue_score(&accumulator, game->turn, kernels);
+}
+
+/**
+ * @brief Scores game with the selected evaluation using given kernels
+ * 
+ * @param game    game to score, board masks must be updated
+ * @param eval    incremental evaluation matching game
+ * @param kernels evaluation kernels
+ * @return fbk_score_t 
+ */
+static fbk_score_t score_game_incremental(const ftk_game_s * game, const fbk_incremental_eval_s * eval, const fbk_simd_kernels_s * kernels)
+{
+  return fbk_nnue_enabled()?score_game_nnue(game, eval, kernels):score_game_classic(game, eval, kernels);
+}
+
+fbk_score_t fbk_score_game_incremental(const ftk_game_s * game, const fbk_incremental_eval_s * eval)
+{
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+  FBK_ASSERT_MSG(eval != NULL, "NULL incremental evaluation passed.");
+
+  return score_game_incremental(game, eval, fbk_get_simd_kernels());
+}
+
+bool fbk_verify_score_game(const ftk_game_s * game, const fbk_incremental_eval_s * eval, fbk_score_t score)
+{
+  bool ret_val = true;
+  fbk_incremental_eval_s rescan_eval;
+
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+  FBK_ASSERT_MSG(eval != NULL, "NULL incremental evaluation passed.");
+
+  /* Bitboards rebuilt with portable kernels */
+  init_incremental_eval(&rescan_eval, game, fbk_get_scalar_simd_kernels());
+  if((0 != memcmp(rescan_eval.piece_mask, eval->piece_mask, sizeof(eval->piece_mask))) ||
+     (rescan_eval.material_score != eval->material_score) || (rescan_eval.phase != eval->phase) ||
+     (rescan_eval.mg_position_score != eval->mg_position_score) || (rescan_eval.eg_position_score != eval->eg_position_score) ||
+     (rescan_eval.pawn_key != eval->pawn_key) ||
+     (rescan_eval.white_rooks_not_moved != eval->white_rooks_not_moved) || (rescan_eval.black_rooks_not_moved != eval->black_rooks_not_moved) ||
+     (rescan_eval.white_king_not_moved  != eval->white_king_not_moved)  || (rescan_eval.black_king_not_moved  != eval->black_king_not_moved))
+  {
+    FBK_ERROR_MSG("Incremental evaluation terms do not match rescan (material %ld vs %ld)", (long) eval->material_score, (long) rescan_eval.material_score);
+    ret_val = false;
+  }
+
+  if(eval->nnue.valid && rescan_eval.nnue.valid && (0 != memcmp(rescan_eval.nnue.value, eval->nnue.value, sizeof(eval->nnue.value))))
+  {
+    FBK_ERROR_MSG("Incremental neural network accumulators do not match rescan");
+    ret_val = false;
+  }
+
+  const fbk_score_t scalar_kernel_score = score_game_incremental(game, &rescan_eval, fbk_get_scalar_simd_kernels());
+  if(scalar_kernel_score != score)
+  {
+    FBK_ERROR_MSG("Score %ld does not match scalar kernel score %ld", (long) score, (long) scalar_kernel_score);
+    ret_val = false;
+  }
+
+  /* The reference evaluator is classical, neural network scores are only checked against the scalar kernels */
+  const fbk_score_t reference_score = fbk_score_game(game);
+  if(!fbk_nnue_enabled() && (reference_score != score))
+  {
+    FBK_ERROR_MSG("Score %ld does not match reference score %ld", (long) score, (long) reference_score);
+    ret_val = false;
+  }
+
+  return ret_val;
+}
+
+/**
+ * @brief Advances a random playout by one move, updating evaluation incrementally.  Restarts from the starting game when 
+ *        the playout ends or reaches FBK_VERIFY_EVALUATION_MAX_PLY
+ * 
+ * @param start    starting game of playout
+ * @param position current playout position
+ * @param eval     incremental evaluation matching position
+ * @param ply      number of moves played since start
+ */
+static void random_playout_step(const ftk_game_s * start, ftk_game_s * position, fbk_incremental_eval_s * eval, unsigned int * ply)
+{
+  ftk_move_list_s move_list = {0};
+  ftk_get_move_list(position, &move_list);
+  if((move_list.count > 0) && (*ply < FBK_VERIFY_EVALUATION_MAX_PLY))
+  {
+    /* Continue random playout, updating evaluation incrementally */
+    const ftk_move_s move = move_list.move[rand() % move_list.count];
+    ftk_square_e squares[FBK_INCREMENTAL_EVAL_MAX_MOVE_SQUARES];
+    const unsigned int square_count = fbk_incremental_eval_move_squares(&position->board, &move, false, squares);
+    fbk_update_incremental_eval(eval, &position->board, squares, square_count, -1);
+    FBK_ASSERT_MSG(FTK_SUCCESS == ftk_move_forward_quick(position, &move), "Failed to apply move.");
+    fbk_update_incremental_eval(eval, &position->board, squares, square_count, 1);
+    (*ply)++;
+  }
+  else
+  {
+    /* Restart playout from given game */
+    *position = *start;
+    fbk_init_incremental_eval(eval, position);
+    *ply = 0;
+  }
+  ftk_delete_move_list(&move_list);
+}
+
+unsigned int fbk_verify_evaluation(const ftk_game_s * game, unsigned int position_count)
+{
+  unsigned int mismatches = 0;
+  unsigned int ply        = 0;
+
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+
+  ftk_game_s             position = *game;
+  fbk_incremental_eval_s eval;
+  fbk_init_incremental_eval(&eval, &position);
+
+  for(unsigned int i = 0; i < position_count; i++)
+  {
+    ftk_update_board_masks(&position);
+    if(!fbk_verify_score_game(&position, &eval, fbk_score_game_incremental(&position, &eval)))
+    {
+      mismatches++;
+    }
+
+    random_playout_step(game, &position, &eval, &ply);
+  }
+
+  return mismatches;
+}
+
+/* Position scored by the evaluation benchmark */
+typedef struct
+{
+  ftk_game_s             game;
+  fbk_incremental_eval_s eval;
+} bench_position_s;
+
+double fbk_bench_evaluation(const ftk_game_s * game, unsigned int eval_count, bool nnue)
+{
+  double ret_val = 0.0;
+  unsigned int ply = 0;
+  struct timespec start_time, end_time;
+  /* Keeps scoring from being optimized out */
+  volatile fbk_score_t score_sink = 0;
+
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+
+  if(nnue && !fbk_nnue_network_loaded())
+  {
+    return ret_val;
+  }
+
+  const fbk_simd_kernels_s * kernels   = fbk_get_simd_kernels();
+  bench_position_s         * positions = malloc(FBK_BENCH_EVALUATION_POSITIONS*sizeof(bench_position_s));
+  FBK_ASSERT_MSG(positions != NULL, "Failed to allocate benchmark positions.");
+
+  /* Positions from random playouts, prepared before timing so only scoring is measured */
+  ftk_game_s             position = *game;
+  fbk_incremental_eval_s eval;
+  fbk_init_incremental_eval(&eval, &position);
+  for(unsigned int i = 0; i < FBK_BENCH_EVALUATION_POSITIONS; i++)
+  {
+    ftk_update_board_masks(&position);
+    positions[i].game = position;
+    positions[i].eval = eval;
+    if(nnue)
+    {
+      fbk_nnue_refresh(&positions[i].eval.nnue, (const ftk_board_mask_t (*)[FBK_EVAL_PIECE_TYPE_COUNT]) positions[i].eval.piece_mask, kernels);
+    }
+    random_playout_step(game, &position, &eval, &ply);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  for(unsigned int i = 0; i < eval_count; i++)
+  {
+    const bench_position_s * bench_position = &positions[i % FBK_BENCH_EVALUATION_POSITIONS];
+    score_sink = nnue?fbk_nnue_score(&bench_position->eval.nnue, bench_position->game.turn, kernels):
+                      score_game_classic(&bench_position->game, &bench_position->eval, kernels);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+  FBK_UNUSED(score_sink);
+
+  const double seconds = (end_time.tv_sec - start_time.tv_sec) + ((end_time.tv_nsec - start_time.tv_nsec) / 1e9);
+  if(seconds > 0.0)
+  {
+    ret_val = eval_count / seconds;
+  }
+
+  free(positions);
+
+  return ret_val;
+}
+
+unsigned int position_repetition_count(const fbk_move_tree_node_s *node)
+{
+  FBK_ASSERT_MSG(node != NULL, "NULL node passed");
+  FBK_ASSERT_MSG(node->hashed, "Node not hashed to check for threefold repetition");
+
+  unsigned int repetition_count = 1;
 
   const fbk_move_tree_node_s *parent_node = node->parent;
 
@@ -511,7 +1086,116 @@ unsigned int position_repetition_count(const fbk_move_tree_node_s *node)
   return repetition_count;
 }
 
-bool fbk_evaluate_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, bool locked)
+/**
+ * @brief Returns true if a game end result only depends on the position and not on the halfmove clock, so it can be 
+ *        served from the evaluation cache whose key does not include the clock
+ * 
+ * @param result game end result
+ */
+static inline bool position_only_result(ftk_game_end_e result)
+{
+  return FTK_END_DEFINITIVE(result) || (FTK_END_DRAW_STALEMATE == result);
+}
+
+/**
+ * @brief Checks position for game end and scores it, using the evaluation cache.  The cache only decides the result 
+ *        of checkmates and stalemates, any other cached position is checked for game end again as the same position 
+ *        may have reached a clock-based draw
+ * 
+ * @param game   position to evaluate, board masks are updated unless the position is a cached checkmate or stalemate
+ * @param eval   incremental evaluation matching game, NULL to score with a full board scan
+ * @param key    hash key of position
+ * @param score  output score, 0 if game is over
+ * @param result output game end result
+ */
+static void evaluate_position(ftk_game_s * game, const fbk_incremental_eval_s * eval, ftk_zobrist_hash_key_t key,
+                              fbk_score_t * score, ftk_game_end_e * result)
+{
+  if(probe_eval_cache(key, score, result))
+  {
+    if(!position_only_result(*result))
+    {
+      ftk_update_board_masks(game);
+      *result = ftk_check_for_game_end(game);
+      if(FTK_END_NOT_OVER != *result)
+      {
+        *score = 0;
+      }
+    }
+  }
+  else
+  {
+    ftk_update_board_masks(game);
+
+    *score  = 0;
+    *result = ftk_check_for_game_end(game);
+
+    if(FTK_END_NOT_OVER == *result)
+    {
+      fbk_incremental_eval_s full_eval;
+      if(NULL == eval)
+      {
+        fbk_init_incremental_eval(&full_eval, game);
+        eval = &full_eval;
+      }
+      *score = fbk_score_game_incremental(game, eval);
+      #ifdef FBK_DEBUG_BUILD
+      FBK_ASSERT_MSG(fbk_verify_score_game(game, eval, *score), "Evaluation does not match reference evaluation.");
+      #endif
+    }
+
+    /* Clock-based draws are not cached, the same position with a lower clock is still scored */
+    if((FTK_END_NOT_OVER == *result) || position_only_result(*result))
+    {
+      store_eval_cache(key, *score, *result);
+    }
+  }
+}
+
+/**
+ * @brief Records evaluation of a hashed node, adjusting for repetitions along its line.  Assumes caller holds the 
+ *        node's lock
+ * 
+ * @param node    node to update
+ * @param score   score of node's position
+ * @param result  game end result of node's position
+ * @param history positions before node, NULL to walk the node's ancestors
+ */
+static void record_node_evaluation(fbk_move_tree_node_s * node, fbk_score_t score, ftk_game_end_e result, const fbk_key_history_s * history)
+{
+  memset(&node->analysis_data, 0, sizeof(fbk_move_tree_node_analysis_data_s));
+
+  node->analysis_data.base_score        = score;
+  node->analysis_data.result            = result;
+  node->analysis_data.best_child_result = result;
+
+  if(FTK_END_NOT_OVER == node->analysis_data.result)
+  {
+    const unsigned int repetition_count = (history != NULL)?(1 + fbk_key_history_count(history, node->key)):position_repetition_count(node);
+    if(repetition_count == 2)
+    {
+      /* Approaching threefold repetition draw, divide score by 2 to approach 0 for a draw */
+      node->analysis_data.base_score = (FBK_TWOFOLD_REPETITION_NUM * node->analysis_data.base_score) / FBK_TWOFOLD_REPETITION_DEN;
+    }
+    else if(repetition_count > 4)
+    {
+      /* Threefold repetition draw */
+      node->analysis_data.base_score = 0;
+      node->analysis_data.result = FTK_END_DRAW_FIVEFOLD_REPETITION;
+    }
+    else if(repetition_count > 2)
+    {
+      /* Threefold repetition draw */
+      node->analysis_data.base_score = 0;
+      node->analysis_data.result = FTK_END_DRAW_THREEFOLD_REPETITION;
+    }
+  }
+
+  node->analysis_data.evaluated = true;
+}
+
+bool fbk_evaluate_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, const fbk_incremental_eval_s * eval, 
+                                 const fbk_key_history_s * history, bool locked)
 {
   bool ret_val = false;
 
@@ -522,62 +1206,185 @@ bool fbk_evaluate_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game,
 
   if(false == node->analysis_data.evaluated)
   {
+    fbk_score_t    score;
+    ftk_game_end_e result;
+
     fbk_hash_move_tree_node(node, game, true);
+    evaluate_position(game, eval, node->key, &score, &result);
+    record_node_evaluation(node, score, result, history);
+    ret_val = true;
+  }
 
-    ftk_update_board_masks(game);
+  if(!locked)
+  {
+    FBK_ASSERT_MSG(true == fbk_mutex_unlock(&node->lock), "Failed to unlock node mutex");
+  }
 
-    memset(&node->analysis_data, 0, sizeof(fbk_move_tree_node_analysis_data_s));
+  return ret_val;
+}
 
-    /* Check for game end */
-    node->analysis_data.result = ftk_check_for_game_end(game);
-    node->analysis_data.best_child_result = node->analysis_data.result;
+/* Child position evaluated in a batch of siblings */
+typedef struct
+{
+  /* Index of child in parent's child array */
+  fbk_move_tree_node_count_t child_index;
+  /* Move from parent position */
+  ftk_move_s                 move;
+  /* True if key was already computed for the child */
+  bool                       hashed;
+  ftk_zobrist_hash_key_t     key;
+  fbk_score_t                score;
+  ftk_game_end_e             result;
+
+} sibling_evaluation_s;
 
-    if(FTK_END_NOT_OVER == node->analysis_data.result)
+/**
+ * @brief Evaluates a batch of sibling positions given as moves from their parent position.  Evaluators able to score 
+ *        several positions at once (e.g. vectorized or neural network evaluation from the parent's accumulators) 
+ *        should replace this loop, the batch is contiguous and touches no tree nodes
+ * 
+ * @param game        parent position, restored on return
+ * @param eval        incremental evaluation matching game, restored on return
+ * @param parent_key  hash key of parent position
+ * @param parent_move move which led to parent position, NULL if unknown
+ * @param batch       siblings to evaluate, keys, scores and results are filled in
+ * @param count       number of siblings in batch
+ */
+static void evaluate_sibling_batch(ftk_game_s * game, fbk_incremental_eval_s * eval, ftk_zobrist_hash_key_t parent_key, 
+                                   const ftk_move_s * parent_move, sibling_evaluation_s batch[], unsigned int count)
+{
+  for(unsigned int i = 0; i < count; i++)
+  {
+    ftk_square_e squares[FBK_INCREMENTAL_EVAL_MAX_MOVE_SQUARES];
+    unsigned int square_count = 0;
+
+    if(!batch[i].hashed)
     {
-      node->analysis_data.base_score = fbk_score_game(game);
+      /* Derive child key from parent key, removing terms the move changes */
+      square_count = fbk_incremental_eval_move_squares(&game->board, &batch[i].move, false, squares);
+      batch[i].key = parent_key ^ fbk_hash_move_terms(game, squares, square_count, parent_move);
+    }
+    FBK_ASSERT_MSG(fbk_apply_game_move(&batch[i].move, game, eval), "Failed to apply move of child %u", batch[i].child_index);
+    if(!batch[i].hashed)
+    {
+      batch[i].key ^= fbk_hash_move_terms(game, squares, square_count, &batch[i].move);
+      #ifdef FBK_DEBUG_BUILD
+      FBK_ASSERT_MSG(fbk_hash_game(game, &batch[i].move) == batch[i].key, "Incremental hash key does not match full hash of child %u", batch[i].child_index);
+      #endif
+    }
+    evaluate_position(game, eval, batch[i].key, &batch[i].score, &batch[i].result);
+    FBK_ASSERT_MSG(fbk_undo_game_move(&batch[i].move, game, eval), "Failed to undo move of child %u", batch[i].child_index);
+  }
+}
 
-      const unsigned int repetition_count = position_repetition_count(node);
-      if(repetition_count == 2)
-      {
-        /* Approaching threefold repetition draw, divide score by 2 to approach 0 for a draw */
-        node->analysis_data.base_score = (FBK_TWOFOLD_REPETITION_NUM * node->analysis_data.base_score) / FBK_TWOFOLD_REPETITION_DEN;
-      }
-      else if(repetition_count > 4)
-      {
-        /* Threefold repetition draw */
-        node->analysis_data.base_score = 0;
-        node->analysis_data.result = FTK_END_DRAW_FIVEFOLD_REPETITION;
-      }
-      else if(repetition_count > 2)
-      {
-        /* Threefold repetition draw */
-        node->analysis_data.base_score = 0;
-        node->analysis_data.result = FTK_END_DRAW_THREEFOLD_REPETITION;
-      }
+unsigned int fbk_evaluate_child_nodes(fbk_move_tree_node_s * node, ftk_game_s * game, fbk_incremental_eval_s * eval, 
+                                      const fbk_key_history_s * history)
+{
+  sibling_evaluation_s batch[FBK_MOVE_TREE_MAX_NODE_COUNT];
+  unsigned int         batch_count = 0;
 
-      /* Init child nodes */
-      ftk_move_list_s move_list = {0};
-      ftk_get_move_list(game, &move_list);
-      node->child_count = move_list.count;
+  FBK_ASSERT_MSG(node != NULL, "NULL node passed");
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed");
+  FBK_ASSERT_MSG(eval != NULL, "NULL incremental evaluation passed");
+  FBK_ASSERT_MSG(node->expanded, "Evaluating children of unexpanded node");
+  FBK_ASSERT_MSG(node->hashed, "Evaluating children of unhashed node");
 
-      if(node->child_count > 0)
-      {
-        node->child = malloc(node->child_count*sizeof(fbk_move_tree_node_s));
+  /* Children are only evaluated while holding their parent's lock and a child's move and key never change once set, 
+     so the batch is gathered without child locks */
+  for(fbk_move_tree_node_count_t i = 0; i < node->child_count; i++)
+  {
+    const fbk_move_tree_node_s * child = &node->child[i];
+    if(!child->analysis_data.evaluated)
+    {
+      batch[batch_count].child_index = i;
+      batch[batch_count].move        = child->move;
+      batch[batch_count].hashed      = child->hashed;
+      batch[batch_count].key         = child->key;
+      batch_count++;
+    }
+  }
+
+  evaluate_sibling_batch(game, eval, node->key, FTK_MOVE_VALID(node->move)?&node->move:NULL, batch, batch_count);
+
+  /* Publish results, locking each child once */
+  for(unsigned int i = 0; i < batch_count; i++)
+  {
+    fbk_move_tree_node_s * child = &node->child[batch[i].child_index];
+    FBK_ASSERT_MSG(true == fbk_mutex_lock(&child->lock), "Failed to lock node mutex");
+    child->key    = batch[i].key;
+    child->hashed = true;
+    record_node_evaluation(child, batch[i].score, batch[i].result, history);
+    FBK_ASSERT_MSG(true == fbk_mutex_unlock(&child->lock), "Failed to unlock node mutex");
+  }
 
-        for(unsigned int i = 0; i < node->child_count; i++)
+  return batch_count;
+}
+
+/**
+ * @brief Returns true if move captures a piece (including en passant) or promotes a pawn
+ * 
+ * @param board board before move
+ * @param move  move to check
+ */
+static inline bool tactical_move(const ftk_board_s * board, const ftk_move_s * move)
+{
+  const unsigned int target_rank = move->target / 8;
+
+  return (FTK_TYPE_EMPTY != board->square[move->target].type) ||
+         ((FTK_TYPE_PAWN == board->square[move->source].type) && 
+          (((move->source % 8) != (move->target % 8)) || (0 == target_rank) || (7 == target_rank)));
+}
+
+bool fbk_expand_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, const fbk_incremental_eval_s * eval, bool locked)
+{
+  bool ret_val = false;
+
+  if(!locked)
+  {
+    FBK_ASSERT_MSG(true == fbk_mutex_lock(&node->lock), "Failed to lock node mutex");
+  }
+
+  fbk_evaluate_move_tree_node(node, game, eval, NULL, true);
+
+  /* Positions drawn by repetition keep their children as the draw must be claimed */
+  if(!node->expanded && ((FTK_END_NOT_OVER                  == node->analysis_data.result) || 
+                         (FTK_END_DRAW_THREEFOLD_REPETITION == node->analysis_data.result) ||
+                         (FTK_END_DRAW_FIVEFOLD_REPETITION  == node->analysis_data.result)))
+  {
+    ftk_move_list_s move_list = {0};
+    ftk_update_board_masks(game);
+    ftk_get_move_list(game, &move_list);
+    node->child_count = move_list.count;
+
+    if(node->child_count > 0)
+    {
+      node->child = malloc(node->child_count*sizeof(fbk_move_tree_node_s));
+      FBK_ASSERT_MSG(node->child != NULL, "Failed to allocate child nodes.");
+
+      /* Captures and promotions first, then quiet moves */
+      fbk_move_tree_node_count_t child_index = 0;
+      for(unsigned int stage = 0; stage < 2; stage++)
+      {
+        for(unsigned int i = 0; i < move_list.count; i++)
         {
-          fbk_init_move_tree_node(&node->child[i], node, &move_list.move[i]);
+          if(tactical_move(&game->board, &move_list.move[i]) == (0 == stage))
+          {
+            fbk_init_move_tree_node(&node->child[child_index++], node, &move_list.move[i]);
+          }
         }
       }
+    }
 
-      node->analysis_data.best_child_index = node->child_count;
-      node->analysis_data.best_child_score = (FTK_COLOR_WHITE == game->turn)?FBK_SCORE_BLACK_MAX:FBK_SCORE_WHITE_MAX;
+    node->analysis_data.best_child_index = node->child_count;
+    node->analysis_data.best_child_score = (FTK_COLOR_WHITE == game->turn)?FBK_SCORE_BLACK_MAX:FBK_SCORE_WHITE_MAX;
 
-      ftk_delete_move_list(&move_list);
-    }
+    ftk_delete_move_list(&move_list);
+  }
 
-    node->analysis_data.evaluated = true;
-    ret_val = true;
+  if(!node->expanded)
+  {
+    node->expanded = true;
+    ret_val        = true;
   }
 
   if(!locked)
@@ -587,6 +1394,7 @@ bool fbk_evaluate_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game,
 
   return ret_val;
 }
+
 /**
  * @brief Clears evaluation and deletes all child nodes
  * 
@@ -611,7 +1419,8 @@ void fbk_unevaluate_move_tree_node(fbk_move_tree_node_s * node)
 
   node->child_count = 0;
   free(node->child);
-  node->child = NULL;
+  node->child    = NULL;
+  node->expanded = false;
 
   memset(&node->analysis_data, 0, sizeof(fbk_move_tree_node_analysis_data_s));
 
@@ -625,19 +1434,15 @@ void fbk_unevaluate_move_tree_node(fbk_move_tree_node_s * node)
  */
 void fbk_evaluate_move_tree_node_children(fbk_move_tree_node_s * node, ftk_game_s game)
 {
-  unsigned int i;
   FBK_ASSERT_MSG(node != NULL, "NULL node passed");
 
   FBK_ASSERT_MSG(true == fbk_mutex_lock(&node->lock), "Failed to lock node mutex");
   bool decompressed = fbk_decompress_move_tree_node(node, true);
-  fbk_evaluate_move_tree_node(node, &game, true);
-  FBK_ASSERT_MSG(true == node->analysis_data.evaluated, "Failed to evaluate node");
-  for(i = 0; i < node->child_count; i++)
-  {
-    FBK_ASSERT_MSG(fbk_apply_move_tree_node(&node->child[i], &game), "Failed to apply node %u", i);
-    fbk_evaluate_move_tree_node(&node->child[i], &game, false);
-    FBK_ASSERT_MSG(fbk_undo_move_tree_node(&node->child[i], &game),  "Failed to undo node %u", i);
-  }
+  fbk_incremental_eval_s eval;
+  fbk_init_incremental_eval(&eval, &game);
+  fbk_expand_move_tree_node(node, &game, &eval, true);
+  FBK_ASSERT_MSG(true == node->expanded, "Failed to expand node");
+  fbk_evaluate_child_nodes(node, &game, &eval, NULL);
   if(decompressed)
   {
     fbk_compress_move_tree_node(node, true);
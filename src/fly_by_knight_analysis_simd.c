@@ -0,0 +1,356 @@
+/*
+ fly_by_knight_analysis_simd.c
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Vectorized bitboard kernels for Fly by Knight evaluation
+*/
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include <farewell_to_king.h>
+
+#include "fly_by_knight_analysis_simd.h"
+#include "fly_by_knight_debug.h"
+#include "fly_by_knight_error.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+/* x86 kernels are compiled for their instruction set with function attributes and selected at runtime */
+#define FBK_SIMD_X86_SUPPORT
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+/* NEON is part of the 64-bit ARM base instruction set, no runtime detection needed */
+#define FBK_SIMD_NEON_SUPPORT
+#include <arm_neon.h>
+#endif
+
+_Static_assert(sizeof(ftk_board_mask_t) == sizeof(uint64_t), "Kernels assume 64-bit board masks.");
+
+static pthread_once_t analysis_simd_once = PTHREAD_ONCE_INIT;
+
+/* Highest instruction set supported by this CPU */
+static fbk_simd_level_e supported_simd_level = FBK_SIMD_LEVEL_SCALAR;
+
+static unsigned int popcount_sum_scalar(const ftk_board_mask_t masks[FTK_STD_BOARD_SIZE], ftk_board_mask_t sources, ftk_board_mask_t targets)
+{
+  unsigned int sum = 0;
+
+  while(sources)
+  {
+    const ftk_square_e i = ftk_get_first_set_bit_idx(sources);
+    FTK_CLEAR_BIT(sources, i);
+    sum += ftk_get_num_bits_set(masks[i] & targets);
+  }
+
+  return sum;
+}
+
+static fbk_score_t score_sum_scalar(const fbk_score_t values[FTK_STD_BOARD_SIZE], ftk_board_mask_t squares)
+{
+  fbk_score_t sum = 0;
+
+  while(squares)
+  {
+    const ftk_square_e i = ftk_get_first_set_bit_idx(squares);
+    FTK_CLEAR_BIT(squares, i);
+    sum += values[i];
+  }
+
+  return sum;
+}
+
+static void nnue_accumulate_scalar(int16_t accumulator[FBK_NNUE_HIDDEN_SIZE], const int16_t weights[FBK_NNUE_HIDDEN_SIZE], int sign)
+{
+  for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i++)
+  {
+    /* Wraps like the vector kernels */
+    accumulator[i] = (int16_t) (accumulator[i] + (sign*weights[i]));
+  }
+}
+
+static inline int32_t nnue_clipped_activation(int16_t value)
+{
+  return (value < 0)?0:((value > FBK_NNUE_QA)?FBK_NNUE_QA:value);
+}
+
+static int32_t nnue_output_scalar(const int16_t us[FBK_NNUE_HIDDEN_SIZE], const int16_t them[FBK_NNUE_HIDDEN_SIZE], 
+                                  const int8_t weights[FBK_EVAL_COLOR_COUNT*FBK_NNUE_HIDDEN_SIZE])
+{
+  int32_t sum = 0;
+
+  for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i++)
+  {
+    sum += nnue_clipped_activation(us[i])   * weights[i];
+    sum += nnue_clipped_activation(them[i]) * weights[FBK_NNUE_HIDDEN_SIZE + i];
+  }
+
+  return sum;
+}
+
+_Static_assert((FBK_NNUE_HIDDEN_SIZE % 16) == 0, "Vector kernels assume a multiple of 16 hidden values.");
+
+#ifdef FBK_SIMD_X86_SUPPORT
+__attribute__((target("popcnt")))
+static unsigned int popcount_sum_popcnt(const ftk_board_mask_t masks[FTK_STD_BOARD_SIZE], ftk_board_mask_t sources, ftk_board_mask_t targets)
+{
+  unsigned int sum = 0;
+
+  for(unsigned int i = 0; i < FTK_STD_BOARD_SIZE; i++)
+  {
+    /* All ones if square is a source, branch free so the loop unrolls */
+    const uint64_t selected = 0 - ((sources >> i) & 1);
+    sum += __builtin_popcountll(masks[i] & targets & selected);
+  }
+
+  return sum;
+}
+
+/**
+ * @brief Expands bits [first, first+3] of mask into all-ones or all-zeros 64-bit lanes
+ */
+__attribute__((target("avx2")))
+static inline __m256i avx2_select_lanes(__m256i mask, __m256i shift)
+{
+  return _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_and_si256(_mm256_srlv_epi64(mask, shift), _mm256_set1_epi64x(1)));
+}
+
+__attribute__((target("avx2")))
+static unsigned int popcount_sum_avx2(const ftk_board_mask_t masks[FTK_STD_BOARD_SIZE], ftk_board_mask_t sources, ftk_board_mask_t targets)
+{
+  /* Bits set per nibble value, looked up with byte shuffles */
+  const __m256i nibble_count = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_nibble   = _mm256_set1_epi8(0x0f);
+  const __m256i source_vec   = _mm256_set1_epi64x((long long) sources);
+  const __m256i target_vec   = _mm256_set1_epi64x((long long) targets);
+  __m256i       shift        = _mm256_setr_epi64x(0, 1, 2, 3);
+  __m256i       total        = _mm256_setzero_si256();
+
+  for(unsigned int i = 0; i < FTK_STD_BOARD_SIZE; i += 4)
+  {
+    const __m256i selected = _mm256_and_si256(target_vec, avx2_select_lanes(source_vec, shift));
+    const __m256i bits     = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) &masks[i]), selected);
+    const __m256i low      = _mm256_shuffle_epi8(nibble_count, _mm256_and_si256(bits, low_nibble));
+    const __m256i high     = _mm256_shuffle_epi8(nibble_count, _mm256_and_si256(_mm256_srli_epi16(bits, 4), low_nibble));
+    /* Horizontal byte sums into each 64-bit lane */
+    total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    shift = _mm256_add_epi64(shift, _mm256_set1_epi64x(4));
+  }
+
+  const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+  return (unsigned int) (_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+
+#if (INT_FAST32_MAX == INT64_MAX)
+/* Scores are summed in 64-bit lanes */
+#define FBK_SIMD_AVX2_SCORE_SUM
+__attribute__((target("avx2")))
+static fbk_score_t score_sum_avx2(const fbk_score_t values[FTK_STD_BOARD_SIZE], ftk_board_mask_t squares)
+{
+  const __m256i square_vec = _mm256_set1_epi64x((long long) squares);
+  __m256i       shift      = _mm256_setr_epi64x(0, 1, 2, 3);
+  __m256i       total      = _mm256_setzero_si256();
+
+  for(unsigned int i = 0; i < FTK_STD_BOARD_SIZE; i += 4)
+  {
+    const __m256i value = _mm256_loadu_si256((const __m256i *) &values[i]);
+    total = _mm256_add_epi64(total, _mm256_and_si256(value, avx2_select_lanes(square_vec, shift)));
+    shift = _mm256_add_epi64(shift, _mm256_set1_epi64x(4));
+  }
+
+  const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+  return (fbk_score_t) (_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+#endif
+
+__attribute__((target("avx2")))
+static void nnue_accumulate_avx2(int16_t accumulator[FBK_NNUE_HIDDEN_SIZE], const int16_t weights[FBK_NNUE_HIDDEN_SIZE], int sign)
+{
+  for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i += 16)
+  {
+    const __m256i value  = _mm256_loadu_si256((const __m256i *) &accumulator[i]);
+    const __m256i weight = _mm256_loadu_si256((const __m256i *) &weights[i]);
+    _mm256_storeu_si256((__m256i *) &accumulator[i], (sign > 0)?_mm256_add_epi16(value, weight):_mm256_sub_epi16(value, weight));
+  }
+}
+
+/**
+ * @brief Sums 16 clipped activations times sign extended output weights into 32-bit lanes
+ */
+__attribute__((target("avx2")))
+static inline __m256i avx2_nnue_dot(__m256i sum, const int16_t activations[16], const int8_t weights[16])
+{
+  const __m256i activation = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i *) activations), _mm256_setzero_si256()), 
+                                              _mm256_set1_epi16(FBK_NNUE_QA));
+  const __m256i weight     = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *) weights));
+  return _mm256_add_epi32(sum, _mm256_madd_epi16(activation, weight));
+}
+
+__attribute__((target("avx2")))
+static int32_t nnue_output_avx2(const int16_t us[FBK_NNUE_HIDDEN_SIZE], const int16_t them[FBK_NNUE_HIDDEN_SIZE], 
+                                const int8_t weights[FBK_EVAL_COLOR_COUNT*FBK_NNUE_HIDDEN_SIZE])
+{
+  __m256i sum = _mm256_setzero_si256();
+
+  for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i += 16)
+  {
+    sum = avx2_nnue_dot(sum, &us[i],   &weights[i]);
+    sum = avx2_nnue_dot(sum, &them[i], &weights[FBK_NNUE_HIDDEN_SIZE + i]);
+  }
+
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(half);
+}
+#endif /* FBK_SIMD_X86_SUPPORT */
+
+#ifdef FBK_SIMD_NEON_SUPPORT
+static void nnue_accumulate_neon(int16_t accumulator[FBK_NNUE_HIDDEN_SIZE], const int16_t weights[FBK_NNUE_HIDDEN_SIZE], int sign)
+{
+  for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i += 8)
+  {
+    const int16x8_t value  = vld1q_s16(&accumulator[i]);
+    const int16x8_t weight = vld1q_s16(&weights[i]);
+    vst1q_s16(&accumulator[i], (sign > 0)?vaddq_s16(value, weight):vsubq_s16(value, weight));
+  }
+}
+
+/**
+ * @brief Sums 8 clipped activations times sign extended output weights into 32-bit lanes
+ */
+static inline int32x4_t neon_nnue_dot(int32x4_t sum, const int16_t activations[8], const int8_t weights[8])
+{
+  const int16x8_t activation = vminq_s16(vmaxq_s16(vld1q_s16(activations), vdupq_n_s16(0)), vdupq_n_s16(FBK_NNUE_QA));
+  const int16x8_t weight     = vmovl_s8(vld1_s8(weights));
+  sum = vmlal_s16(sum, vget_low_s16(activation),  vget_low_s16(weight));
+  return vmlal_s16(sum, vget_high_s16(activation), vget_high_s16(weight));
+}
+
+static int32_t nnue_output_neon(const int16_t us[FBK_NNUE_HIDDEN_SIZE], const int16_t them[FBK_NNUE_HIDDEN_SIZE], 
+                                const int8_t weights[FBK_EVAL_COLOR_COUNT*FBK_NNUE_HIDDEN_SIZE])
+{
+  int32x4_t sum = vdupq_n_s32(0);
+
+  for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i += 8)
+  {
+    sum = neon_nnue_dot(sum, &us[i],   &weights[i]);
+    sum = neon_nnue_dot(sum, &them[i], &weights[FBK_NNUE_HIDDEN_SIZE + i]);
+  }
+
+  return vaddvq_s32(sum);
+}
+#endif /* FBK_SIMD_NEON_SUPPORT */
+
+static const fbk_simd_kernels_s simd_kernels[FBK_SIMD_LEVEL_COUNT] =
+{
+  [FBK_SIMD_LEVEL_SCALAR] = { .level = FBK_SIMD_LEVEL_SCALAR, .popcount_sum = popcount_sum_scalar, .score_sum = score_sum_scalar, 
+                              .nnue_accumulate = nnue_accumulate_scalar, .nnue_output = nnue_output_scalar },
+#ifdef FBK_SIMD_X86_SUPPORT
+  [FBK_SIMD_LEVEL_POPCNT] = { .level = FBK_SIMD_LEVEL_POPCNT, .popcount_sum = popcount_sum_popcnt, .score_sum = score_sum_scalar, 
+                              .nnue_accumulate = nnue_accumulate_scalar, .nnue_output = nnue_output_scalar },
+#ifdef FBK_SIMD_AVX2_SCORE_SUM
+  [FBK_SIMD_LEVEL_AVX2]   = { .level = FBK_SIMD_LEVEL_AVX2,   .popcount_sum = popcount_sum_avx2,   .score_sum = score_sum_avx2, 
+                              .nnue_accumulate = nnue_accumulate_avx2,   .nnue_output = nnue_output_avx2 },
+#else
+  [FBK_SIMD_LEVEL_AVX2]   = { .level = FBK_SIMD_LEVEL_AVX2,   .popcount_sum = popcount_sum_avx2,   .score_sum = score_sum_scalar, 
+                              .nnue_accumulate = nnue_accumulate_avx2,   .nnue_output = nnue_output_avx2 },
+#endif
+#endif
+#ifdef FBK_SIMD_NEON_SUPPORT
+  [FBK_SIMD_LEVEL_NEON]   = { .level = FBK_SIMD_LEVEL_NEON,   .popcount_sum = popcount_sum_scalar, .score_sum = score_sum_scalar, 
+                              .nnue_accumulate = nnue_accumulate_neon,   .nnue_output = nnue_output_neon },
+#endif
+};
+
+/* Kernels used by evaluation */
+static _Atomic(const fbk_simd_kernels_s *) active_kernels = &simd_kernels[FBK_SIMD_LEVEL_SCALAR];
+
+/**
+ * @brief One-time detection of CPU instruction sets
+ */
+static void init_analysis_simd_once()
+{
+#ifdef FBK_SIMD_X86_SUPPORT
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+  {
+    supported_simd_level = FBK_SIMD_LEVEL_AVX2;
+  }
+  else if(__builtin_cpu_supports("popcnt"))
+  {
+    supported_simd_level = FBK_SIMD_LEVEL_POPCNT;
+  }
+#endif
+
+#ifdef FBK_SIMD_NEON_SUPPORT
+  supported_simd_level = FBK_SIMD_LEVEL_NEON;
+#endif
+
+  atomic_store(&active_kernels, &simd_kernels[supported_simd_level]);
+
+  FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Using %s evaluation kernels.", fbk_simd_level_string(supported_simd_level));
+}
+
+void fbk_init_analysis_simd()
+{
+  pthread_once(&analysis_simd_once, init_analysis_simd_once);
+}
+
+const fbk_simd_kernels_s * fbk_get_simd_kernels()
+{
+  return atomic_load_explicit(&active_kernels, memory_order_relaxed);
+}
+
+const fbk_simd_kernels_s * fbk_get_scalar_simd_kernels()
+{
+  return &simd_kernels[FBK_SIMD_LEVEL_SCALAR];
+}
+
+void fbk_limit_simd_level(fbk_simd_level_e level)
+{
+  fbk_init_analysis_simd();
+
+  if(level > supported_simd_level)
+  {
+    level = supported_simd_level;
+  }
+  while((level > FBK_SIMD_LEVEL_SCALAR) && (NULL == simd_kernels[level].popcount_sum))
+  {
+    /* Instruction set of another architecture */
+    level--;
+  }
+
+  FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Limiting evaluation kernels to %s.", fbk_simd_level_string(level));
+  atomic_store(&active_kernels, &simd_kernels[level]);
+}
+
+const char * fbk_simd_level_string(fbk_simd_level_e level)
+{
+  switch(level)
+  {
+    case FBK_SIMD_LEVEL_SCALAR:
+    {
+      return "scalar";
+    }
+    case FBK_SIMD_LEVEL_POPCNT:
+    {
+      return "popcnt";
+    }
+    case FBK_SIMD_LEVEL_AVX2:
+    {
+      return "avx2";
+    }
+    case FBK_SIMD_LEVEL_NEON:
+    {
+      return "neon";
+    }
+    default:
+    {
+      return "unknown";
+    }
+  }
+}
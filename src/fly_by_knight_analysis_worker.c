@@ -7,47 +7,42 @@
  Gama analysis worker logic for Fly by Knight
 */
 
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include "fly_by_knight_affinity.h"
 #include "fly_by_knight_analysis.h"
 #include "fly_by_knight_analysis_worker.h"
 #include "fly_by_knight_debug.h"
 #include "fly_by_knight_error.h"
+#include "fly_by_knight_hash.h"
 #include "fly_by_knight_move_tree.h"
 #include "fly_by_knight_pick.h"
 
 fbk_analysis_data_s fbk_analysis_data = {0};
 
-static void worker_thread_analysis_state_cleanup(void *arg)
-{
-  FBK_ASSERT_MSG(arg != NULL, "NULL worker thread data passed.");
-  fbk_analysis_state_s *analysis_state = (fbk_analysis_state_s *) arg;
-  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Worker thread 0x%lx releasing analysis state mutex for thread cancellation.", pthread_self());
-  fbk_mutex_unlock(&analysis_state->lock);
-}
-
 /**
  * @brief Wait for analysis to start.
  * 
  * @param analysis_state analysis context to check
+ * @param retiring       optional flag to stop waiting when set, NULL to wait for analysis only
  * 
  * @return true if waiting was required, false if analysis is already active
 */
-static bool wait_for_analysis_start(fbk_analysis_state_s *analysis_state)
+static bool wait_for_analysis_start(fbk_analysis_state_s *analysis_state, const bool *retiring)
 {
   bool ret_val = false;
 
   /* Check if analysis is active */
   fbk_mutex_lock(&analysis_state->lock);
-  pthread_cleanup_push(worker_thread_analysis_state_cleanup, &analysis_state->lock);
-  while(!analysis_state->analysis_active)
+  while(!analysis_state->analysis_active && ((NULL == retiring) || !(*retiring)))
   {
     FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Thread 0x%lx waiting for analysis to start.", pthread_self());
     ret_val = true;
     FBK_ASSERT_MSG(0 == pthread_cond_wait(&analysis_state->analysis_started_cond, &analysis_state->lock),
       "Failed Waiting for analysis started condition.");
   }
-  pthread_cleanup_pop(0);
   fbk_mutex_unlock(&analysis_state->lock);
   
   return ret_val;
@@ -85,28 +80,88 @@ static void push_job_to_job_queue(fbk_analysis_job_queue_s * queue, fbk_analysis
 }
 
 /**
- * @brief Returns the next job in the job queue or NULL if no jobs are available.  Assumes caller has lock.
- * @param queue Job queue to pop from.
+ * @brief Attempts to claim a node so its subtree is analyzed by a single worker at a time.  Never takes the node lock.
+ * @param node node to claim
+ * 
+ * @return true if node was claimed by the caller
 */
-static fbk_analysis_job_queue_node_s * pop_job_from_job_queue(fbk_analysis_job_queue_s * queue)
+static bool try_claim_node(fbk_move_tree_node_s * node)
 {
-  fbk_analysis_job_queue_node_s * ret_val = NULL;
+  FBK_ASSERT_MSG(node != NULL, "NULL node passed.");
 
-  FBK_ASSERT_MSG(queue != NULL, "NULL job queue passed.");
+  bool unclaimed = false;
 
-  if(queue->job_count > 0)
+  return atomic_compare_exchange_strong(&node->claimed, &unclaimed, true);
+}
+
+/**
+ * @brief Releases a node claimed by try_claim_node and wakes all workers waiting for a claimable job, as jobs queued 
+ *        behind this node may now be claimed.  Assumes caller has the queue lock.
+ * @param queue queue the node's job belongs to
+ * @param node  node to release
+*/
+static void release_node_claim(fbk_analysis_job_queue_s * queue, fbk_move_tree_node_s * node)
+{
+  FBK_ASSERT_MSG(node != NULL, "NULL node passed.");
+
+  const bool was_claimed = atomic_exchange(&node->claimed, false);
+  FBK_ASSERT_MSG(was_claimed, "Releasing node which was not claimed.");
+  (void) was_claimed;
+  pthread_cond_broadcast(&queue->new_job_available);
+}
+
+/**
+ * @brief Claims the first job in the job queue whose node is not claimed by another worker and returns it, or NULL if 
+ *        no job can be claimed.  Jobs behind a claimed node are skipped so the worker is diverted to sibling work 
+ *        instead of colliding with the worker analyzing that subtree.  Assumes caller has lock.
+ * @param queue   Job queue to pop from.
+ * @param context job context to record claim collisions in
+*/
+static fbk_analysis_job_queue_node_s * pop_job_from_job_queue(fbk_analysis_job_queue_s * queue, fbk_analysis_job_context_s * context)
+{
+  fbk_analysis_job_queue_node_s * ret_val  = NULL;
+  fbk_analysis_job_queue_node_s * prev_job = NULL;
+
+  FBK_ASSERT_MSG(queue != NULL,   "NULL job queue passed.");
+  FBK_ASSERT_MSG(context != NULL, "NULL job context passed.");
+
+  for(fbk_analysis_job_queue_node_s * job = queue->next_job; job != NULL; prev_job = job, job = job->next_job)
   {
-    ret_val = queue->next_job;
-    queue->next_job = queue->next_job->next_job;
+    if(try_claim_node(job->job.node))
+    {
+      ret_val = job;
+      break;
+    }
+    context->claim_collisions++;
+  }
+
+  if(ret_val != NULL)
+  {
+    context->diverted = (prev_job != NULL);
+
+    /* Unlink claimed job */
+    if(prev_job != NULL)
+    {
+      prev_job->next_job = ret_val->next_job;
+    }
+    else
+    {
+      queue->next_job = ret_val->next_job;
+    }
+    if(ret_val == queue->last_job)
+    {
+      queue->last_job = prev_job;
+    }
 
     queue->job_count--;
     queue->active_job_count++;
+    /* Root only changes while no job is active */
+    context->root = queue->jobs_root;
 
     if(queue->job_count == 0)
     {
-      FBK_ASSERT_MSG(ret_val == queue->last_job, "All jobs claimed, but returned job is not the last job");
-      FBK_ASSERT_MSG(NULL == queue->next_job, "All jobs claimed, but last job is not pointing to NULL");
-      queue->last_job = NULL;
+      FBK_ASSERT_MSG(NULL == queue->next_job, "All jobs claimed, but next job is not NULL");
+      FBK_ASSERT_MSG(NULL == queue->last_job, "All jobs claimed, but last job is not NULL");
     }
     
     pthread_cond_signal(&queue->job_claimed);
@@ -115,33 +170,133 @@ static fbk_analysis_job_queue_node_s * pop_job_from_job_queue(fbk_analysis_job_q
   return ret_val;
 }
 
-static void update_stats(fbk_node_count_t analyzed_nodes)
+/**
+ * @brief Returns the job duration histogram bucket for given duration
+ * @param duration job duration in ms
+*/
+static inline unsigned int job_duration_histogram_bucket(fbk_time_ms_t duration)
+{
+  unsigned int bucket = 0;
+
+  while((duration > 0) && (bucket < (FBK_JOB_DURATION_HISTOGRAM_SIZE-1)))
+  {
+    duration >>= 1;
+    bucket++;
+  }
+
+  return bucket;
+}
+
+/**
+ * @brief Adds a finished job's counts and the worker's evaluation cache counts to the calling worker's statistics shard.  
+ *        Lock-free, each shard is only written by its own worker thread unless more workers than shards are running
+ * @param context      context of finished job
+ * @param job_duration duration of the finished job in ms
+*/
+static void update_stats(const fbk_analysis_job_context_s * context, fbk_time_ms_t job_duration)
 {
-  fbk_mutex_lock(&fbk_analysis_data.analysis_stats.lock);
-  fbk_analysis_data.analysis_stats.analyzed_nodes       += analyzed_nodes;
-  fbk_analysis_data.analysis_stats.game_analyzed_nodes  += analyzed_nodes;
-  fbk_analysis_data.analysis_stats.total_analyzed_nodes += analyzed_nodes;
-  fbk_mutex_unlock(&fbk_analysis_data.analysis_stats.lock);
+  FBK_ASSERT_MSG(context != NULL, "NULL job context passed.");
+
+  fbk_analysis_stats_shard_s * shard = &fbk_analysis_data.analysis_stats.shard[context->thread_index % FBK_ANALYSIS_STATS_SHARD_COUNT];
+  fbk_eval_counts_s eval_counts;
+  fbk_take_eval_counts(&eval_counts);
+
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_NODES],            context->nodes_evaluated,    memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_COMPRESSIONS],     context->compressions,       memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_CLAIM_COLLISIONS], context->claim_collisions,   memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_DIVERTED_JOBS],    (context->diverted)?1:0,     memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_PAWN_HASH_HITS],    eval_counts.pawn_hash_hits,    memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_PAWN_HASH_MISSES],  eval_counts.pawn_hash_misses,  memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_EVAL_CACHE_HITS],   eval_counts.eval_cache_hits,   memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->counter[FBK_ANALYSIS_COUNTER_EVAL_CACHE_MISSES], eval_counts.eval_cache_misses, memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->job_duration_histogram[job_duration_histogram_bucket(job_duration)], 1, memory_order_relaxed);
 }
 
 /**
- * @brief Cleans up job after successfully processing
- * @param queue   queue to book-keep
- * @param job     job to cleanup
+ * @brief Sums one counter over all statistics shards
+ * @param counter counter to sum
 */
-static void job_finished(fbk_analysis_job_queue_s * queue, fbk_analysis_job_queue_node_s * job)
+static fbk_analysis_counter_t aggregate_counter(fbk_analysis_counter_e counter)
+{
+  fbk_analysis_counter_t sum = 0;
+
+  for(unsigned int i = 0; i < FBK_ANALYSIS_STATS_SHARD_COUNT; i++)
+  {
+    sum += atomic_load_explicit(&fbk_analysis_data.analysis_stats.shard[i].counter[counter], memory_order_relaxed);
+  }
+
+  return sum;
+}
+
+/* Target window for job durations.  Finished jobs are deepened or narrowed to keep the next run within this window */
+#define WORKER_JOB_TARGET_MIN_DURATION_MS   20
+#define WORKER_JOB_TARGET_MAX_DURATION_MS  250
+/* Assumed growth of job duration per additional depth until it is measured */
+#define WORKER_JOB_DEFAULT_DEPTH_GROWTH      4
+
+/**
+ * @brief Cleans up job after successfully processing.  Job depth and breadth is adapted based on measured duration
+ *        so the next run of the job stays within the target duration window; quick jobs are deepened further and 
+ *        widened back to the default breadth, and jobs projected to run too long narrow the breadth searched at 
+ *        the job's node to its best ranked children.
+ * @param queue        queue to book-keep
+ * @param job          job to cleanup
+ * @param job_duration duration of the finished job in ms
+*/
+static void job_finished(fbk_analysis_job_queue_s * queue, fbk_analysis_job_queue_node_s * job, fbk_time_ms_t job_duration)
 {
   FBK_ASSERT_MSG(queue != NULL,   "NULL job queue passed.");
   FBK_ASSERT_MSG(job != NULL, "NULL job passed.");
 
+  /* Estimate how much longer the job will take for each additional depth */
+  fbk_time_ms_t depth_growth = WORKER_JOB_DEFAULT_DEPTH_GROWTH;
+  if((job->job.last_duration > 0) && (job_duration > job->job.last_duration))
+  {
+    depth_growth = job_duration/job->job.last_duration;
+  }
+  if(depth_growth < 2)
+  {
+    depth_growth = 2;
+  }
+  const fbk_time_ms_t projected_duration = job_duration*depth_growth;
+  job->job.last_duration = job_duration;
+
+  if(job->job.breadth > FBK_DEFAULT_ANALYSIS_BREADTH)
+  {
+    /* Initial full-breadth job, continue with default breadth */
+    job->job.depth++;
+    job->job.breadth = FBK_DEFAULT_ANALYSIS_BREADTH;
+  }
+  else if(projected_duration < WORKER_JOB_TARGET_MIN_DURATION_MS)
+  {
+    /* Job is quick, deepen twice if the next run is still projected to stay under the target maximum */
+    job->job.depth += (((projected_duration*depth_growth) < WORKER_JOB_TARGET_MAX_DURATION_MS) && (job->job.depth < (FBK_MAX_DEPTH-1)))?2:1;
+    /* Widen a previously narrowed job back towards the default breadth */
+    if(job->job.breadth < FBK_DEFAULT_ANALYSIS_BREADTH)
+    {
+      job->job.breadth = ((job->job.breadth*2) < FBK_DEFAULT_ANALYSIS_BREADTH)?(job->job.breadth*2):FBK_DEFAULT_ANALYSIS_BREADTH;
+    }
+  }
+  else if((projected_duration > WORKER_JOB_TARGET_MAX_DURATION_MS) && (job->job.breadth > 1))
+  {
+    /* Job will run too long, keep the depth and only search the better half of the job node's children.
+       A second job over the other half would claim the same node and serialize behind this one, and nodes 
+       below the job's node cannot carry their own jobs as their arrays move when the job's node is compressed */
+    job->job.breadth        = job->job.breadth/2;
+    job->job.last_duration /= 2;
+  }
+  else
+  {
+    job->job.depth++;
+  }
+
   fbk_mutex_lock(&queue->lock);
   FBK_ASSERT_MSG(queue->active_job_count > 0, "Unexpected for job to finish with no active jobs");
   queue->active_job_count--;
+  release_node_claim(queue, job->job.node);
 
-  job->job.depth++;
   job->job.job_id  = queue->next_job_id++;
-  job->job.breadth = FBK_DEFAULT_ANALYSIS_BREADTH;
-  FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Queueing job %u with depth %lu and breadth %u.", job->job.job_id, job->job.depth, job->job.breadth);
+  FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Queueing job %u with depth %lu and breadth %u after %ld ms.", job->job.job_id, job->job.depth, job->job.breadth, (long) job_duration);
   push_job_to_job_queue(queue, job);
   pthread_cond_signal(&fbk_analysis_data.job_queue.job_ended);
   fbk_mutex_unlock(&queue->lock);
@@ -161,6 +316,7 @@ static void job_aborted(fbk_analysis_job_queue_s * queue, fbk_analysis_job_queue
 
   fbk_mutex_lock(&queue->lock);
   FBK_ASSERT_MSG(queue->active_job_count > 0, "Unexpected for job to abort with no active jobs");
+  release_node_claim(queue, job->job.node);
   /* Put job back in queue */
   push_job_to_job_queue(queue, job);
   queue->active_job_count--;
@@ -192,12 +348,145 @@ static void clear_job_queue(fbk_analysis_job_queue_s * queue)
   FBK_ASSERT_MSG(0 == queue->job_count, "Unexpected number (%lu) of jobs remaining after clearing queue.", queue->job_count);
   queue->next_job = NULL;
   queue->last_job = NULL;
-  queue->queue_cleared = true;
+  queue->jobs_root = NULL;
   pthread_cond_broadcast(&queue->job_claimed);
 }
 
 #define WORKER_MANAGER_QUEUED_JOBS_PER_WORKER 2
 #define WORKER_MANAGER_JOB_INITIAL_DEPTH 3
+
+/**
+ * @brief Counts the plies between node and one of its ancestors by following parent pointers
+ * @param node     node to start from
+ * @param ancestor potential ancestor of node
+ * 
+ * @return number of plies from ancestor to node, or -1 if ancestor is not reachable (e.g. unrelated or compressed in between)
+*/
+static int node_distance_from_ancestor(const fbk_move_tree_node_s * node, const fbk_move_tree_node_s * ancestor)
+{
+  int distance = 0;
+
+  while((node != NULL) && (node != ancestor))
+  {
+    node = node->parent;
+    distance++;
+  }
+
+  return (node == ancestor)?distance:-1;
+}
+
+/**
+ * @brief Re-roots the job queue at a new root node.  Queued jobs for children of the new root are kept, jobs which 
+ *        cover the new root (the new root is in their subtree) seed the depth of the new root's child jobs, and all 
+ *        other jobs are discarded.  Children of the new root without a kept job get a new job.  Assumes caller has 
+ *        the queue lock and no jobs are active.
+ * @param queue    queue to re-root
+ * @param new_root new root node for analysis
+ * @param game     reference game for new root node
+*/
+static void reroot_job_queue(fbk_analysis_job_queue_s * queue, fbk_move_tree_node_s * new_root, const ftk_game_s * game)
+{
+  FBK_ASSERT_MSG(queue != NULL,    "NULL job queue passed.");
+  FBK_ASSERT_MSG(new_root != NULL, "NULL root node passed.");
+  FBK_ASSERT_MSG(game != NULL,     "NULL game passed.");
+  FBK_ASSERT_MSG(0 == queue->active_job_count, "Attempting to re-root job queue while %lu jobs are still active", queue->active_job_count);
+
+  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Re-rooting job queue with %lu jobs.", queue->job_count);
+
+  /* Detach old jobs */
+  fbk_analysis_job_queue_node_s * job = queue->next_job;
+  queue->next_job  = NULL;
+  queue->last_job  = NULL;
+  queue->job_count = 0;
+
+  fbk_mutex_lock(&new_root->lock);
+  fbk_decompress_move_tree_node(new_root, true);
+  if(false == new_root->expanded)
+  {
+    ftk_game_s root_game = *game;
+    FBK_DEBUG_MSG(FBK_DEBUG_MED, "Expanding new root move tree node.");
+    fbk_expand_move_tree_node(new_root, &root_game, NULL, true);
+  }
+
+  /* Depth each child of the new root should continue at, 0 if not covered by any previous job */
+  fbk_depth_t *child_depth = calloc((new_root->child_count > 0)?new_root->child_count:1, sizeof(fbk_depth_t));
+  bool        *child_kept  = calloc((new_root->child_count > 0)?new_root->child_count:1, sizeof(bool));
+  FBK_ASSERT_MSG((child_depth != NULL) && (child_kept != NULL), "Failed to allocate memory for re-rooting.");
+
+  unsigned int kept_jobs = 0, discarded_jobs = 0;
+  while(NULL != job)
+  {
+    fbk_analysis_job_queue_node_s * next_job = job->next_job;
+    const int distance = node_distance_from_ancestor(new_root, job->job.node);
+
+    if((job->job.node->parent == new_root) && (new_root->child_count > 0) &&
+       (job->job.node >= &new_root->child[0]) && (job->job.node < &new_root->child[new_root->child_count]))
+    {
+      /* Job is already analyzing a child of the new root, keep it as is */
+      const fbk_move_tree_node_count_t i = job->job.node - new_root->child;
+      child_kept[i] = true;
+      push_job_to_job_queue(queue, job);
+      kept_jobs++;
+    }
+    else
+    {
+      if((distance >= 0) && (job->job.depth > (fbk_depth_t) distance + 1))
+      {
+        /* New root is within this job's subtree, children continue at the depth already completed.  A queued job's 
+           depth is the next depth it runs, so its subtree was last completed one less deep */
+        const fbk_depth_t completed_depth = job->job.depth - 1;
+        const fbk_depth_t inherited_depth = completed_depth - distance - 1;
+        for(fbk_move_tree_node_count_t i = 0; i < new_root->child_count; i++)
+        {
+          if(inherited_depth > child_depth[i])
+          {
+            child_depth[i] = inherited_depth;
+          }
+        }
+      }
+      free(job);
+      discarded_jobs++;
+    }
+
+    job = next_job;
+  }
+
+  /* Queue jobs for all children which are not already covered */
+  for(fbk_move_tree_node_count_t i = 0; i < new_root->child_count; i++)
+  {
+    if(child_kept[i])
+    {
+      continue;
+    }
+
+    fbk_analysis_job_queue_node_s *new_job = calloc(1, sizeof(fbk_analysis_job_queue_node_s));
+    FBK_ASSERT_MSG(new_job != NULL, "Failed to allocate memory for new job.");
+    new_job->job.job_id  = queue->next_job_id++;
+    new_job->job.game    = *game;
+    new_job->job.node    = &new_root->child[i];
+    fbk_init_incremental_eval(&new_job->job.eval, &new_job->job.game);
+    FBK_ASSERT_MSG(fbk_apply_move_tree_node(new_job->job.node, &new_job->job.game, &new_job->job.eval), "Failed to apply node for child %u", i);
+    new_job->job.depth   = (child_depth[i] > WORKER_MANAGER_JOB_INITIAL_DEPTH)?child_depth[i]:WORKER_MANAGER_JOB_INITIAL_DEPTH;
+    new_job->job.breadth = FBK_MAX_ANALYSIS_BREADTH;
+    FBK_DEBUG_MSG(FBK_DEBUG_MED, "Queueing job %u with depth %lu and breadth %u.", new_job->job.job_id, new_job->job.depth, new_job->job.breadth);
+    push_job_to_job_queue(queue, new_job);
+  }
+  fbk_mutex_unlock(&new_root->lock);
+
+  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Re-rooted job queue, kept %u jobs and discarded %u jobs.", kept_jobs, discarded_jobs);
+
+  free(child_depth);
+  free(child_kept);
+  queue->jobs_root = new_root;
+
+  /* Search effort is counted per child of the root, no job is active to credit it */
+  for(unsigned int i = 0; i < FBK_MOVE_TREE_MAX_NODE_COUNT; i++)
+  {
+    atomic_store_explicit(&fbk_analysis_data.best_line.effort_nodes[i], 0, memory_order_relaxed);
+  }
+  atomic_store_explicit(&fbk_analysis_data.best_line.effort_total, 0, memory_order_relaxed);
+}
+
 /**
  * @brief Main thread for worker manager thread
  * @param arg pointer to main analysis data structure
@@ -209,21 +498,14 @@ static void * worker_manager_thread_f(void * arg)
 
   FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Starting worker thread manager with ID 0x%lx.", pthread_self());
 
-  fbk_move_tree_node_s * node = NULL;
-
   while(1)
   {
-    wait_for_analysis_start(&analysis_data->analysis_state);
+    wait_for_analysis_start(&analysis_data->analysis_state, NULL);
 
     fbk_mutex_lock(&analysis_data->analysis_state.lock);
     fbk_mutex_lock(&analysis_data->job_queue.lock);
 
-    if(true == analysis_data->job_queue.queue_cleared)
-    {
-      node = NULL;
-    }
-
-    while(node == analysis_data->analysis_state.root_node)
+    while(analysis_data->job_queue.jobs_root == analysis_data->analysis_state.root_node)
     {
       fbk_mutex_unlock(&analysis_data->job_queue.lock);
       pthread_cond_wait(&fbk_analysis_data.analysis_state.analysis_node_changed_cond, &analysis_data->analysis_state.lock);
@@ -231,38 +513,11 @@ static void * worker_manager_thread_f(void * arg)
     }
 
     if((analysis_data->analysis_state.analysis_active) &&
-       (node != analysis_data->analysis_state.root_node))
+       (NULL != analysis_data->analysis_state.root_node))
     {
-      analysis_data->job_queue.queue_cleared = false;
-
       /* Make sure analysis is still active and root node changed */
       FBK_DEBUG_MSG(FBK_DEBUG_MED, "Creating initial analysis jobs.");
-      node = analysis_data->analysis_state.root_node;
-      fbk_mutex_lock(&node->lock);
-      fbk_decompress_move_tree_node(node, true);
-
-      if(false == node->analysis_data.evaluated)
-      {
-        FBK_ASSERT_MSG(node != NULL, "Attempting analysis on NULL node.");
-        FBK_DEBUG_MSG(FBK_DEBUG_MED, "Evaluating current move tree node.");
-        fbk_evaluate_move_tree_node(node, &analysis_data->analysis_state.game, true);
-      }
-
-      for(fbk_node_count_t i = 0; i < node->child_count; i++)
-      {
-        FBK_DEBUG_MSG(FBK_DEBUG_MED, "Queueing job %u with depth %u and breadth %u.", analysis_data->job_queue.next_job_id, WORKER_MANAGER_JOB_INITIAL_DEPTH, FBK_MAX_ANALYSIS_BREADTH);
-        fbk_analysis_job_queue_node_s *new_job = calloc(1, sizeof(fbk_analysis_job_queue_node_s));
-        FBK_ASSERT_MSG(new_job != NULL, "Failed to allocate memory for new job.");
-        /* Fill job info here... */
-        new_job->job.job_id  = analysis_data->job_queue.next_job_id++;
-        new_job->job.game    = analysis_data->analysis_state.game;
-        new_job->job.node    = &node->child[i];
-        FBK_ASSERT_MSG(fbk_apply_move_tree_node(new_job->job.node, &new_job->job.game), "Failed to apply node for child %lu", i);
-        new_job->job.depth   = WORKER_MANAGER_JOB_INITIAL_DEPTH;
-        new_job->job.breadth = FBK_MAX_ANALYSIS_BREADTH;
-        push_job_to_job_queue(&analysis_data->job_queue, new_job);
-      }
-      fbk_mutex_unlock(&node->lock);
+      reroot_job_queue(&analysis_data->job_queue, analysis_data->analysis_state.root_node, &analysis_data->analysis_state.game);
     }
     fbk_mutex_unlock(&analysis_data->job_queue.lock);
     fbk_mutex_unlock(&analysis_data->analysis_state.lock);
@@ -304,8 +559,10 @@ bool fbk_init_analysis_data(fbk_instance_s *fbk)
     FBK_ASSERT_MSG(0 == pthread_cond_init(&fbk_analysis_data.job_queue.job_claimed, NULL), "Failed to initialize job claimed condition");
     FBK_ASSERT_MSG(0 == pthread_cond_init(&fbk_analysis_data.job_queue.job_ended, NULL),   "Failed to initialize job ended condition");
 
-    /* Initialize stats */
-    FBK_ASSERT_MSG(fbk_mutex_init(&fbk_analysis_data.analysis_stats.lock), "Failed to initialize analysis stats lock");
+    /* Initialize best line publication */
+    FBK_ASSERT_MSG(fbk_mutex_init(&fbk_analysis_data.best_line.publish_lock), "Failed to initialize best line publish lock");
+    atomic_init(&fbk_analysis_data.best_line.current, NULL);
+    atomic_init(&fbk_analysis_data.best_line.readers, 0);
 
     /* Start manager thread */
     pthread_create(&fbk_analysis_data.worker_manager_thread, NULL, worker_manager_thread_f, &fbk_analysis_data);
@@ -319,48 +576,16 @@ bool fbk_init_analysis_data(fbk_instance_s *fbk)
   return ret_val;
 }
 
-static void worker_thread_cleanup(void * arg)
-{
-  FBK_ASSERT_MSG(arg != NULL, "NULL worker thread data passed.");
-  fbk_worker_thread_data_s *worker_thread_data = (fbk_worker_thread_data_s *) arg;
-  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Cleaning up worker thread %u.", worker_thread_data->thread_index);
-}
-
-static void worker_thread_job_queue_cleanup(void *arg)
-{
-  FBK_ASSERT_MSG(arg != NULL, "NULL worker thread data passed.");
-  fbk_worker_thread_data_s *worker_thread_data = (fbk_worker_thread_data_s *) arg;
-  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Worker thread %u releasing job queue mutex for thread cancellation.", worker_thread_data->thread_index);
-  fbk_mutex_unlock(&worker_thread_data->job_queue->lock);
-}
-
-typedef struct
-{
-  unsigned int worker_thread_index;
-  fbk_analysis_job_queue_s      * queue;
-  fbk_analysis_job_queue_node_s * job;
-} worker_thread_job_cleanup_s;
-
-static void worker_thread_job_cleanup_f(void *arg)
-{
-  FBK_ASSERT_MSG(arg != NULL, "NULL worker thread data passed.");
-  worker_thread_job_cleanup_s * job_cleanup = (worker_thread_job_cleanup_s *)arg;
-  FBK_ASSERT_MSG(job_cleanup->queue != NULL, "NULL job queue passed.");
-  FBK_ASSERT_MSG(job_cleanup->job   != NULL, "NULL job passed.");
-  
-  FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u aborting active job %u.", job_cleanup->worker_thread_index, job_cleanup->job->job.job_id);
-
-  job_aborted(job_cleanup->queue, job_cleanup->job);
-}
-
 /**
  * @brief Initialization logic for job context to be called before every process job
 */
-static void init_job_context(fbk_analysis_job_context_s * context, fbk_thread_index_t thread_index)
+static void init_job_context(fbk_analysis_job_context_s * context, const fbk_worker_thread_data_s * worker_thread_data)
 {
-  FBK_ASSERT_MSG(context != NULL,    "NULL job context passed.");
+  FBK_ASSERT_MSG(context != NULL,            "NULL job context passed.");
+  FBK_ASSERT_MSG(worker_thread_data != NULL, "NULL worker thread data passed.");
   memset(context, 0, sizeof(fbk_analysis_job_context_s));
-  context->thread_index = thread_index;
+  context->thread_index = worker_thread_data->thread_index;
+  context->retiring     = &worker_thread_data->retiring;
   context->top_call     = true;
 }
 
@@ -458,72 +683,415 @@ static void process_job(const fbk_analysis_job_s * job, fbk_analysis_job_context
     /* Init result */
     memset(result, 0, sizeof(fbk_analysis_job_result_s));
     result->result = FBK_ANALYSIS_JOB_COMPLETE;
+    /* Collect positions before the job's node once, the search path is pushed and popped while recursing */
+    fbk_init_key_history_from_tree(&context->history, job->node, &job->game);
+    context->node_irreversible = false;
     context->top_call = false;
   }
 
-  if(fbk_analysis_data.analysis_state.analysis_active)
+  if(fbk_analysis_data.analysis_state.analysis_active && !(*context->retiring))
   {
-    if(0 == pthread_mutex_trylock(&job->node->lock))
+    /* The job's subtree is claimed by this worker, so other threads only hold this lock briefly */
+    fbk_mutex_lock(&job->node->lock);
+    fbk_decompress_move_tree_node(job->node, true);
+    ftk_game_s             game = job->game;
+    fbk_incremental_eval_s eval = job->eval;
+    if(fbk_evaluate_move_tree_node(job->node, &game, &eval, &context->history, true) == true)
+    {
+      context->nodes_evaluated++;
+    }
+
+    if((result->result == FBK_ANALYSIS_JOB_COMPLETE) && (job->depth > 0))
     {
-      fbk_decompress_move_tree_node(job->node, true);
-      ftk_game_s game = job->game;
-      if(fbk_evaluate_move_tree_node(job->node, &game, true) == true)
+      fbk_analysis_job_s sub_job = *job;
+      sub_job.depth--;
+      /* A job narrowed to run within its target duration is only narrowed at its own node, deeper plies search at least the default breadth */
+      if(sub_job.breadth < FBK_DEFAULT_ANALYSIS_BREADTH)
       {
-        context->nodes_evaluated++;
+        sub_job.breadth = FBK_DEFAULT_ANALYSIS_BREADTH;
       }
 
-      if((result->result == FBK_ANALYSIS_JOB_COMPLETE) && (job->depth > 0))
+      /* Children are only created once a search visits this node */
+      fbk_expand_move_tree_node(job->node, &game, &eval, true);
+      fbk_push_key_history(&context->history, job->node->key, context->node_irreversible);
+
+      /* Do surface analysis (depth 1) on all child nodes in one batch, leaving their children unexpanded */
+      context->nodes_evaluated += fbk_evaluate_child_nodes(job->node, &game, &eval, &context->history);
+
+      if(sub_job.depth > 1)
       {
-        fbk_analysis_job_s sub_job = *job;
-        sub_job.depth--;
+        fbk_move_tree_node_s** sorted_nodes = malloc(job->node->child_count * sizeof(fbk_move_tree_node_s*));
+        FBK_ASSERT_MSG(true == fbk_sort_child_nodes(job->node, sorted_nodes), "Failed to sort child nodes.");
 
-        for(fbk_node_count_t i = 0; i < job->node->child_count; i++)
+        for(fbk_node_count_t i = 0; (i < job->node->child_count) && (i < job->breadth); i++)
         {
-          /* Do surface analysis (depth 1) on all child nodes */
-          FBK_ASSERT_MSG(fbk_apply_move_tree_node(&job->node->child[i], &game), "Failed to apply child node %lu", i);
-          fbk_mutex_lock(&job->node->child[i].lock);
-          if(fbk_evaluate_move_tree_node(&job->node->child[i], &game, true) == true)
+          sub_job.node = sorted_nodes[(job->node->child_count-1)-i];
+          /* Child moves are only set while holding this node's lock */
+          context->node_irreversible = fbk_irreversible_move(&sub_job.game.board, &sub_job.node->move);
+          fbk_mutex_unlock(&job->node->lock);
+          FBK_ASSERT_MSG(fbk_apply_move_tree_node(sub_job.node, &sub_job.game, &sub_job.eval), "Failed to apply child node %lu", i);
+          process_job(&sub_job, context, result);
+          FBK_ASSERT_MSG(fbk_undo_move_tree_node(sub_job.node, &sub_job.game, &sub_job.eval), "Failed to undo child node %lu", i);
+          fbk_mutex_lock(&job->node->lock);
+          if(result->result != FBK_ANALYSIS_JOB_COMPLETE)
           {
-            context->nodes_evaluated++;
-            fbk_compress_move_tree_node(&job->node->child[i], true);
+            break;
           }
-          fbk_mutex_unlock(&job->node->child[i].lock);
-          FBK_ASSERT_MSG(fbk_undo_move_tree_node(&job->node->child[i], &game), "Failed to undo child node %lu", i);
         }
+        free(sorted_nodes);
+      }
+      fbk_pop_key_history(&context->history);
+    }
+    update_analysis_from_child_nodes(job->node);
+    if(fbk_compress_move_tree_node(job->node, true))
+    {
+      context->compressions++;
+    }
+    fbk_mutex_unlock(&job->node->lock);
+  }
+  else
+  {
+    result->result = FBK_ANALYSIS_JOB_ABORTED;
+  }
+}
 
-        if(sub_job.depth > 1)
-        {
-          fbk_move_tree_node_s** sorted_nodes = malloc(job->node->child_count * sizeof(fbk_move_tree_node_s*));
-          FBK_ASSERT_MSG(true == fbk_sort_child_nodes(job->node, sorted_nodes), "Failed to sort child nodes.");
+/**
+ * @brief Appends node's move and the best line below it to a snapshot.  Locks nodes parent first like workers do
+ * @param node     node to append, parent node must be locked or be the root with its child array held in place
+ * @param snapshot snapshot being built
+*/
+static void append_best_line(fbk_move_tree_node_s * node, fbk_best_line_snapshot_s * snapshot)
+{
+  fbk_mutex_lock(&node->lock);
+  bool decompressed = fbk_decompress_move_tree_node(node, true);
+
+  if(0 == snapshot->line_length)
+  {
+    snapshot->analysis_data = node->analysis_data;
+    snapshot->child_count   = node->child_count;
+  }
+  snapshot->line[snapshot->line_length++] = node->move;
+
+  if((snapshot->line_length < FBK_BEST_LINE_SNAPSHOT_MAX_LENGTH) &&
+     node->analysis_data.evaluated && (node->analysis_data.best_child_index < node->child_count))
+  {
+    append_best_line(&node->child[node->analysis_data.best_child_index], snapshot);
+  }
+
+  if(decompressed)
+  {
+    fbk_compress_move_tree_node(node, true);
+  }
+  fbk_mutex_unlock(&node->lock);
+}
+
+/**
+ * @brief Returns true if two snapshots differ in root or moves of the best line
+*/
+static bool best_line_moves_changed(const fbk_best_line_snapshot_s * a, const fbk_best_line_snapshot_s * b)
+{
+  bool ret_val = (a->root != b->root) || (a->line_length != b->line_length);
+
+  for(unsigned int i = 0; (i < a->line_length) && !ret_val; i++)
+  {
+    ret_val = !FTK_COMPARE_MOVES(a->line[i], b->line[i]);
+  }
+
+  return ret_val;
+}
+
+/**
+ * @brief Returns true if two snapshots differ in best line or analysis
+*/
+static bool best_line_changed(const fbk_best_line_snapshot_s * a, const fbk_best_line_snapshot_s * b)
+{
+  bool ret_val = best_line_moves_changed(a, b)                                              ||
+                 (a->root_child_count                != b->root_child_count)                ||
+                 (a->child_count                     != b->child_count)                     ||
+                 (a->score_gap                       != b->score_gap)                       ||
+                 (a->best_move_effort_permille       != b->best_move_effort_permille)       ||
+                 (a->analysis_data.evaluated         != b->analysis_data.evaluated)         ||
+                 (a->analysis_data.base_score        != b->analysis_data.base_score)        ||
+                 (a->analysis_data.result            != b->analysis_data.result)            ||
+                 (a->analysis_data.min_depth         != b->analysis_data.min_depth)         ||
+                 (a->analysis_data.max_depth         != b->analysis_data.max_depth)         ||
+                 (a->analysis_data.best_child_result != b->analysis_data.best_child_result) ||
+                 (a->analysis_data.best_child_score  != b->analysis_data.best_child_score)  ||
+                 (a->analysis_data.best_child_depth  != b->analysis_data.best_child_depth);
+
+  return ret_val;
+}
+
+/**
+ * @brief Replaces the published snapshot and frees replaced snapshots once no reader holds one.  Readers increment the 
+ *        reader count before loading the snapshot, so a replaced snapshot seen with no readers can no longer be reached.
+ *        Assumes caller holds the publish lock.
+ * @param publication best line publication
+ * @param snapshot    new snapshot, NULL to withdraw the published snapshot
+*/
+static void swap_best_line_snapshot(fbk_best_line_publication_s * publication, fbk_best_line_snapshot_s * snapshot)
+{
+  fbk_best_line_snapshot_s * replaced = atomic_exchange(&publication->current, snapshot);
+
+  if(replaced != NULL)
+  {
+    replaced->next_retired = publication->retired;
+    publication->retired   = replaced;
+  }
+
+  if(0 == atomic_load(&publication->readers))
+  {
+    while(publication->retired != NULL)
+    {
+      fbk_best_line_snapshot_s * next_retired = publication->retired->next_retired;
+      free(publication->retired);
+      publication->retired = next_retired;
+    }
+  }
+}
+
+/**
+ * @brief Returns a node's score as compared when sorting, assumes the node's result is not decided
+*/
+static inline fbk_score_t sort_score(const fbk_move_tree_node_analysis_data_s * analysis_data, fbk_move_tree_node_count_t child_count)
+{
+  return (analysis_data->best_child_index < child_count)?analysis_data->best_child_score:analysis_data->base_score;
+}
+
+/**
+ * @brief Returns the child of the root whose subtree contains a node, NULL if the node is the root or not below it.  
+ *        Assumes the root's child array can not move
+ * @param root analysis root
+ * @param node node to find the root child of
+*/
+static fbk_move_tree_node_s * root_child_of(const fbk_move_tree_node_s * root, const fbk_move_tree_node_s * node)
+{
+  fbk_move_tree_node_s * ret_val = NULL;
+
+  if((node != NULL) && (node != root))
+  {
+    const fbk_move_tree_node_s * root_child = node;
+    while((root_child->parent != NULL) && (root_child->parent != root))
+    {
+      root_child = root_child->parent;
+    }
+    if((root_child->parent == root) && (root->child != NULL) && ((root_child - root->child) < root->child_count))
+    {
+      ret_val = &root->child[root_child - root->child];
+    }
+  }
+
+  return ret_val;
+}
 
-          for(fbk_node_count_t i = 0; (i < job->node->child_count) && (i < job->breadth); i++)
+/**
+ * @brief Fills a snapshot from the ranked children of the root.  Only the root's children and the best line are 
+ *        locked, so caller must keep the root's child array from moving, i.e. hold the root's lock or an active job 
+ *        below the root
+ * @param publication best line publication
+ * @param root        analysis root
+ * @param snapshot    snapshot to fill
+*/
+static void build_best_line(fbk_best_line_publication_s * publication, const fbk_move_tree_node_s * root, fbk_best_line_snapshot_s * snapshot)
+{
+  snapshot->root              = root;
+  snapshot->root_child_count  = root->child_count;
+  snapshot->best_root_child   = root->child_count;
+  snapshot->second_root_child = root->child_count;
+  if(root->child_count > 0)
+  {
+    fbk_move_tree_node_s** sorted_nodes = malloc(root->child_count * sizeof(fbk_move_tree_node_s*));
+    FBK_ASSERT_MSG(sorted_nodes != NULL, "Failed to allocate sorted nodes.");
+    if(fbk_sort_child_nodes(root, sorted_nodes))
+    {
+      fbk_move_tree_node_s * best_node = sorted_nodes[root->child_count-1];
+      snapshot->best_root_child = best_node - root->child;
+      append_best_line(best_node, snapshot);
+
+      const fbk_node_count_t effort_total = atomic_load_explicit(&publication->effort_total, memory_order_relaxed);
+      if(effort_total > 0)
+      {
+        snapshot->best_move_effort_permille = (atomic_load_explicit(&publication->effort_nodes[snapshot->best_root_child], memory_order_relaxed) * 1000) / effort_total;
+      }
+
+      if(root->child_count > 1)
+      {
+        fbk_move_tree_node_s * second_node = sorted_nodes[root->child_count-2];
+        snapshot->second_root_child = second_node - root->child;
+        if(FTK_END_NOT_OVER == snapshot->analysis_data.best_child_result)
+        {
+          fbk_mutex_lock(&second_node->lock);
+          if(FTK_END_NOT_OVER == second_node->analysis_data.best_child_result)
           {
-            sub_job.node = sorted_nodes[(job->node->child_count-1)-i];
-            fbk_mutex_unlock(&job->node->lock);
-            FBK_ASSERT_MSG(fbk_apply_move_tree_node(sub_job.node, &sub_job.game), "Failed to apply child node %lu", i);
-            process_job(&sub_job, context, result);
-            FBK_ASSERT_MSG(fbk_undo_move_tree_node(sub_job.node, &sub_job.game), "Failed to undo child node %lu", i);
-            fbk_mutex_lock(&job->node->lock);
-            if(result->result != FBK_ANALYSIS_JOB_COMPLETE)
-            {
-              break;
-            }
+            const fbk_score_t best_score   = sort_score(&snapshot->analysis_data, snapshot->child_count);
+            const fbk_score_t second_score = sort_score(&second_node->analysis_data, second_node->child_count);
+            snapshot->score_gap    = (FTK_COLOR_WHITE == best_node->move.turn)?(best_score-second_score):(second_score-best_score);
+            snapshot->gap_is_score = true;
           }
-          free(sorted_nodes);
+          fbk_mutex_unlock(&second_node->lock);
         }
       }
-      update_analysis_from_child_nodes(job->node);
-      fbk_compress_move_tree_node(job->node, true);
-      fbk_mutex_unlock(&job->node->lock);
+    }
+    free(sorted_nodes);
+  }
+}
+
+/**
+ * @brief Replaces the published snapshot if the new snapshot differs, otherwise frees it.  Assumes caller holds the 
+ *        publish lock
+ * @param publication best line publication
+ * @param snapshot    new snapshot
+*/
+static void publish_snapshot(fbk_best_line_publication_s * publication, fbk_best_line_snapshot_s * snapshot)
+{
+  const fbk_best_line_snapshot_s * current = atomic_load(&publication->current);
+  if((NULL == current) || best_line_changed(current, snapshot))
+  {
+    snapshot->sequence      = ++publication->sequence;
+    snapshot->line_sequence = ((NULL == current) || best_line_moves_changed(current, snapshot))?
+                              ++publication->line_sequence:current->line_sequence;
+    swap_best_line_snapshot(publication, snapshot);
+  }
+  else
+  {
+    free(snapshot);
+  }
+}
+
+/**
+ * @brief Publishes best line of a new analysis root.  Assumes analysis is stopped
+ * @param root analysis root
+*/
+static void publish_root_best_line(fbk_move_tree_node_s * root)
+{
+  FBK_ASSERT_MSG(root != NULL, "NULL root passed.");
+
+  fbk_best_line_publication_s * publication = &fbk_analysis_data.best_line;
+  fbk_best_line_snapshot_s    * snapshot    = calloc(1, sizeof(fbk_best_line_snapshot_s));
+  FBK_ASSERT_MSG(snapshot != NULL, "Failed to allocate best line snapshot.");
+
+  fbk_mutex_lock(&publication->publish_lock);
+  fbk_mutex_lock(&root->lock);
+  bool decompressed = fbk_decompress_move_tree_node(root, true);
+  build_best_line(publication, root, snapshot);
+  if(decompressed)
+  {
+    fbk_compress_move_tree_node(root, true);
+  }
+  fbk_mutex_unlock(&root->lock);
+  publish_snapshot(publication, snapshot);
+  fbk_mutex_unlock(&publication->publish_lock);
+}
+
+/**
+ * @brief Returns true if analysis under a root child could have changed the published best line, i.e. nothing is 
+ *        published for the root, the child is the best or second best move, or the child's score now beats the 
+ *        second best move.  Only the root child is locked
+ * @param current    published snapshot, NULL if none
+ * @param root       analysis root
+ * @param root_child root child analysis changed under, NULL if analysis was at the root
+*/
+static bool root_child_may_change_best_line(const fbk_best_line_snapshot_s * current, const fbk_move_tree_node_s * root, fbk_move_tree_node_s * root_child)
+{
+  bool ret_val = (NULL == current) || (current->root != root) || (NULL == root_child);
+
+  if(!ret_val)
+  {
+    const fbk_move_tree_node_count_t index = root_child - root->child;
+    ret_val = (index == current->best_root_child) || (index == current->second_root_child) || !current->gap_is_score;
+  }
+
+  if(!ret_val)
+  {
+    fbk_mutex_lock(&root_child->lock);
+    const bool        decided = (FTK_END_NOT_OVER != root_child->analysis_data.best_child_result);
+    const fbk_score_t score   = sort_score(&root_child->analysis_data, root_child->child_count);
+    fbk_mutex_unlock(&root_child->lock);
+
+    /* Score of the second best move, scores are from white's perspective */
+    const fbk_score_t best_score = sort_score(&current->analysis_data, current->child_count);
+    if(FTK_COLOR_WHITE == root_child->move.turn)
+    {
+      ret_val = decided || (score > (best_score - current->score_gap));
     }
     else
     {
-      result->result = FBK_ANALYSIS_JOB_NO_LOCK;
+      ret_val = decided || (score < (best_score + current->score_gap));
     }
   }
-  else
+
+  return ret_val;
+}
+
+/**
+ * @brief Credits a finished job's nodes to the root child it searched under and publishes the best line of the root 
+ *        if the job could have changed it.  Caller must hold the job active so the root's child array can not move
+ * @param root     analysis root the job was claimed under
+ * @param job_node node of the finished job
+ * @param nodes    nodes searched by the job
+*/
+static void publish_job_best_line(const fbk_move_tree_node_s * root, const fbk_move_tree_node_s * job_node, fbk_node_count_t nodes)
+{
+  FBK_ASSERT_MSG(root != NULL, "NULL root passed.");
+
+  fbk_best_line_publication_s * publication = &fbk_analysis_data.best_line;
+  fbk_move_tree_node_s        * root_child  = root_child_of(root, job_node);
+
+  if(root_child != NULL)
   {
-    result->result = FBK_ANALYSIS_JOB_ABORTED;
+    /* Jobs at the root search all children and are not credited */
+    atomic_fetch_add_explicit(&publication->effort_nodes[root_child - root->child], nodes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&publication->effort_total,                           nodes, memory_order_relaxed);
+  }
+
+  const fbk_best_line_snapshot_s * current = fbk_acquire_best_line_snapshot();
+  const bool may_change = root_child_may_change_best_line(current, root, root_child);
+  fbk_release_best_line_snapshot();
+
+  if(may_change)
+  {
+    fbk_best_line_snapshot_s * snapshot = calloc(1, sizeof(fbk_best_line_snapshot_s));
+    FBK_ASSERT_MSG(snapshot != NULL, "Failed to allocate best line snapshot.");
+
+    /* Build under the publish lock so snapshots are published in the order the tree was read */
+    fbk_mutex_lock(&publication->publish_lock);
+    build_best_line(publication, root, snapshot);
+    publish_snapshot(publication, snapshot);
+    fbk_mutex_unlock(&publication->publish_lock);
+  }
+}
+
+const fbk_best_line_snapshot_s * fbk_acquire_best_line_snapshot()
+{
+  atomic_fetch_add(&fbk_analysis_data.best_line.readers, 1);
+  return atomic_load(&fbk_analysis_data.best_line.current);
+}
+
+void fbk_release_best_line_snapshot()
+{
+  FBK_ASSERT_MSG(atomic_load(&fbk_analysis_data.best_line.readers) > 0, "Best line snapshot released without being acquired.");
+  atomic_fetch_sub(&fbk_analysis_data.best_line.readers, 1);
+}
+
+/**
+ * @brief Pins or unpins calling worker thread to follow the engine configuration
+ * @param worker_thread_data calling worker thread's data
+*/
+static void update_worker_thread_affinity(fbk_worker_thread_data_s * worker_thread_data)
+{
+  const bool pin = fbk_analysis_data.fbk->config.pin_worker_threads;
+
+  if(pin != worker_thread_data->pinned)
+  {
+    if(pin)
+    {
+      worker_thread_data->pinned = fbk_pin_thread(worker_thread_data->thread_index);
+    }
+    else
+    {
+      fbk_unpin_thread();
+      worker_thread_data->pinned = false;
+    }
   }
 }
 
@@ -534,51 +1102,50 @@ static void * worker_thread_f(void * arg)
 
   FBK_DEBUG_MSG(FBK_DEBUG_MED, "Worker thread %u started with ID 0x%lx.", worker_thread_data->thread_index, pthread_self());
 
-  pthread_cleanup_push(worker_thread_cleanup, worker_thread_data);
-
-  while(1)
+  while(!worker_thread_data->retiring)
   {
-    wait_for_analysis_start(worker_thread_data->analysis_state);
+    wait_for_analysis_start(worker_thread_data->analysis_state, &worker_thread_data->retiring);
+    if(worker_thread_data->retiring)
+    {
+      break;
+    }
+    update_worker_thread_affinity(worker_thread_data);
+
+    fbk_analysis_job_context_s job_context;
+    fbk_analysis_job_result_s  job_result;
+    init_job_context(&job_context, worker_thread_data);
 
-    /* Claim an analysis job */
+    /* Claim an analysis job, waiting while every queued job's node is claimed by another worker */
+    fbk_analysis_job_queue_node_s * job = NULL;
     fbk_mutex_lock(&worker_thread_data->job_queue->lock);
-    pthread_cleanup_push(worker_thread_job_queue_cleanup, worker_thread_data);
-    while(worker_thread_data->job_queue->next_job == NULL)
+    while(!worker_thread_data->retiring && (NULL == (job = pop_job_from_job_queue(worker_thread_data->job_queue, &job_context))))
     {
       FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u waiting for job.", worker_thread_data->thread_index);
       FBK_ASSERT_MSG(0 == pthread_cond_wait(&worker_thread_data->job_queue->new_job_available, &worker_thread_data->job_queue->lock),
         "Failed Waiting for new data available condition.");
     }
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-    pthread_cleanup_pop(0);
-   
-    worker_thread_job_cleanup_s worker_thread_job_cleanup = 
-      {
-        .worker_thread_index = worker_thread_data->thread_index,
-        .queue               = worker_thread_data->job_queue,
-        .job                 = NULL,
-      };
-    pthread_cleanup_push(worker_thread_job_cleanup_f, &worker_thread_job_cleanup);
-
-    /* Claim job and set pthread cancellation cleanup callback */
-    fbk_analysis_job_queue_node_s * job = pop_job_from_job_queue(worker_thread_data->job_queue);
-    FBK_ASSERT_MSG(NULL != job, "Failed to pop job from job queue");
-    worker_thread_job_cleanup.job = job;
     fbk_mutex_unlock(&worker_thread_data->job_queue->lock);
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+    if(NULL == job)
+    {
+      /* Retiring while waiting for a job */
+      break;
+    }
  
     /* Process job */
-    fbk_analysis_job_context_s job_context;
-    fbk_analysis_job_result_s  job_result;
-    init_job_context(&job_context, worker_thread_data->thread_index);
-
     FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u processing job %u.", worker_thread_data->thread_index, job->job.job_id);
+    struct timespec job_start_time, job_end_time;
+    clock_gettime(CLOCK_MONOTONIC, &job_start_time);
     process_job(&job->job, &job_context, &job_result);
+    clock_gettime(CLOCK_MONOTONIC, &job_end_time);
+    const fbk_time_ms_t job_duration = ((job_end_time.tv_sec - job_start_time.tv_sec)*1000) + ((job_end_time.tv_nsec - job_start_time.tv_nsec)/1000000);
 
-    /* Disable PThread cancellation while cleaning up */
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    update_stats(&job_context, job_duration);
 
-    update_stats(job_context.nodes_evaluated);
+    /* Root stays valid while this job is active */
+    if(job_context.root != NULL)
+    {
+      publish_job_best_line(job_context.root, job->job.node, job_context.nodes_evaluated);
+    }
 
     const fbk_picker_trigger_s trigger = 
     {
@@ -590,23 +1157,39 @@ static void * worker_thread_f(void * arg)
     if(FBK_ANALYSIS_JOB_COMPLETE == job_result.result)
     {
       FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u finished job %u.", worker_thread_data->thread_index, job->job.job_id);
-      job_finished(worker_thread_data->job_queue, job);
+      job_finished(worker_thread_data->job_queue, job, job_duration);
     }
     else
     {
-      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u failed job %u with result %u.", worker_thread_data->thread_index, job->job.job_id, job_result.result);
+      /* Analysis already stored in the move tree is kept, the job is requeued to continue from it */
+      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u stopped job %u with result %u.", worker_thread_data->thread_index, job->job.job_id, job_result.result);
       job_aborted(worker_thread_data->job_queue, job);
     }
-    pthread_cleanup_pop(0);
-
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
   }
 
-  pthread_cleanup_pop(0);
+  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Worker thread %u retired.", worker_thread_data->thread_index);
 
-  FBK_NO_RETURN
   return NULL;
 }
+
+/**
+ * @brief Signals a worker thread to retire.  The worker checkpoints its active job by requeueing it and exits
+ * @param worker_thread_data worker thread to retire
+*/
+static void retire_worker_thread(fbk_worker_thread_data_s * worker_thread_data)
+{
+  FBK_ASSERT_MSG(worker_thread_data != NULL, "NULL worker thread data passed.");
+
+  /* Set under both locks so neither wait loop can miss the wake-up */
+  fbk_mutex_lock(&fbk_analysis_data.analysis_state.lock);
+  fbk_mutex_lock(&fbk_analysis_data.job_queue.lock);
+  worker_thread_data->retiring = true;
+  pthread_cond_broadcast(&fbk_analysis_data.job_queue.new_job_available);
+  pthread_cond_broadcast(&fbk_analysis_data.analysis_state.analysis_started_cond);
+  fbk_mutex_unlock(&fbk_analysis_data.job_queue.lock);
+  fbk_mutex_unlock(&fbk_analysis_data.analysis_state.lock);
+}
+
 /**
  * @brief Updates the configured number of worker threads
  * 
@@ -652,30 +1235,34 @@ void fbk_update_worker_thread_count(unsigned int count)
   }
   else if(fbk_analysis_data.fbk->config.worker_threads < fbk_analysis_data.worker_thread_count)
   {
-    /* Kill excess worker threads */
+    /* Retire excess worker threads, remaining workers continue analysis */
     for(unsigned int i = fbk_analysis_data.fbk->config.worker_threads; i < fbk_analysis_data.worker_thread_count; i++)
     {
-      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Cancelling worker thread %u.", i);
-      /* Trigger cancellation for all excess worker threads */
-      FBK_ASSERT_MSG(0 == pthread_cancel(fbk_analysis_data.worker_thread_data[i]->worker_thread),
-        "Failed to trigger cancel for worker thread %u", i);
+      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Retiring worker thread %u.", i);
+      retire_worker_thread(fbk_analysis_data.worker_thread_data[i]);
     }
     for(unsigned int i = fbk_analysis_data.fbk->config.worker_threads; i < fbk_analysis_data.worker_thread_count; i++)
     {
-      /* Wait for all excess worker threads to finish cancellation */
+      /* Wait for all excess worker threads to requeue their jobs and exit */
       FBK_ASSERT_MSG(0 == pthread_join(fbk_analysis_data.worker_thread_data[i]->worker_thread, NULL), 
                     "Failed to join worker thread %u.", i);
-      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u cancelled.", i);
+      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Worker thread %u joined.", i);
       free(fbk_analysis_data.worker_thread_data[i]);
     }
     FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Releasing memory for excess worker thread(s).");
-    fbk_analysis_data.worker_thread_data = realloc(fbk_analysis_data.worker_thread_data, sizeof(fbk_worker_thread_data_s)*fbk_analysis_data.fbk->config.worker_threads);
+    fbk_analysis_data.worker_thread_data = realloc(fbk_analysis_data.worker_thread_data, sizeof(fbk_worker_thread_data_s*)*fbk_analysis_data.fbk->config.worker_threads);
     FBK_ASSERT_MSG(fbk_analysis_data.worker_thread_data != NULL, "Realloc for %u worker threads failed.\n", fbk_analysis_data.fbk->config.worker_threads);
   }
 
   fbk_analysis_data.worker_thread_count = fbk_analysis_data.fbk->config.worker_threads;
 }
 
+void fbk_set_worker_thread_pinning(bool pin)
+{
+  FBK_DEBUG_MSG(FBK_DEBUG_MED, "%s worker thread pinning.", pin?"Enabling":"Disabling");
+  fbk_analysis_data.fbk->config.pin_worker_threads = pin;
+}
+
 void fbk_start_analysis(const ftk_game_s *game, fbk_move_tree_node_s * node)
 {
   FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
@@ -685,9 +1272,13 @@ void fbk_start_analysis(const ftk_game_s *game, fbk_move_tree_node_s * node)
 
   if(fbk_analysis_data.analysis_state.root_node != node)
   {
+    /* Keep pending jobs and re-root them so work under the new root is not lost */
     fbk_mutex_unlock(&fbk_analysis_data.analysis_state.lock);
-    fbk_stop_analysis(true);
+    fbk_stop_analysis(false);
     fbk_mutex_lock(&fbk_analysis_data.analysis_state.lock);
+    fbk_mutex_lock(&fbk_analysis_data.job_queue.lock);
+    reroot_job_queue(&fbk_analysis_data.job_queue, node, game);
+    fbk_mutex_unlock(&fbk_analysis_data.job_queue.lock);
   }
 
   if(fbk_analysis_data.analysis_state.analysis_active == false)
@@ -698,6 +1289,8 @@ void fbk_start_analysis(const ftk_game_s *game, fbk_move_tree_node_s * node)
   if(node != fbk_analysis_data.analysis_state.root_node)
   {
     fbk_analysis_data.analysis_state.root_node =  node;
+    /* Publish analysis kept from before re-rooting, workers have not resumed yet */
+    publish_root_best_line(node);
     pthread_cond_broadcast(&fbk_analysis_data.analysis_state.analysis_node_changed_cond);
   }
   fbk_analysis_data.analysis_state.game            = *game;
@@ -728,6 +1321,10 @@ bool fbk_stop_analysis(bool clear_pending_jobs)
   {
     clear_job_queue(&fbk_analysis_data.job_queue);
     fbk_analysis_data.analysis_state.root_node = NULL;
+    /* Tree may be deleted after clearing, withdraw its best line */
+    fbk_mutex_lock(&fbk_analysis_data.best_line.publish_lock);
+    swap_best_line_snapshot(&fbk_analysis_data.best_line, NULL);
+    fbk_mutex_unlock(&fbk_analysis_data.best_line.publish_lock);
   }
   fbk_mutex_unlock(&fbk_analysis_data.job_queue.lock);
   fbk_mutex_unlock(&fbk_analysis_data.analysis_state.lock);
@@ -738,25 +1335,41 @@ bool fbk_stop_analysis(bool clear_pending_jobs)
 
 fbk_node_count_t get_analyzed_nodes()
 {
-  fbk_node_count_t nodes = 0;
-  fbk_mutex_lock(&fbk_analysis_data.analysis_stats.lock);
-  nodes = fbk_analysis_data.analysis_stats.analyzed_nodes;
-  fbk_mutex_unlock(&fbk_analysis_data.analysis_stats.lock);
-  return nodes;
+  return aggregate_counter(FBK_ANALYSIS_COUNTER_NODES) - 
+         atomic_load_explicit(&fbk_analysis_data.analysis_stats.turn_nodes_baseline, memory_order_relaxed);
+}
+
+void get_analysis_stats(fbk_analysis_stats_snapshot_s *snapshot)
+{
+  FBK_ASSERT_MSG(snapshot != NULL, "NULL snapshot passed.");
+  memset(snapshot, 0, sizeof(fbk_analysis_stats_snapshot_s));
+
+  for(unsigned int i = 0; i < FBK_ANALYSIS_STATS_SHARD_COUNT; i++)
+  {
+    const fbk_analysis_stats_shard_s * shard = &fbk_analysis_data.analysis_stats.shard[i];
+    for(unsigned int j = 0; j < FBK_ANALYSIS_COUNTER_COUNT; j++)
+    {
+      snapshot->counter[j] += atomic_load_explicit(&shard->counter[j], memory_order_relaxed);
+    }
+    for(unsigned int j = 0; j < FBK_JOB_DURATION_HISTOGRAM_SIZE; j++)
+    {
+      snapshot->job_duration_histogram[j] += atomic_load_explicit(&shard->job_duration_histogram[j], memory_order_relaxed);
+    }
+  }
+
+  snapshot->total_analyzed_nodes = snapshot->counter[FBK_ANALYSIS_COUNTER_NODES];
+  snapshot->game_analyzed_nodes  = snapshot->total_analyzed_nodes - atomic_load_explicit(&fbk_analysis_data.analysis_stats.game_nodes_baseline, memory_order_relaxed);
+  snapshot->analyzed_nodes       = snapshot->total_analyzed_nodes - atomic_load_explicit(&fbk_analysis_data.analysis_stats.turn_nodes_baseline, memory_order_relaxed);
 }
 
 void reset_analyzed_nodes()
 {
-  fbk_mutex_lock(&fbk_analysis_data.analysis_stats.lock);
-  fbk_analysis_data.analysis_stats.analyzed_nodes = 0;
-  fbk_mutex_unlock(&fbk_analysis_data.analysis_stats.lock);
+  atomic_store_explicit(&fbk_analysis_data.analysis_stats.turn_nodes_baseline, aggregate_counter(FBK_ANALYSIS_COUNTER_NODES), memory_order_relaxed);
 }
 
 void reset_game_analyzed_nodes()
 {
-  fbk_mutex_lock(&fbk_analysis_data.analysis_stats.lock);
-  fbk_analysis_data.analysis_stats.analyzed_nodes = 0;
-  fbk_analysis_data.analysis_stats.game_analyzed_nodes = 0;
-  fbk_mutex_unlock(&fbk_analysis_data.analysis_stats.lock);
+  const fbk_analysis_counter_t total_nodes = aggregate_counter(FBK_ANALYSIS_COUNTER_NODES);
+  atomic_store_explicit(&fbk_analysis_data.analysis_stats.turn_nodes_baseline, total_nodes, memory_order_relaxed);
+  atomic_store_explicit(&fbk_analysis_data.analysis_stats.game_nodes_baseline, total_nodes, memory_order_relaxed);
 }
-
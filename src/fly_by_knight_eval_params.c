@@ -0,0 +1,307 @@
+/*
+ fly_by_knight_eval_params.c
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Evaluation parameters for Fly by Knight
+*/
+
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fly_by_knight_debug.h"
+#include "fly_by_knight_error.h"
+#include "fly_by_knight_eval_params.h"
+
+#ifdef FBK_RUNTIME_EVAL_PARAMS
+fbk_eval_params_s fbk_eval_params = FBK_DEFAULT_EVAL_PARAMS;
+#endif
+
+/* Maximum length of a line in a parameter file */
+#define FBK_EVAL_PARAM_LINE_SIZE 256
+
+/* Group of parameters sharing a name */
+typedef struct
+{
+  const char * name;
+  /* Offset of the group's first value in fbk_eval_params_s */
+  size_t       offset;
+  /* Number of rows and columns, scalars are 1x1 and arrays are Nx1 */
+  unsigned int rows;
+  unsigned int columns;
+  /* True for piece-square tables, indexed [piece][square] from white's perspective and mirrored for black */
+  bool         piece_square;
+} eval_param_group_s;
+
+#define EVAL_PARAM_SCALAR(field)            { #field, offsetof(fbk_eval_params_s, field), 1, 1, false }
+#define EVAL_PARAM_ARRAY(field, count)      { #field, offsetof(fbk_eval_params_s, field), count, 1, false }
+#define EVAL_PARAM_PIECE_SQUARE(field)      { #field, offsetof(fbk_eval_params_s, field), FBK_EVAL_PIECE_TYPE_COUNT, FTK_STD_BOARD_SIZE, true }
+
+static const eval_param_group_s eval_param_group[] =
+{
+  EVAL_PARAM_ARRAY(piece_value,   FBK_EVAL_PIECE_TYPE_COUNT),
+  EVAL_PARAM_ARRAY(move_value,    FBK_EVAL_PIECE_TYPE_COUNT),
+  EVAL_PARAM_ARRAY(capture_value, FBK_EVAL_PIECE_TYPE_COUNT),
+  EVAL_PARAM_ARRAY(loss_value,    FBK_EVAL_PIECE_TYPE_COUNT),
+  EVAL_PARAM_SCALAR(can_castle),
+  EVAL_PARAM_SCALAR(castled_kingside),
+  EVAL_PARAM_SCALAR(castled_queenside),
+  EVAL_PARAM_SCALAR(double_pawn_base_penalty),
+  EVAL_PARAM_SCALAR(isolated_pawn_penalty),
+  EVAL_PARAM_ARRAY(passed_pawn,   8),
+  EVAL_PARAM_PIECE_SQUARE(pst_mg),
+  EVAL_PARAM_PIECE_SQUARE(pst_eg),
+};
+#define EVAL_PARAM_GROUP_COUNT (sizeof(eval_param_group)/sizeof(eval_param_group[0]))
+
+_Static_assert(sizeof(fbk_eval_params_s) % sizeof(fbk_score_t) == 0, "Evaluation parameters must only contain scores.");
+
+/**
+ * @brief Finds the group of a parameter
+ *
+ * @param index parameter index, replaced with index within the group
+ * @return group of parameter
+ */
+static const eval_param_group_s * find_eval_param_group(unsigned int * index)
+{
+  const eval_param_group_s * ret_val = NULL;
+
+  for(unsigned int i = 0; (i < EVAL_PARAM_GROUP_COUNT) && (NULL == ret_val); i++)
+  {
+    const unsigned int count = eval_param_group[i].rows * eval_param_group[i].columns;
+    if(*index < count)
+    {
+      ret_val = &eval_param_group[i];
+    }
+    else
+    {
+      *index -= count;
+    }
+  }
+
+  FBK_ASSERT_MSG(ret_val != NULL, "Invalid evaluation parameter.");
+
+  return ret_val;
+}
+
+/**
+ * @brief Returns the stored value of a parameter (white's value for piece-square parameters)
+ */
+static fbk_score_t * eval_param_value(fbk_eval_params_s * params, const eval_param_group_s * group, unsigned int group_index)
+{
+  fbk_score_t * values = (fbk_score_t *) (((char *) params) + group->offset);
+
+  if(group->piece_square)
+  {
+    /* Skip black's table of each earlier piece */
+    const unsigned int piece = group_index / FTK_STD_BOARD_SIZE;
+    group_index += piece * (FBK_EVAL_COLOR_COUNT-1) * FTK_STD_BOARD_SIZE;
+  }
+
+  return &values[group_index];
+}
+
+unsigned int fbk_eval_param_count()
+{
+  unsigned int count = 0;
+
+  for(unsigned int i = 0; i < EVAL_PARAM_GROUP_COUNT; i++)
+  {
+    count += eval_param_group[i].rows * eval_param_group[i].columns;
+  }
+
+  return count;
+}
+
+void fbk_eval_param_name(unsigned int index, char name[FBK_EVAL_PARAM_NAME_SIZE])
+{
+  const eval_param_group_s * group = find_eval_param_group(&index);
+
+  if(group->columns > 1)
+  {
+    snprintf(name, FBK_EVAL_PARAM_NAME_SIZE, "%s[%u][%u]", group->name, index / group->columns, index % group->columns);
+  }
+  else if(group->rows > 1)
+  {
+    snprintf(name, FBK_EVAL_PARAM_NAME_SIZE, "%s[%u]", group->name, index);
+  }
+  else
+  {
+    snprintf(name, FBK_EVAL_PARAM_NAME_SIZE, "%s", group->name);
+  }
+}
+
+bool fbk_find_eval_param(const char * name, unsigned int * index)
+{
+  FBK_ASSERT_MSG(name != NULL,  "NULL name passed.");
+  FBK_ASSERT_MSG(index != NULL, "NULL index passed.");
+
+  bool ret_val = false;
+  const unsigned int count = fbk_eval_param_count();
+  char param_name[FBK_EVAL_PARAM_NAME_SIZE];
+
+  for(unsigned int i = 0; (i < count) && !ret_val; i++)
+  {
+    fbk_eval_param_name(i, param_name);
+    if(strcmp(param_name, name) == 0)
+    {
+      *index  = i;
+      ret_val = true;
+    }
+  }
+
+  return ret_val;
+}
+
+fbk_score_t fbk_get_eval_param(const fbk_eval_params_s * params, unsigned int index)
+{
+  FBK_ASSERT_MSG(params != NULL, "NULL parameters passed.");
+
+  const eval_param_group_s * group = find_eval_param_group(&index);
+
+  return *eval_param_value((fbk_eval_params_s *) params, group, index);
+}
+
+void fbk_set_eval_param(fbk_eval_params_s * params, unsigned int index, fbk_score_t value)
+{
+  FBK_ASSERT_MSG(params != NULL, "NULL parameters passed.");
+
+  const eval_param_group_s * group = find_eval_param_group(&index);
+  fbk_score_t * white_value = eval_param_value(params, group, index);
+
+  *white_value = value;
+
+  if(group->piece_square)
+  {
+    /* Black's table follows white's, mirrored across the board's horizontal center */
+    const unsigned int square = index % FTK_STD_BOARD_SIZE;
+    white_value[FTK_STD_BOARD_SIZE + (square ^ 56) - square] = value;
+  }
+}
+
+bool fbk_parse_eval_param(fbk_eval_params_s * params, const char * assignment)
+{
+  bool ret_val = false;
+  char name[FBK_EVAL_PARAM_NAME_SIZE];
+  size_t name_length = 0;
+
+  FBK_ASSERT_MSG(params != NULL,     "NULL parameters passed.");
+  FBK_ASSERT_MSG(assignment != NULL, "NULL assignment passed.");
+
+  while(isspace((unsigned char) *assignment))
+  {
+    assignment++;
+  }
+  while((assignment[name_length] != '\0') && (assignment[name_length] != '=') && !isspace((unsigned char) assignment[name_length]))
+  {
+    name_length++;
+  }
+
+  if((name_length > 0) && (name_length < FBK_EVAL_PARAM_NAME_SIZE))
+  {
+    unsigned int index;
+    memcpy(name, assignment, name_length);
+    name[name_length] = '\0';
+
+    /* Value follows '=' or whitespace */
+    const char * value_string = &assignment[name_length];
+    while(isspace((unsigned char) *value_string) || ('=' == *value_string))
+    {
+      value_string++;
+    }
+
+    char * end;
+    errno = 0;
+    const long long value = strtoll(value_string, &end, 10);
+    while(isspace((unsigned char) *end))
+    {
+      end++;
+    }
+
+    if(!fbk_find_eval_param(name, &index))
+    {
+      FBK_ERROR_MSG("Unknown evaluation parameter '%s'.", name);
+    }
+    else if((end == value_string) || (*end != '\0') || (errno != 0))
+    {
+      FBK_ERROR_MSG("Invalid value for evaluation parameter '%s'.", name);
+    }
+    else
+    {
+      FBK_DEBUG_MSG(FBK_DEBUG_MED, "Setting evaluation parameter %s to %lld", name, value);
+      fbk_set_eval_param(params, index, (fbk_score_t) value);
+      ret_val = true;
+    }
+  }
+  else
+  {
+    FBK_ERROR_MSG("Invalid evaluation parameter assignment '%s'.", assignment);
+  }
+
+  return ret_val;
+}
+
+bool fbk_load_eval_params(fbk_eval_params_s * params, const char * path)
+{
+  bool ret_val = true;
+  char line[FBK_EVAL_PARAM_LINE_SIZE];
+  unsigned int line_number = 0;
+
+  FBK_ASSERT_MSG(params != NULL, "NULL parameters passed.");
+  FBK_ASSERT_MSG(path != NULL,   "NULL path passed.");
+
+  FILE * file = fopen(path, "r");
+  if(NULL == file)
+  {
+    FBK_ERROR_MSG("Failed to open evaluation parameters %s (errno %d)", path, errno);
+    ret_val = false;
+  }
+
+  while((file != NULL) && (fgets(line, sizeof(line), file) != NULL))
+  {
+    line_number++;
+
+    const char * content = line;
+    while(isspace((unsigned char) *content))
+    {
+      content++;
+    }
+
+    if(('\0' != *content) && ('#' != *content))
+    {
+      if(!fbk_parse_eval_param(params, content))
+      {
+        FBK_ERROR_MSG("Failed to apply %s line %u.", path, line_number);
+        ret_val = false;
+      }
+    }
+  }
+
+  if(file != NULL)
+  {
+    fclose(file);
+    FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Loaded evaluation parameters from %s", path);
+  }
+
+  return ret_val;
+}
+
+void fbk_write_eval_params(const fbk_eval_params_s * params, FILE * stream)
+{
+  const unsigned int count = fbk_eval_param_count();
+  char name[FBK_EVAL_PARAM_NAME_SIZE];
+
+  FBK_ASSERT_MSG(params != NULL, "NULL parameters passed.");
+  FBK_ASSERT_MSG(stream != NULL, "NULL stream passed.");
+
+  for(unsigned int i = 0; i < count; i++)
+  {
+    fbk_eval_param_name(i, name);
+    fprintf(stream, "%s %lld\n", name, (long long) fbk_get_eval_param(params, i));
+  }
+}
@@ -7,10 +7,15 @@
  Hashing logic for Fly by Knight
 */
 
+#include <string.h>
+
+#include <farewell_to_king.h>
+
 #include "fly_by_knight.h"
 #include "fly_by_knight_debug.h"
 #include "fly_by_knight_error.h"
 #include "fly_by_knight_hash.h"
+#include "fly_by_knight_move_tree.h"
 
 static const ftk_zobrist_hash_config_s hash_config = 
 {
@@ -69,6 +74,149 @@ static const ftk_zobrist_hash_config_s hash_config =
   }
 };
 
+/* Key layout within hash_config.random, following the Polyglot book format: 12 piece types by square, 4 castling 
+   rights, 8 en passant files and the side to move */
+#define HASH_PIECE_INDEX(type, color, square) ((((((type)-FTK_TYPE_PAWN)*2) + ((FTK_COLOR_WHITE == (color))?0:1)) * FTK_STD_BOARD_SIZE) + (square))
+#define HASH_CASTLE_INDEX                     (12*FTK_STD_BOARD_SIZE)
+#define HASH_EN_PASSANT_INDEX                 (HASH_CASTLE_INDEX+4)
+#define HASH_TURN_INDEX                       (HASH_EN_PASSANT_INDEX+8)
+
+/**
+ * @brief Returns key of the piece on a square, 0 if empty
+ */
+static inline ftk_zobrist_hash_key_t hash_square(const ftk_board_s * board, ftk_square_e square)
+{
+  const ftk_square_s * contents = &board->square[square];
+
+  return (FTK_TYPE_EMPTY == contents->type)?0:hash_config.random[HASH_PIECE_INDEX(contents->type, contents->color, square)];
+}
+
+/**
+ * @brief Returns true if given unmoved piece is on square
+ */
+static inline bool unmoved_piece_on_square(const ftk_board_s * board, ftk_square_e square, ftk_type_e type, ftk_color_e color)
+{
+  const ftk_square_s * contents = &board->square[square];
+
+  return (type == contents->type) && (color == contents->color) && (FTK_MOVED_NOT_MOVED == contents->moved);
+}
+
+/* Castling rights bits, in order of their keys */
+#define CASTLE_WHITE_KINGSIDE  0x1
+#define CASTLE_WHITE_QUEENSIDE 0x2
+#define CASTLE_BLACK_KINGSIDE  0x4
+#define CASTLE_BLACK_QUEENSIDE 0x8
+#define CASTLE_WHITE           (CASTLE_WHITE_KINGSIDE|CASTLE_WHITE_QUEENSIDE)
+#define CASTLE_BLACK           (CASTLE_BLACK_KINGSIDE|CASTLE_BLACK_QUEENSIDE)
+
+/**
+ * @brief Returns castling rights, derived from kings and rooks which have not moved
+ */
+static unsigned int castle_rights(const ftk_board_s * board)
+{
+  unsigned int rights = 0;
+
+  if(unmoved_piece_on_square(board, FTK_E1, FTK_TYPE_KING, FTK_COLOR_WHITE))
+  {
+    rights |= unmoved_piece_on_square(board, FTK_H1, FTK_TYPE_ROOK, FTK_COLOR_WHITE)?CASTLE_WHITE_KINGSIDE:0;
+    rights |= unmoved_piece_on_square(board, FTK_A1, FTK_TYPE_ROOK, FTK_COLOR_WHITE)?CASTLE_WHITE_QUEENSIDE:0;
+  }
+  if(unmoved_piece_on_square(board, FTK_E8, FTK_TYPE_KING, FTK_COLOR_BLACK))
+  {
+    rights |= unmoved_piece_on_square(board, FTK_H8, FTK_TYPE_ROOK, FTK_COLOR_BLACK)?CASTLE_BLACK_KINGSIDE:0;
+    rights |= unmoved_piece_on_square(board, FTK_A8, FTK_TYPE_ROOK, FTK_COLOR_BLACK)?CASTLE_BLACK_QUEENSIDE:0;
+  }
+
+  return rights;
+}
+
+/**
+ * @brief Returns key of castling rights
+ */
+static ftk_zobrist_hash_key_t hash_castle_rights(const ftk_board_s * board)
+{
+  ftk_zobrist_hash_key_t key    = 0;
+  const unsigned int     rights = castle_rights(board);
+
+  for(unsigned int i = 0; i < 4; i++)
+  {
+    key ^= (rights & (1u << i))?hash_config.random[HASH_CASTLE_INDEX+i]:0;
+  }
+
+  return key;
+}
+
+/**
+ * @brief Returns key of the en passant file, only set when the last move was a double pawn push beside an opponent's 
+ *        pawn so positions without a possible en passant capture share keys
+ */
+static ftk_zobrist_hash_key_t hash_en_passant(const ftk_board_s * board, const ftk_move_s * last_move)
+{
+  ftk_zobrist_hash_key_t key = 0;
+
+  if((last_move != NULL) && FTK_MOVE_VALID(*last_move) && (FTK_TYPE_PAWN == board->square[last_move->target].type) &&
+     ((last_move->target == (last_move->source + 16)) || (last_move->source == (last_move->target + 16))))
+  {
+    const ftk_color_e  pawn_color = board->square[last_move->target].color;
+    const unsigned int file       = last_move->target % 8;
+    bool               capturable = false;
+
+    if(file > 0)
+    {
+      const ftk_square_s * beside = &board->square[last_move->target - 1];
+      capturable |= (FTK_TYPE_PAWN == beside->type) && (pawn_color != beside->color);
+    }
+    if(file < 7)
+    {
+      const ftk_square_s * beside = &board->square[last_move->target + 1];
+      capturable |= (FTK_TYPE_PAWN == beside->type) && (pawn_color != beside->color);
+    }
+
+    if(capturable)
+    {
+      key = hash_config.random[HASH_EN_PASSANT_INDEX + file];
+    }
+  }
+
+  return key;
+}
+
+/**
+ * @brief Returns key of the side to move
+ */
+static inline ftk_zobrist_hash_key_t hash_turn(ftk_color_e turn)
+{
+  return (FTK_COLOR_WHITE == turn)?0:hash_config.random[HASH_TURN_INDEX];
+}
+
+ftk_zobrist_hash_key_t fbk_hash_game(const ftk_game_s * game, const ftk_move_s * last_move)
+{
+  ftk_zobrist_hash_key_t key = 0;
+
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+
+  for(unsigned int square = 0; square < FTK_STD_BOARD_SIZE; square++)
+  {
+    key ^= hash_square(&game->board, square);
+  }
+
+  return key ^ hash_castle_rights(&game->board) ^ hash_en_passant(&game->board, last_move) ^ hash_turn(game->turn);
+}
+
+ftk_zobrist_hash_key_t fbk_hash_move_terms(const ftk_game_s * game, const ftk_square_e squares[], unsigned int count, const ftk_move_s * last_move)
+{
+  ftk_zobrist_hash_key_t key = 0;
+
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+
+  for(unsigned int i = 0; i < count; i++)
+  {
+    key ^= hash_square(&game->board, squares[i]);
+  }
+
+  return key ^ hash_castle_rights(&game->board) ^ hash_en_passant(&game->board, last_move) ^ hash_turn(game->turn);
+}
+
 bool fbk_hash_move_tree_node(fbk_move_tree_node_s * node, const ftk_game_s * game, bool locked)
 {
   bool ret_val = false;
@@ -80,7 +228,7 @@ bool fbk_hash_move_tree_node(fbk_move_tree_node_s * node, const ftk_game_s * gam
 
   if(false == node->hashed)
   {
-    node->key = ftk_hash_game_zobrist(game, &hash_config);
+    node->key = fbk_hash_game(game, FTK_MOVE_VALID(node->move)?&node->move:NULL);
     node->hashed = true;
     ret_val = true;
   }
@@ -91,4 +239,155 @@ bool fbk_hash_move_tree_node(fbk_move_tree_node_s * node, const ftk_game_s * gam
   }
 
   return ret_val;
-}
\ No newline at end of file
+}
+ftk_zobrist_hash_key_t fbk_pawn_hash_square_key(ftk_color_e color, ftk_square_e square)
+{
+  /* Reuse the position hash's random numbers, pawn keys are only compared against other pawn keys */
+  return hash_config.random[((FTK_COLOR_WHITE == color)?0:FTK_STD_BOARD_SIZE) + square];
+}
+
+ftk_zobrist_hash_key_t fbk_pawn_hash_key(ftk_board_mask_t white_pawns, ftk_board_mask_t black_pawns)
+{
+  ftk_zobrist_hash_key_t key = 0;
+
+  while(white_pawns)
+  {
+    const ftk_square_e square = ftk_get_first_set_bit_idx(white_pawns);
+    FTK_CLEAR_BIT(white_pawns, square);
+    key ^= fbk_pawn_hash_square_key(FTK_COLOR_WHITE, square);
+  }
+  while(black_pawns)
+  {
+    const ftk_square_e square = ftk_get_first_set_bit_idx(black_pawns);
+    FTK_CLEAR_BIT(black_pawns, square);
+    key ^= fbk_pawn_hash_square_key(FTK_COLOR_BLACK, square);
+  }
+
+  return key;
+}
+
+bool fbk_irreversible_move(const ftk_board_s * board, const ftk_move_s * move)
+{
+  FBK_ASSERT_MSG(board != NULL, "NULL board passed.");
+  FBK_ASSERT_MSG(move != NULL,  "NULL move passed.");
+
+  const ftk_square_s * moving  = &board->square[move->source];
+  bool                 ret_val = (FTK_TYPE_PAWN == moving->type) || (FTK_TYPE_EMPTY != board->square[move->target].type);
+
+  if(!ret_val && (FTK_MOVED_NOT_MOVED == moving->moved))
+  {
+    /* First move of a king or rook may lose castling rights */
+    const unsigned int rights = castle_rights(board);
+    if(FTK_TYPE_KING == moving->type)
+    {
+      ret_val = (rights & ((FTK_COLOR_WHITE == moving->color)?CASTLE_WHITE:CASTLE_BLACK)) != 0;
+    }
+    else if(FTK_TYPE_ROOK == moving->type)
+    {
+      ret_val = ((FTK_H1 == move->source) && (rights & CASTLE_WHITE_KINGSIDE))  ||
+                ((FTK_A1 == move->source) && (rights & CASTLE_WHITE_QUEENSIDE)) ||
+                ((FTK_H8 == move->source) && (rights & CASTLE_BLACK_KINGSIDE))  ||
+                ((FTK_A8 == move->source) && (rights & CASTLE_BLACK_QUEENSIDE));
+    }
+  }
+
+  return ret_val;
+}
+
+_Static_assert(0 == (FBK_KEY_HISTORY_SIZE & (FBK_KEY_HISTORY_SIZE-1)), "Key history ring buffer size must be a power of 2.");
+
+void fbk_init_key_history(fbk_key_history_s * history)
+{
+  FBK_ASSERT_MSG(history != NULL, "NULL key history passed.");
+
+  history->head  = 0;
+  history->count = 0;
+  memset(history->set, 0, sizeof(history->set));
+}
+
+void fbk_init_key_history_from_tree(fbk_key_history_s * history, const fbk_move_tree_node_s * node, const ftk_game_s * game)
+{
+  /* Keep room for the search path */
+  ftk_zobrist_hash_key_t keys[FBK_KEY_HISTORY_SIZE/2];
+  unsigned int           count    = 0;
+  ftk_game_s             position = *game;
+
+  FBK_ASSERT_MSG(node != NULL, "NULL node passed.");
+  FBK_ASSERT_MSG(game != NULL, "NULL game passed.");
+
+  fbk_init_key_history(history);
+
+  /* Walk back to the last irreversible move, earlier positions cannot repeat */
+  while((count < (sizeof(keys)/sizeof(keys[0]))) && (node->parent != NULL) && FTK_MOVE_VALID(node->move))
+  {
+    FBK_ASSERT_MSG(fbk_undo_game_move(&node->move, &position, NULL), "Failed to undo move for key history.");
+    if(fbk_irreversible_move(&position.board, &node->move))
+    {
+      break;
+    }
+
+    node = node->parent;
+    FBK_ASSERT_MSG(node->hashed, "Ancestor node not hashed for key history.");
+    keys[count++] = node->key;
+  }
+
+  while(count > 0)
+  {
+    fbk_push_key_history(history, keys[--count], false);
+  }
+}
+
+void fbk_push_key_history(fbk_key_history_s * history, ftk_zobrist_hash_key_t key, bool irreversible)
+{
+  FBK_ASSERT_MSG(history != NULL, "NULL key history passed.");
+
+  const unsigned int index = (history->head + history->count) & (FBK_KEY_HISTORY_SIZE-1);
+
+  if(FBK_KEY_HISTORY_SIZE == history->count)
+  {
+    /* Overwrite oldest position */
+    history->set[history->key[index] & (FBK_KEY_HISTORY_SET_SIZE-1)]--;
+    history->head = (history->head + 1) & (FBK_KEY_HISTORY_SIZE-1);
+    history->count--;
+  }
+
+  history->key[index]          = key;
+  history->irreversible[index] = irreversible;
+  history->set[key & (FBK_KEY_HISTORY_SET_SIZE-1)]++;
+  history->count++;
+}
+
+void fbk_pop_key_history(fbk_key_history_s * history)
+{
+  FBK_ASSERT_MSG(history != NULL, "NULL key history passed.");
+  FBK_ASSERT_MSG(history->count > 0, "Popping empty key history.");
+
+  history->count--;
+  history->set[history->key[(history->head + history->count) & (FBK_KEY_HISTORY_SIZE-1)] & (FBK_KEY_HISTORY_SET_SIZE-1)]--;
+}
+
+unsigned int fbk_key_history_count(const fbk_key_history_s * history, ftk_zobrist_hash_key_t key)
+{
+  unsigned int count = 0;
+
+  FBK_ASSERT_MSG(history != NULL, "NULL key history passed.");
+
+  if(history->set[key & (FBK_KEY_HISTORY_SET_SIZE-1)] > 0)
+  {
+    for(unsigned int i = history->count; i > 0; i--)
+    {
+      const unsigned int index = (history->head + i - 1) & (FBK_KEY_HISTORY_SIZE-1);
+
+      if(history->key[index] == key)
+      {
+        count++;
+      }
+      if(history->irreversible[index])
+      {
+        break;
+      }
+    }
+  }
+
+  return count;
+}
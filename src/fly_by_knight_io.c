@@ -12,15 +12,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
 
 #include <farewell_to_king.h>
 #include <farewell_to_king_board.h>
 #include <farewell_to_king_types.h>
 #include <farewell_to_king_strings.h>
 
+#include "fly_by_knight_analysis.h"
+#include "fly_by_knight_analysis_simd.h"
+#include "fly_by_knight_analysis_worker.h"
 #include "fly_by_knight_debug.h"
 #include "fly_by_knight_error.h"
 #include "fly_by_knight_io.h"
+#include "fly_by_knight_nnue.h"
 #include "fly_by_knight_types.h"
 #include "fly_by_knight_version.h"
 
@@ -31,9 +36,15 @@
 #include "fly_by_knight_xboard.h"
 #endif
 
+/* Initial input buffer size, grown to fit longer lines such as UCI positions late in a game */
 #define FBK_INPUT_BUFFER_SIZE  1024
 #define FBK_OUTPUT_BUFFER_SIZE 1024
 
+/* Positions checked by 'verify eval' when no count is given */
+#define FBK_VERIFY_EVALUATION_DEFAULT_POSITIONS 1000
+/* Evaluations timed by 'bench eval' when no count is given */
+#define FBK_BENCH_EVALUATION_DEFAULT_COUNT 1000000
+
 //Logging file if enabled
 bool fbk_log_file_configured = false;
 FILE *fbk_log_file = NULL;
@@ -95,23 +106,24 @@ void *fly_by_knight_io_thread(void *fbk_instance)
   fbk_instance_s *fbk = (fbk_instance_s *) fbk_instance;
 
   bool input_handled;
-  void * fgets_result;
-  char input_buffer[FBK_INPUT_BUFFER_SIZE];
-  char output_buffer[FBK_INPUT_BUFFER_SIZE];
+  ssize_t read_length;
+  size_t input_buffer_size = FBK_INPUT_BUFFER_SIZE;
+  char * input_buffer = malloc(input_buffer_size);
+  char output_buffer[FBK_OUTPUT_BUFFER_SIZE];
   size_t str_length;
 
   FBK_ASSERT_MSG(fbk != NULL, "NULL fbk_instance pointer passed.");
+  FBK_ASSERT_MSG(input_buffer != NULL, "Failed to allocate input buffer.");
 
   while(true)
   {
     // Flush pending output
     fflush(stdout);
 
-    // Read from stdin
-    memset(input_buffer, 0, sizeof(input_buffer));
-    fgets_result = fgets(input_buffer, FBK_INPUT_BUFFER_SIZE, stdin);
+    // Read a whole line from stdin, growing the buffer as needed
+    read_length = getline(&input_buffer, &input_buffer_size, stdin);
 
-    if(fgets_result != input_buffer)
+    if(read_length < 0)
     {
       if(feof(stdin))
       {
@@ -129,7 +141,7 @@ void *fly_by_knight_io_thread(void *fbk_instance)
     str_length = strlen(input_buffer);
     if(str_length > 0)
     {
-      FBK_ASSERT_MSG(str_length < FBK_INPUT_BUFFER_SIZE, "Invalid string");
+      FBK_ASSERT_MSG(str_length < input_buffer_size, "Invalid string");
 
       if('\n' == input_buffer[str_length-1])
       {
@@ -155,20 +167,117 @@ void *fly_by_knight_io_thread(void *fbk_instance)
       ftk_game_to_fen_string(&fbk->game, output_buffer);
       FBK_OUTPUT_MSG("%s\n", output_buffer);
     }
+    else if(strcmp("print stats", input_buffer) == 0)
+    {
+      fbk_analysis_stats_snapshot_s stats;
+      get_analysis_stats(&stats);
+      FBK_OUTPUT_MSG("# Analyzed nodes: %lu (turn), %lu (game), %lu (total)\n", stats.analyzed_nodes, stats.game_analyzed_nodes, stats.total_analyzed_nodes);
+      FBK_OUTPUT_MSG("# Compressions: %lu\n", stats.counter[FBK_ANALYSIS_COUNTER_COMPRESSIONS]);
+      FBK_OUTPUT_MSG("# Job claim collisions: %lu\n", stats.counter[FBK_ANALYSIS_COUNTER_CLAIM_COLLISIONS]);
+      FBK_OUTPUT_MSG("# Diverted jobs: %lu\n", stats.counter[FBK_ANALYSIS_COUNTER_DIVERTED_JOBS]);
+      const fbk_analysis_counter_t pawn_hash_lookups = stats.counter[FBK_ANALYSIS_COUNTER_PAWN_HASH_HITS] + stats.counter[FBK_ANALYSIS_COUNTER_PAWN_HASH_MISSES];
+      FBK_OUTPUT_MSG("# Pawn hash: %lu hits, %lu misses (%.1f%% hit rate)\n", stats.counter[FBK_ANALYSIS_COUNTER_PAWN_HASH_HITS], stats.counter[FBK_ANALYSIS_COUNTER_PAWN_HASH_MISSES],
+                     (pawn_hash_lookups > 0)?((100.0*stats.counter[FBK_ANALYSIS_COUNTER_PAWN_HASH_HITS])/pawn_hash_lookups):0.0);
+      const fbk_analysis_counter_t eval_cache_lookups = stats.counter[FBK_ANALYSIS_COUNTER_EVAL_CACHE_HITS] + stats.counter[FBK_ANALYSIS_COUNTER_EVAL_CACHE_MISSES];
+      FBK_OUTPUT_MSG("# Evaluation cache: %lu hits, %lu misses (%.1f%% hit rate)\n", stats.counter[FBK_ANALYSIS_COUNTER_EVAL_CACHE_HITS], stats.counter[FBK_ANALYSIS_COUNTER_EVAL_CACHE_MISSES],
+                     (eval_cache_lookups > 0)?((100.0*stats.counter[FBK_ANALYSIS_COUNTER_EVAL_CACHE_HITS])/eval_cache_lookups):0.0);
+      fbk_mutex_lock(&fbk->game_lock);
+      const unsigned int  ponder_hits        = fbk->ponder.hits;
+      const unsigned int  ponder_predictions = fbk->ponder.predictions;
+      const unsigned int  easy_moves         = fbk->time_control.easy_moves;
+      const fbk_time_ms_t saved_time         = fbk->time_control.saved_time;
+      const fbk_time_ms_t banked_time        = fbk->time_control.banked_time;
+      fbk_mutex_unlock(&fbk->game_lock);
+      FBK_OUTPUT_MSG("# Easy moves: %u (%ldms saved this game, %ldms not yet budgeted)\n", easy_moves, (long) saved_time, (long) banked_time);
+      FBK_OUTPUT_MSG("# Ponder: %u hits of %u predictions (%.1f%% hit rate)\n", ponder_hits, ponder_predictions,
+                     (ponder_predictions > 0)?((100.0*ponder_hits)/ponder_predictions):0.0);
+      FBK_OUTPUT_MSG("# Job duration histogram (ms):\n");
+      for(unsigned int i = 0; i < FBK_JOB_DURATION_HISTOGRAM_SIZE; i++)
+      {
+        if(0 == i)
+        {
+          FBK_OUTPUT_MSG("#  [0, 1): %lu\n", stats.job_duration_histogram[i]);
+        }
+        else if(i < (FBK_JOB_DURATION_HISTOGRAM_SIZE-1))
+        {
+          FBK_OUTPUT_MSG("#  [%u, %u): %lu\n", (1u<<(i-1)), (1u<<i), stats.job_duration_histogram[i]);
+        }
+        else
+        {
+          FBK_OUTPUT_MSG("#  [%u, inf): %lu\n", (1u<<(i-1)), stats.job_duration_histogram[i]);
+        }
+      }
+    }
+    else if(strncmp("verify eval", input_buffer, 11) == 0)
+    {
+      /* Optional number of positions, e.g. "verify eval 10000" */
+      const long position_count = (strlen(input_buffer) > 12)?strtol(&input_buffer[12], NULL, 10):FBK_VERIFY_EVALUATION_DEFAULT_POSITIONS;
+      if(position_count > 0)
+      {
+        fbk_mutex_lock(&fbk->game_lock);
+        const ftk_game_s game = fbk->game;
+        fbk_mutex_unlock(&fbk->game_lock);
+        const unsigned int mismatches = fbk_verify_evaluation(&game, position_count);
+        FBK_OUTPUT_MSG("# Verified evaluation (%s kernels) on %ld positions, %u mismatches\n", 
+                       fbk_simd_level_string(fbk_get_simd_kernels()->level), position_count, mismatches);
+      }
+      else
+      {
+        input_handled = false;
+      }
+    }
+    else if(strncmp("bench eval", input_buffer, 10) == 0)
+    {
+      /* Optional number of evaluations, e.g. "bench eval 10000000" */
+      const long eval_count = (strlen(input_buffer) > 11)?strtol(&input_buffer[11], NULL, 10):FBK_BENCH_EVALUATION_DEFAULT_COUNT;
+      if(eval_count > 0)
+      {
+        fbk_mutex_lock(&fbk->game_lock);
+        const ftk_game_s game = fbk->game;
+        fbk_mutex_unlock(&fbk->game_lock);
+        FBK_OUTPUT_MSG("# Evaluation benchmark (%s kernels), %ld evaluations\n", fbk_simd_level_string(fbk_get_simd_kernels()->level), eval_count);
+        FBK_OUTPUT_MSG("#  classical: %.0f evals/s\n", fbk_bench_evaluation(&game, eval_count, false));
+        if(fbk_nnue_network_loaded())
+        {
+          FBK_OUTPUT_MSG("#  neural network: %.0f evals/s\n", fbk_bench_evaluation(&game, eval_count, true));
+        }
+        else
+        {
+          FBK_OUTPUT_MSG("#  neural network: not loaded\n");
+        }
+      }
+      else
+      {
+        input_handled = false;
+      }
+    }
+    else if(strncmp("evaluator", input_buffer, 9) == 0)
+    {
+      if(strcmp("evaluator nnue", input_buffer) == 0)
+      {
+        fbk_set_evaluator(fbk, true);
+      }
+      else if(strcmp("evaluator classic", input_buffer) == 0)
+      {
+        fbk_set_evaluator(fbk, false);
+      }
+      else if(strcmp("evaluator", input_buffer) != 0)
+      {
+        input_handled = false;
+      }
+
+      if(input_handled)
+      {
+        FBK_OUTPUT_MSG("# Evaluating with %s evaluation\n", fbk_nnue_enabled()?"neural network":"classical");
+      }
+    }
     else if(FBK_PROTOCOL_UNDEFINED == fbk->protocol)
     {
       if(strcmp("uci", input_buffer) == 0)
       {
         #ifdef FBK_UCI_PROTOCOL_SUPPORT
-        FBK_OUTPUT_MSG("info string The UCI communication protocol not fully supported yet, please prefer the xboard communication protocol.\n");
-
-        fbk->protocol = FBK_PROTOCOL_UCI;
-
         /* Acknowledge UCI mode */
-        FBK_OUTPUT_MSG("id name " FLY_BY_KNIGHT_NAME_VER "\n"
-                       "id author " FLY_BY_KNIGHT_AUTHOR "\n"
-                       /* TODO specify options */
-                       "uciok\n");
+        fbk_init_uci_protocol(fbk);
         #else
         FBK_OUTPUT_MSG("The uci communication protocol is not supported.\n");
         fbk_exit(1);
@@ -211,6 +320,7 @@ void *fly_by_knight_io_thread(void *fbk_instance)
     }
   }
 
+  free(input_buffer);
   fbk_exit(0);
 
   FBK_NO_RETURN
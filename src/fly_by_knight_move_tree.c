@@ -66,24 +66,81 @@ void fbk_delete_move_tree_node(fbk_move_tree_node_s * node)
 /**
  * @brief Applies move to given game
  * 
- * @param node Node to apply
- * @param game Game to modify with move tree node
+ * @param move Move to apply
+ * @param game Game to modify with move
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
+ */
+bool fbk_apply_game_move(const ftk_move_s * move, ftk_game_s * game, fbk_incremental_eval_s * eval)
+{
+  ftk_result_e result;
+
+  FBK_ASSERT_MSG(move != NULL, "Null move passed");
+  FBK_ASSERT_MSG(game != NULL, "Null game passed");
+
+  if(eval != NULL)
+  {
+    ftk_square_e squares[FBK_INCREMENTAL_EVAL_MAX_MOVE_SQUARES];
+    const unsigned int square_count = fbk_incremental_eval_move_squares(&game->board, move, false, squares);
+    fbk_update_incremental_eval(eval, &game->board, squares, square_count, -1);
+    result = ftk_move_forward_quick(game, move);
+    fbk_update_incremental_eval(eval, &game->board, squares, square_count, 1);
+  }
+  else
+  {
+    result = ftk_move_forward_quick(game, move);
+  }
+
+  return (FTK_SUCCESS == result);
+}
+
+/**
+ * @brief Reverts move from given game
+ * 
+ * @param move Move to undo
+ * @param game Game to modify with move
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
  */
-bool fbk_apply_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game)
+bool fbk_undo_game_move(const ftk_move_s * move, ftk_game_s * game, fbk_incremental_eval_s * eval)
 {
   ftk_result_e result;
-  ftk_move_s   move;
 
+  FBK_ASSERT_MSG(move != NULL, "Null move passed");
   FBK_ASSERT_MSG(game != NULL, "Null game passed");
+
+  if(eval != NULL)
+  {
+    ftk_square_e squares[FBK_INCREMENTAL_EVAL_MAX_MOVE_SQUARES];
+    const unsigned int square_count = fbk_incremental_eval_move_squares(&game->board, move, true, squares);
+    fbk_update_incremental_eval(eval, &game->board, squares, square_count, -1);
+    result = ftk_move_backward_quick(game, move);
+    fbk_update_incremental_eval(eval, &game->board, squares, square_count, 1);
+  }
+  else
+  {
+    result = ftk_move_backward_quick(game, move);
+  }
+
+  return (FTK_SUCCESS == result);
+}
+
+/**
+ * @brief Applies move to given game
+ * 
+ * @param node Node to apply
+ * @param game Game to modify with move tree node
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
+ */
+bool fbk_apply_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, fbk_incremental_eval_s * eval)
+{
+  ftk_move_s move;
+
   FBK_ASSERT_MSG(node != NULL, "Null node passed");
 
   FBK_ASSERT_MSG(true == fbk_mutex_lock(&node->lock), "Failed to lock node mutex");
   move = node->move;
   FBK_ASSERT_MSG(true == fbk_mutex_unlock(&node->lock), "Failed to unlock node mutex");
 
-  result = ftk_move_forward_quick(game, &move);
-
-  return (FTK_SUCCESS == result);
+  return fbk_apply_game_move(&move, game, eval);
 }
 
 /**
@@ -91,26 +148,23 @@ bool fbk_apply_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game)
  * 
  * @param node Node to undo
  * @param game Game to modify with move tree node
+ * @param eval Incremental evaluation to update with the move, NULL if not tracked
  */
-bool fbk_undo_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game)
+bool fbk_undo_move_tree_node(fbk_move_tree_node_s * node, ftk_game_s * game, fbk_incremental_eval_s * eval)
 {
-  ftk_result_e result;
-  ftk_move_s   move;
+  ftk_move_s move;
 
-  FBK_ASSERT_MSG(game != NULL, "Null game passed");
   FBK_ASSERT_MSG(node != NULL, "Null node passed");
 
   FBK_ASSERT_MSG(true == fbk_mutex_lock(&node->lock), "Failed to lock node mutex");
   move = node->move;
   FBK_ASSERT_MSG(true == fbk_mutex_unlock(&node->lock), "Failed to unlock node mutex");
 
-  result = ftk_move_backward_quick(game, &move);
-
-  return (FTK_SUCCESS == result);
+  return fbk_undo_game_move(&move, game, eval);
 }
 
 /**
- * @brief Returns child node for given move, NULL if no child node for move or current node is not evaluated
+ * @brief Returns child node for given move, NULL if no child node for move or current node is not expanded
  * 
  * @param current_node 
  * @param move 
@@ -125,7 +179,7 @@ fbk_move_tree_node_s * fbk_get_move_tree_node_for_move(fbk_move_tree_node_s * cu
   {
     FBK_ASSERT_MSG(true == fbk_mutex_lock(&current_node->lock), "Failed to lock node mutex");
     fbk_decompress_move_tree_node(current_node, true);
-    if(current_node->analysis_data.evaluated)
+    if(current_node->expanded)
     {
       for(i = 0; ((i < current_node->child_count) && (ret_node == NULL)); i++)
       {
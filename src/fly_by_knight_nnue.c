@@ -0,0 +1,218 @@
+/*
+ fly_by_knight_nnue.c
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Efficiently updatable neural network evaluation for Fly by Knight
+*/
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <farewell_to_king.h>
+
+#include "fly_by_knight_algorithm_constants.h"
+#include "fly_by_knight_debug.h"
+#include "fly_by_knight_error.h"
+#include "fly_by_knight_nnue.h"
+
+/* Quantized network weights, immutable once loaded */
+typedef struct
+{
+  /* Centipawns per FBK_NNUE_QA*FBK_NNUE_QB output units */
+  int32_t output_scale;
+  int32_t output_bias;
+
+  alignas(64) int16_t feature_weights[FBK_NNUE_INPUT_SIZE][FBK_NNUE_HIDDEN_SIZE];
+  alignas(64) int16_t feature_bias[FBK_NNUE_HIDDEN_SIZE];
+  alignas(64) int8_t  output_weights[FBK_EVAL_COLOR_COUNT*FBK_NNUE_HIDDEN_SIZE];
+
+} nnue_network_s;
+
+/* Size of a network file */
+#define NNUE_FILE_SIZE (8 + 4 + 4 + (2*FBK_NNUE_INPUT_SIZE*FBK_NNUE_HIDDEN_SIZE) + (2*FBK_NNUE_HIDDEN_SIZE) + \
+                        (FBK_EVAL_COLOR_COUNT*FBK_NNUE_HIDDEN_SIZE) + 4)
+
+static nnue_network_s network;
+static atomic_bool    network_loaded = false;
+static atomic_bool    nnue_enabled   = false;
+
+static inline uint32_t read_uint32(const uint8_t ** cursor)
+{
+  const uint8_t * data = *cursor;
+  *cursor += 4;
+  return ((uint32_t) data[0]) | (((uint32_t) data[1]) << 8) | (((uint32_t) data[2]) << 16) | (((uint32_t) data[3]) << 24);
+}
+
+static inline int16_t read_int16(const uint8_t ** cursor)
+{
+  const uint8_t * data = *cursor;
+  *cursor += 2;
+  return (int16_t) (((uint16_t) data[0]) | (((uint16_t) data[1]) << 8));
+}
+
+bool fbk_load_nnue_network(const char * path)
+{
+  bool     ret_val = false;
+  uint8_t *buffer  = NULL;
+  FILE    *file    = NULL;
+
+  FBK_ASSERT_MSG(path != NULL, "NULL path passed.");
+
+  if(atomic_load(&network_loaded))
+  {
+    FBK_ERROR_MSG("A neural network is already loaded.");
+  }
+  else if(NULL == (file = fopen(path, "rb")))
+  {
+    FBK_ERROR_MSG("Failed to open neural network %s (errno %d)", path, errno);
+  }
+  else
+  {
+    /* Read one extra byte to detect oversized files */
+    buffer = malloc(NNUE_FILE_SIZE + 1);
+    FBK_ASSERT_MSG(buffer != NULL, "Failed to allocate neural network file buffer.");
+    const size_t   size   = fread(buffer, 1, NNUE_FILE_SIZE + 1, file);
+    const uint8_t *cursor = buffer + strlen(FBK_NNUE_FILE_MAGIC);
+
+    if((size < strlen(FBK_NNUE_FILE_MAGIC)) || (memcmp(buffer, FBK_NNUE_FILE_MAGIC, strlen(FBK_NNUE_FILE_MAGIC)) != 0))
+    {
+      FBK_ERROR_MSG("%s is not a Fly by Knight neural network.", path);
+    }
+    else if(size != NNUE_FILE_SIZE)
+    {
+      FBK_ERROR_MSG("Neural network %s is %zu bytes, expected %u.", path, size, (unsigned int) NNUE_FILE_SIZE);
+    }
+    else if(read_uint32(&cursor) != FBK_NNUE_HIDDEN_SIZE)
+    {
+      FBK_ERROR_MSG("Neural network %s hidden layer size is not %u.", path, FBK_NNUE_HIDDEN_SIZE);
+    }
+    else
+    {
+      network.output_scale = (int32_t) read_uint32(&cursor);
+      for(unsigned int feature = 0; feature < FBK_NNUE_INPUT_SIZE; feature++)
+      {
+        for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i++)
+        {
+          network.feature_weights[feature][i] = read_int16(&cursor);
+        }
+      }
+      for(unsigned int i = 0; i < FBK_NNUE_HIDDEN_SIZE; i++)
+      {
+        network.feature_bias[i] = read_int16(&cursor);
+      }
+      for(unsigned int i = 0; i < (FBK_EVAL_COLOR_COUNT*FBK_NNUE_HIDDEN_SIZE); i++)
+      {
+        network.output_weights[i] = (int8_t) *(cursor++);
+      }
+      network.output_bias = (int32_t) read_uint32(&cursor);
+
+      atomic_store(&network_loaded, true);
+      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Loaded neural network %s", path);
+      ret_val = true;
+    }
+  }
+
+  free(buffer);
+  if(file != NULL)
+  {
+    fclose(file);
+  }
+
+  return ret_val;
+}
+
+bool fbk_nnue_network_loaded()
+{
+  return atomic_load(&network_loaded);
+}
+
+bool fbk_set_nnue_enabled(bool enabled)
+{
+  bool ret_val = true;
+
+  if(enabled && !fbk_nnue_network_loaded())
+  {
+    FBK_ERROR_MSG("No neural network loaded.");
+    ret_val = false;
+  }
+  else
+  {
+    FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Evaluating with %s evaluation.", enabled?"neural network":"classical");
+    atomic_store(&nnue_enabled, enabled);
+  }
+
+  return ret_val;
+}
+
+bool fbk_nnue_enabled()
+{
+  return atomic_load_explicit(&nnue_enabled, memory_order_relaxed);
+}
+
+/**
+ * @brief Returns feature index of a piece from given perspective
+ */
+static inline unsigned int nnue_feature(unsigned int perspective, unsigned int color, unsigned int piece, ftk_square_e square)
+{
+  const unsigned int relative_color  = (color == perspective)?0:1;
+  const unsigned int relative_square = (0 == perspective)?square:(square ^ 56);
+
+  return (((relative_color * FBK_EVAL_PIECE_TYPE_COUNT) + piece) * FTK_STD_BOARD_SIZE) + relative_square;
+}
+
+void fbk_nnue_refresh(fbk_nnue_accumulator_s * accumulator, const ftk_board_mask_t piece_mask[FBK_EVAL_COLOR_COUNT][FBK_EVAL_PIECE_TYPE_COUNT],
+                      const fbk_simd_kernels_s * kernels)
+{
+  FBK_ASSERT_MSG(accumulator != NULL, "NULL accumulator passed.");
+  FBK_ASSERT_MSG(fbk_nnue_network_loaded(), "No neural network loaded.");
+
+  for(unsigned int perspective = 0; perspective < FBK_EVAL_COLOR_COUNT; perspective++)
+  {
+    memcpy(accumulator->value[perspective], network.feature_bias, sizeof(network.feature_bias));
+  }
+  accumulator->valid = true;
+
+  for(unsigned int color = 0; color < FBK_EVAL_COLOR_COUNT; color++)
+  {
+    for(unsigned int piece = 0; piece < FBK_EVAL_PIECE_TYPE_COUNT; piece++)
+    {
+      ftk_board_mask_t squares = piece_mask[color][piece];
+      while(squares)
+      {
+        const ftk_square_e square = ftk_get_first_set_bit_idx(squares);
+        FTK_CLEAR_BIT(squares, square);
+        fbk_nnue_update(accumulator, color, piece, square, 1, kernels);
+      }
+    }
+  }
+}
+
+void fbk_nnue_update(fbk_nnue_accumulator_s * accumulator, unsigned int color, unsigned int piece, ftk_square_e square, int sign,
+                     const fbk_simd_kernels_s * kernels)
+{
+  for(unsigned int perspective = 0; perspective < FBK_EVAL_COLOR_COUNT; perspective++)
+  {
+    kernels->nnue_accumulate(accumulator->value[perspective], network.feature_weights[nnue_feature(perspective, color, piece, square)], sign);
+  }
+}
+
+fbk_score_t fbk_nnue_score(const fbk_nnue_accumulator_s * accumulator, ftk_color_e turn, const fbk_simd_kernels_s * kernels)
+{
+  FBK_ASSERT_MSG(accumulator != NULL, "NULL accumulator passed.");
+  FBK_ASSERT_MSG(accumulator->valid, "Neural network accumulator not maintained.");
+
+  const unsigned int us   = (FTK_COLOR_WHITE == turn)?0:1;
+  const int64_t      sum  = ((int64_t) kernels->nnue_output(accumulator->value[us], accumulator->value[us^1], network.output_weights)) +
+                            network.output_bias;
+  /* Side to move's advantage in centipawns */
+  const int64_t      centipawns = (sum * network.output_scale) / (FBK_NNUE_QA * FBK_NNUE_QB);
+  const fbk_score_t  score      = (fbk_score_t) ((centipawns * FBK_SCORE_PAWN) / 100);
+
+  return (0 == us)?score:-score;
+}
@@ -19,6 +19,14 @@
 #include "fly_by_knight_error.h"
 #include "fly_by_knight_move_tree.h"
 #include "fly_by_knight_pick.h"
+#include "fly_by_knight_time.h"
+
+/* Period of timed picker triggers, bounds how far a move may overrun its time limit */
+#define FBK_PICKER_TIMER_PERIOD_MS       50
+/* Period of timed posts of an unchanged best line to report search progress */
+#define FBK_PICKER_TIMED_POST_PERIOD_MS  (5*1000)
+/* Capacity of the trigger ring buffer, job ended and timed triggers do not take entries */
+#define FBK_PICKER_TRIGGER_QUEUE_SIZE    32
 
 /**
  * @brief Returns the random legal move based on the current game
@@ -49,52 +57,23 @@ ftk_move_s fbk_get_random_move(fbk_instance_s *fbk)
   return random_move;
 }
 
-/**
- * @brief Returns the best move based on the current game
- * 
- * @param node Locked and decompressed node to get best child
- * @return Best move tree node
- */
-static inline fbk_move_tree_node_s *fbk_get_best_move(const fbk_move_tree_node_s * node)
+typedef struct
 {
-  FBK_ASSERT_MSG(NULL != node, "Current move tree node NULL");
-
-  fbk_move_tree_node_s** sorted_nodes = malloc(node->child_count * sizeof(fbk_move_tree_node_s*));
-
-  fbk_move_tree_node_s * best_node = NULL;
-
-  if(node->child_count > 0)
-  {
-    if(fbk_sort_child_nodes(node, sorted_nodes))
-    {
-      best_node = sorted_nodes[node->child_count-1];
-    }
-    else
-    {
-      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Failed to sort child nodes.  Returning invalid move.");
-    }
-  }
-
-  free(sorted_nodes);
-   
-  return best_node;
-}
+  fbk_mutex_t                  lock;
+  pthread_cond_t               new_trigger_condition;
 
-typedef struct fbk_picker_trigger_node_struct fbk_picker_trigger_node_s;
-struct fbk_picker_trigger_node_struct
-{
-  fbk_picker_trigger_s       trigger;
-  fbk_picker_trigger_node_s *next_trigger;
-};
+  /* Ring buffer of pending started, committed and forced triggers */
+  unsigned int                 first_trigger;
+  unsigned int                 trigger_count;
+  fbk_picker_trigger_s         trigger[FBK_PICKER_TRIGGER_QUEUE_SIZE];
 
-typedef struct
-{
-  fbk_mutex_t                lock;
-  pthread_cond_t             new_trigger_condition;
+  /* Job ended triggers coalesced into a single tree changed event, node is NULL if jobs of several nodes ended */
+  bool                         tree_changed;
+  const fbk_move_tree_node_s * changed_node;
 
-  unsigned int               trigger_count;
-  fbk_picker_trigger_node_s *first_trigger;
-  fbk_picker_trigger_node_s *last_trigger;
+  /* Deadline of the next timed trigger, only while the picker is active */
+  bool                         timer_armed;
+  struct timespec              timer_deadline;
   
 } fbk_picker_trigger_queue_s;
 
@@ -119,116 +98,147 @@ typedef struct
 } fbk_pick_data_s;
 fbk_pick_data_s pick_data = {0};
 
-static fbk_picker_best_line_node_s *build_best_line(fbk_move_tree_node_s *move_tree_node)
+/**
+ * @brief Links best line nodes for a snapshot's line
+ * @param snapshot  published best line
+ * @param line_node nodes to link, one for each move of the line
+ * 
+ * @return First node of the best line
+*/
+static fbk_picker_best_line_node_s *link_best_line(const fbk_best_line_snapshot_s *snapshot, fbk_picker_best_line_node_s line_node[])
 {
-  FBK_ASSERT_MSG(move_tree_node != NULL, "Null move_tree_node");
-
-  fbk_picker_best_line_node_s *new_node = malloc(sizeof(fbk_picker_best_line_node_s));
-  FBK_ASSERT_MSG(new_node != NULL, "Failed to allocate new best-line node");
+  FBK_ASSERT_MSG(snapshot != NULL, "NULL snapshot passed.");
+  FBK_ASSERT_MSG(snapshot->line_length > 0, "Empty best line passed.");
 
-  fbk_mutex_lock(&move_tree_node->lock);
-  bool decompressed = fbk_decompress_move_tree_node(move_tree_node, true);
- 
-  new_node->move = move_tree_node->move;
-  if(move_tree_node->analysis_data.evaluated && (move_tree_node->analysis_data.best_child_index < move_tree_node->child_count))
+  for(unsigned int i = 0; i < snapshot->line_length; i++)
   {
-    new_node->next_move = build_best_line(&move_tree_node->child[move_tree_node->analysis_data.best_child_index]);
+    line_node[i].move      = snapshot->line[i];
+    line_node[i].next_move = ((i+1) < snapshot->line_length)?&line_node[i+1]:NULL;
   }
-  else
-  {
-    new_node->next_move = NULL;
-  }
-
-  if(decompressed)
-  {
-    fbk_compress_move_tree_node(move_tree_node, true);
-  }
-  fbk_mutex_unlock(&move_tree_node->lock);
 
-  return new_node;
+  return &line_node[0];
 }
 
-static inline void delete_best_line(fbk_picker_best_line_node_s *best_line)
+/**
+ * @brief Sets timer deadline one period from now
+ * @param queue trigger queue with timer
+*/
+static void set_timer_deadline(fbk_picker_trigger_queue_s * queue)
 {
-  if(best_line->next_move != NULL)
+  clock_gettime(CLOCK_MONOTONIC, &queue->timer_deadline);
+  queue->timer_deadline.tv_nsec += FBK_PICKER_TIMER_PERIOD_MS*1000*1000;
+  if(queue->timer_deadline.tv_nsec >= 1000*1000*1000)
   {
-    delete_best_line(best_line->next_move);
+    queue->timer_deadline.tv_sec++;
+    queue->timer_deadline.tv_nsec -= 1000*1000*1000;
   }
-  free(best_line);
 }
 
 /**
- * @brief Logic to add job to back of job queue.  Assumes caller has lock.
+ * @brief Logic to add trigger to trigger queue.  Job ended triggers are coalesced and timed triggers move the timer 
+ *        deadline to now.  Assumes caller has lock.
  * @param queue       queue to append
  * @param new_trigger new trigger to append
 */
 static void push_trigger_to_trigger_queue(fbk_picker_trigger_queue_s * queue, const fbk_picker_trigger_s * new_trigger)
 {
-
   FBK_ASSERT_MSG(queue       != NULL, "NULL queue passed.");
   FBK_ASSERT_MSG(new_trigger != NULL, "NULL trigger passed.");
 
-  /* Build new node */
-  fbk_picker_trigger_node_s *new_trigger_node = (fbk_picker_trigger_node_s *) malloc(sizeof(fbk_picker_trigger_node_s));
-  FBK_ASSERT_MSG(new_trigger_node != NULL, "Malloc failed");
-  new_trigger_node->next_trigger = NULL;
-  new_trigger_node->trigger      = *new_trigger;
-
-  if(queue->trigger_count > 0)
+  if(FBK_PICKER_TRIGGER_JOB_ENDED == new_trigger->type)
+  {
+    if(!queue->tree_changed)
+    {
+      queue->tree_changed = true;
+      queue->changed_node = new_trigger->data.job_node;
+    }
+    else if(queue->changed_node != new_trigger->data.job_node)
+    {
+      queue->changed_node = NULL;
+    }
+  }
+  else if(FBK_PICKER_TRIGGER_TIMED == new_trigger->type)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &queue->timer_deadline);
+  }
+  else if(queue->trigger_count < FBK_PICKER_TRIGGER_QUEUE_SIZE)
   {
-    /* Add to linked list */
-    queue->last_trigger->next_trigger = new_trigger_node;
-    queue->last_trigger               = new_trigger_node;
+    queue->trigger[(queue->first_trigger + queue->trigger_count) % FBK_PICKER_TRIGGER_QUEUE_SIZE] = *new_trigger;
+    queue->trigger_count++;
   }
   else
   {
-    /* Init root job */
-    queue->first_trigger = new_trigger_node;
-    queue->last_trigger  = new_trigger_node;
+    FBK_ERROR_MSG("Picker trigger queue full, dropping trigger %u.", new_trigger->type);
   }
 
-  queue->trigger_count++;
   FBK_ASSERT_MSG(0 == pthread_cond_signal(&queue->new_trigger_condition), "Failed to signal new trigger is available.");
 }
 
 /**
- * @brief Returns the next trigger in the trigger queue or NULL if no triggers are available.  Assumes caller has lock.
- * @param queue Job queue to pop from.
+ * @brief Waits for and returns the next trigger.  Queued triggers come first, then a due timed trigger, then the 
+ *        coalesced tree changed event.  Assumes caller has lock.
+ * @param queue Trigger queue to pop from.
  * 
- * @return Next trigger in queue or 'invalid' trigger if queue is empty
+ * @return Next trigger
 */
-static fbk_picker_trigger_s pop_trigger_from_trigger_queue(fbk_picker_trigger_queue_s * queue)
+static fbk_picker_trigger_s wait_for_trigger(fbk_picker_trigger_queue_s * queue)
 {
   fbk_picker_trigger_s ret_val = {0};
 
-  FBK_ASSERT_MSG(queue != NULL, "NULL job queue passed.");
+  FBK_ASSERT_MSG(queue != NULL, "NULL trigger queue passed.");
 
-  if(queue->trigger_count > 0)
+  while(FBK_PICKER_TRIGGER_INVALID == ret_val.type)
   {
-    ret_val = queue->first_trigger->trigger;
-    queue->first_trigger = queue->first_trigger->next_trigger;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const bool timer_expired = queue->timer_armed &&
+                               ((now.tv_sec > queue->timer_deadline.tv_sec) ||
+                                ((now.tv_sec == queue->timer_deadline.tv_sec) && (now.tv_nsec >= queue->timer_deadline.tv_nsec)));
 
-    queue->trigger_count--;
-
-    if(queue->trigger_count == 0)
+    if(queue->trigger_count > 0)
+    {
+      ret_val = queue->trigger[queue->first_trigger];
+      queue->first_trigger = (queue->first_trigger + 1) % FBK_PICKER_TRIGGER_QUEUE_SIZE;
+      queue->trigger_count--;
+    }
+    else if(timer_expired)
+    {
+      ret_val.type = FBK_PICKER_TRIGGER_TIMED;
+      set_timer_deadline(queue);
+    }
+    else if(queue->tree_changed)
+    {
+      ret_val.type          = FBK_PICKER_TRIGGER_JOB_ENDED;
+      ret_val.data.job_node = queue->changed_node;
+      queue->tree_changed   = false;
+    }
+    else if(queue->timer_armed)
+    {
+      pthread_cond_timedwait(&queue->new_trigger_condition, &queue->lock, &queue->timer_deadline);
+    }
+    else
     {
-      FBK_ASSERT_MSG(NULL == queue->first_trigger, "All jobs claimed, but last job is not pointing to NULL");
-      queue->last_trigger = NULL;
+      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Waiting for picker trigger.");
+      pthread_cond_wait(&queue->new_trigger_condition, &queue->lock);
     }
   }
 
   return ret_val;
 }
 
-static void pick_timer_callback(union sigval sigev_value) 
+/**
+ * @brief Arms or disarms timed triggers
+ * @param armed true to check the clock periodically
+*/
+static void set_picker_timer(bool armed)
 {
-  FBK_UNUSED(sigev_value);
-
-  const fbk_picker_trigger_s trigger = 
+  fbk_mutex_lock(&pick_data.trigger_queue.lock);
+  pick_data.trigger_queue.timer_armed = armed;
+  if(armed)
   {
-    .type = FBK_PICKER_TRIGGER_TIMED,
-  };
-  fbk_trigger_picker(&trigger);
+    set_timer_deadline(&pick_data.trigger_queue);
+  }
+  fbk_mutex_unlock(&pick_data.trigger_queue.lock);
 }
 
 void * picker_thread_f(void * arg)
@@ -239,40 +249,29 @@ void * picker_thread_f(void * arg)
 
   bool force_move = false;
 
-  timer_t           pick_timer = {0};
-  struct sigevent   sev = {0};
-  struct itimerspec its = {0};
-
-  sev.sigev_notify = SIGEV_THREAD;
-  sev.sigev_value.sival_ptr = NULL;
-  sev.sigev_notify_function = pick_timer_callback;
-  sev.sigev_notify_attributes = NULL;
-  FBK_ASSERT_MSG(0 == timer_create(CLOCK_REALTIME, &sev, &pick_timer), "Failed to create pick timer.");
-
-  its.it_interval.tv_sec  = 5;
-  its.it_interval.tv_nsec = 0;
-  its.it_value.tv_sec     = 5;
-  its.it_value.tv_nsec    = 0;
-  FBK_ASSERT_MSG(0 == timer_settime(pick_timer, 0, &its, NULL), "Failed to start pick timer.");
+  /* Best move stability for the current move */
+  ftk_move_s    previous_best_move = {0};
+  unsigned int  best_move_changes  = 0;
+  unsigned int  stable_evaluations = 0;
+  ftk_invalidate_move(&previous_best_move);
+  /* Last posted best line snapshot and search time it was posted at, negative if not posted for the current move */
+  uint_fast64_t last_posted_sequence = 0;
+  fbk_time_ms_t last_post_time       = -1;
 
   while(1)
   {
     fbk_mutex_lock(&pick_data->trigger_queue.lock);
-
-    while(pick_data->trigger_queue.trigger_count == 0)
-    {
-      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Waiting for picker trigger.");
-      pthread_cond_wait(&pick_data->trigger_queue.new_trigger_condition, &pick_data->trigger_queue.lock);
-    }
-    fbk_picker_trigger_s trigger = pop_trigger_from_trigger_queue(&pick_data->trigger_queue);
-    FBK_ASSERT_MSG(trigger.type != FBK_PICKER_TRIGGER_INVALID, "Invalid picker tirgger.");
+    fbk_picker_trigger_s trigger = wait_for_trigger(&pick_data->trigger_queue);
     FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Popped picker trigger %u.", trigger.type);
-
     fbk_mutex_unlock(&pick_data->trigger_queue.lock);
 
-    if(FBK_PICKER_TRIGGER_MOVE_COMMITTED == trigger.type)
+    if((FBK_PICKER_TRIGGER_MOVE_COMMITTED == trigger.type) || (FBK_PICKER_TRIGGER_PICKER_STARTED == trigger.type))
     {
-      force_move = false;
+      force_move        = false;
+      best_move_changes  = 0;
+      stable_evaluations = 0;
+      last_post_time     = -1;
+      ftk_invalidate_move(&previous_best_move);
     }
     else if(FBK_PICKER_TRIGGER_FORCED == trigger.type)
     {
@@ -298,62 +297,116 @@ void * picker_thread_f(void * arg)
         bool post = false;
         fbk_picker_best_line_s best_line = {0};
 
-        fbk_mutex_lock(&pick_data->fbk->move_tree.current->lock);
-        bool decompressed = fbk_decompress_move_tree_node(pick_data->fbk->move_tree.current, true);
-        fbk_move_tree_node_s *best_node = fbk_get_best_move(pick_data->fbk->move_tree.current);
-        if(best_node != NULL)
+        /* Published by workers, read without move tree locks */
+        const fbk_best_line_snapshot_s *snapshot = fbk_acquire_best_line_snapshot();
+        if((snapshot != NULL) && (snapshot->root == pick_data->fbk->move_tree.current) && (snapshot->line_length > 0))
         {
-          best_line.game = pick_data->fbk->game;
-          fbk_mutex_lock(&best_node->lock);
-          move = best_node->move;
-          best_line.analysis_data = best_node->analysis_data;
-          fbk_mutex_unlock(&best_node->lock);
+          best_line.game          = pick_data->fbk->game;
+          best_line.analysis_data = snapshot->analysis_data;
+          best_line.child_count   = snapshot->child_count;
+          move = snapshot->line[0];
 
           post = true;
           best_line.search_time = fbk_get_move_time_ms(pick_data->fbk);
           best_line.searched_node_count = get_analyzed_nodes();
 
-          if((FBK_PICKER_TRIGGER_JOB_ENDED == trigger.type) && (trigger.data.job_node != best_node))
+          best_line.line_sequence       = snapshot->line_sequence;
+
+          if((FBK_PICKER_TRIGGER_JOB_ENDED == trigger.type) || (FBK_PICKER_TRIGGER_TIMED == trigger.type))
           {
-            post = false;
+            /* Post changes at most once per interval, timed triggers catch up on changes held back and report 
+               progress of an unchanged best line periodically */
+            const fbk_time_ms_t since_post = best_line.search_time - last_post_time;
+            post = (last_post_time < 0) ||
+                   ((snapshot->sequence != last_posted_sequence) && (since_post >= pick_data->fbk->config.thinking_output_interval)) ||
+                   ((FBK_PICKER_TRIGGER_TIMED == trigger.type) && (since_post >= FBK_PICKER_TIMED_POST_PERIOD_MS));
           }
 
+          if(FTK_MOVE_VALID(previous_best_move) && !FTK_COMPARE_MOVES(previous_best_move, move))
+          {
+            best_move_changes++;
+            stable_evaluations = 0;
+          }
+          else
+          {
+            stable_evaluations++;
+          }
+          previous_best_move = move;
         }
         if(FTK_MOVE_VALID(move) &&
            (pick_data->fbk->game.turn == pick_data->play_as))
         { 
           /* Move is valid and for current turn, check criteria to commit */
+          fbk_move_time_budget_s budget;
+          const fbk_time_control_s * time_control = &pick_data->fbk->time_control;
+          const fbk_time_ms_t elapsed = fbk_time_control_elapsed(time_control, best_line.search_time, best_line.searched_node_count);
+          fbk_budget_move_time(time_control, &budget);
+          const fbk_search_stability_s stability =
+          {
+            .stable_evaluations        = stable_evaluations,
+            .best_move_changes         = best_move_changes,
+            .best_move_depth           = best_line.analysis_data.best_child_depth+1,
+            .score_gap                 = snapshot->score_gap,
+            .best_move_effort_permille = snapshot->best_move_effort_permille,
+          };
+          bool easy_move = false;
+
           if(force_move)
           {
             commit_move = true;
           }
+          else if(time_control->infinite)
+          {
+            /* Searching until stopped */
+          }
+          else if(1 == snapshot->root_child_count)
+          {
+            /* Only one legal move */
+            commit_move = true;
+          }
           else if( FTK_END_DEFINITIVE(best_line.analysis_data.result)        ||  FTK_END_DEFINITIVE(best_line.analysis_data.best_child_result) ||
                   (FTK_END_DRAW_STALEMATE == best_line.analysis_data.result) || (FTK_END_DRAW_STALEMATE == best_line.analysis_data.best_child_result))
           {
             /* Definitive result */
             commit_move = true;
           }
-          else if(best_line.searched_node_count > 1000*1000)
+          else if((time_control->max_depth > 0) && ((best_line.analysis_data.best_child_depth+1) >= time_control->max_depth))
+          {
+            /* Reached depth limit */
+            commit_move = true;
+          }
+          else if((time_control->max_nodes > 0) && (best_line.searched_node_count >= time_control->max_nodes))
           {
-            /* Analyzed 1,000,000 moves*/
+            /* Reached node limit */
             commit_move = true;
           }
-          else if((best_line.searched_node_count > 500*1000) &&
-                  (best_line.analysis_data.best_child_depth >= 5))
+          else if(elapsed >= budget.hard_limit)
           {
-            /* Analyzed 500,000 moves and best line depth 5 */
             commit_move = true;
           }
-          else if((best_line.searched_node_count > 250*1000) &&
-                  (best_line.analysis_data.best_child_depth >= 6))
+          else if((elapsed + time_control->ponder_credit) >= fbk_extended_soft_limit(&budget, best_move_changes))
           {
-            /* Analyzed 250,000 moves and best line depth 6 */
+            /* Soft limit, extended while the best move keeps changing.  Pondering on this position counts toward it */
             commit_move = true;
           }
-          else if(fbk_get_move_time_ms(pick_data->fbk) > 10*1000)
+          else if(fbk_easy_move(&budget, elapsed + time_control->ponder_credit, &stability))
           {
-            /* Max 10s per move */
+            /* Best move is clearly decided, save the rest of the soft limit for later moves */
             commit_move = true;
+            easy_move   = true;
+          }
+
+          if(commit_move)
+          {
+            FBK_DEBUG_MSG(FBK_DEBUG_MED, "Committing %safter %ldms (soft %ldms, hard %ldms, %u best move changes, %u stable, gap %ld, effort %u permille)",
+                          easy_move?"easy move ":"", (long) elapsed, (long) budget.soft_limit, (long) budget.hard_limit, best_move_changes,
+                          stable_evaluations, (long) snapshot->score_gap, snapshot->best_move_effort_permille);
+            /* Charge the move first so the time it saves is only spread over the following moves */
+            fbk_time_control_move_made(&pick_data->fbk->time_control, elapsed);
+            if(easy_move)
+            {
+              fbk_time_control_easy_move(&pick_data->fbk->time_control, &budget, elapsed + time_control->ponder_credit);
+            }
           }
         }
         else
@@ -361,19 +414,15 @@ void * picker_thread_f(void * arg)
           FBK_DEBUG_MSG(FBK_DEBUG_LOW, "Could not find best move, not selecting any move yet.");
         }
 
-        if( commit_move ||
-            (post && (pick_data->fbk->config.thinking_output) && (pick_data->best_line_callback != NULL)) )
+        if( (commit_move || (post && pick_data->fbk->config.thinking_output)) && (pick_data->best_line_callback != NULL) )
         {
-          best_line.first_move = build_best_line(best_node);
+          fbk_picker_best_line_node_s line_node[FBK_BEST_LINE_SNAPSHOT_MAX_LENGTH];
+          best_line.first_move = link_best_line(snapshot, line_node);
           pick_data->best_line_callback(&best_line, pick_data->best_line_user_data_ptr);
-          delete_best_line(best_line.first_move);
+          last_posted_sequence = snapshot->sequence;
+          last_post_time       = best_line.search_time;
         }
-
-        if(decompressed)
-        {
-          fbk_compress_move_tree_node(pick_data->fbk->move_tree.current, true);
-        }
-        fbk_mutex_unlock(&pick_data->fbk->move_tree.current->lock);
+        fbk_release_best_line_snapshot();
       }
       else
       {
@@ -387,7 +436,8 @@ void * picker_thread_f(void * arg)
         
         if(commit_move)
         {
-          fbk_stop_analysis(true);
+          /* Keep pending jobs so analysis can be re-rooted at the committed move */
+          fbk_stop_analysis(false);
           FBK_ASSERT_MSG(true == fbk_commit_move(pick_data->fbk, &move), "Failed to commit move (%u->%u)", move.source, move.target);
           game_result = ftk_check_for_game_end(&pick_data->fbk->game);
         }
@@ -398,6 +448,98 @@ void * picker_thread_f(void * arg)
   }
 }
 
+ftk_move_s fbk_get_expected_reply(const fbk_instance_s *fbk)
+{
+  FBK_ASSERT_MSG(fbk != NULL, "NULL fbk instance passed.");
+
+  const fbk_move_tree_node_s     * current  = fbk->move_tree.current;
+  const fbk_best_line_snapshot_s * snapshot = fbk_acquire_best_line_snapshot();
+  ftk_move_s                       ret_val;
+  ftk_invalidate_move(&ret_val);
+
+  if(snapshot != NULL)
+  {
+    if((snapshot->root == current) && (snapshot->line_length > 0))
+    {
+      ret_val = snapshot->line[0];
+    }
+    else if((snapshot->root == current->parent) && (snapshot->line_length > 1) && FTK_COMPARE_MOVES(snapshot->line[0], current->move))
+    {
+      /* Best line was published before its first move was committed */
+      ret_val = snapshot->line[1];
+    }
+  }
+  fbk_release_best_line_snapshot();
+
+  return ret_val;
+}
+
+void fbk_start_pondering(fbk_instance_s *fbk)
+{
+  FBK_ASSERT_MSG(fbk != NULL, "NULL fbk instance passed.");
+
+  fbk_mutex_lock(&fbk->game_lock);
+  ftk_game_s             game      = fbk->game;
+  fbk_move_tree_node_s * current   = fbk->move_tree.current;
+  fbk_move_tree_node_s * predicted = NULL;
+
+  if(!fbk->ponder.pending)
+  {
+    /* Predict the first move of the opponent's best line */
+    fbk->ponder.pending        = true;
+    fbk->ponder.predicted_move = fbk_get_expected_reply(fbk);
+    clock_gettime(CLOCK_MONOTONIC, &fbk->ponder.start_time);
+  }
+
+  fbk_mutex_lock(&current->lock);
+  if(FTK_MOVE_VALID(fbk->ponder.predicted_move))
+  {
+    fbk_decompress_move_tree_node(current, true);
+    predicted = fbk_get_move_tree_node_for_move(current, &fbk->ponder.predicted_move);
+  }
+  fbk_mutex_unlock(&current->lock);
+
+  if(predicted != NULL)
+  {
+    FBK_ASSERT_MSG(FTK_SUCCESS == ftk_move_forward(&game, &fbk->ponder.predicted_move), "Failed to apply predicted move.");
+    FBK_DEBUG_MSG(FBK_DEBUG_MED, "Pondering predicted reply.");
+    fbk_start_analysis(&game, predicted);
+  }
+  else
+  {
+    fbk_start_analysis(&game, current);
+  }
+  fbk_mutex_unlock(&fbk->game_lock);
+}
+
+void fbk_resolve_ponder(fbk_instance_s *fbk, const ftk_move_s *move)
+{
+  FBK_ASSERT_MSG(fbk != NULL, "NULL fbk instance passed.");
+  FBK_ASSERT_MSG(move != NULL, "NULL move passed.");
+
+  if(fbk->ponder.pending)
+  {
+    const bool hit = FTK_MOVE_VALID(fbk->ponder.predicted_move) && FTK_COMPARE_MOVES(fbk->ponder.predicted_move, *move);
+
+    if(FTK_MOVE_VALID(fbk->ponder.predicted_move))
+    {
+      fbk->ponder.predictions++;
+    }
+    if(hit)
+    {
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+
+      fbk->ponder.hits++;
+      fbk->time_control.ponder_credit = ((now.tv_sec - fbk->ponder.start_time.tv_sec)*1000) + 
+                                        ((now.tv_nsec - fbk->ponder.start_time.tv_nsec)/1000000);
+    }
+    fbk->ponder.pending = false;
+
+    FBK_DEBUG_MSG(FBK_DEBUG_MED, "Ponder %s, %u of %u predictions hit.", hit?"hit":"miss", fbk->ponder.hits, fbk->ponder.predictions);
+  }
+}
+
 bool fbk_init_picker(fbk_instance_s *fbk)
 {
   FBK_ASSERT_MSG(fbk != NULL, "NULL fbk instance passed.");
@@ -409,8 +551,13 @@ bool fbk_init_picker(fbk_instance_s *fbk)
   pick_data.fbk                   = fbk;
   pick_data.picker_active         = false;
 
+  /* Timer deadlines are on the monotonic clock */
+  pthread_condattr_t condition_attributes;
+  pthread_condattr_init(&condition_attributes);
+  pthread_condattr_setclock(&condition_attributes, CLOCK_MONOTONIC);
   fbk_mutex_init(&pick_data.trigger_queue.lock);
-  pthread_cond_init(&pick_data.trigger_queue.new_trigger_condition, NULL);
+  pthread_cond_init(&pick_data.trigger_queue.new_trigger_condition, &condition_attributes);
+  pthread_condattr_destroy(&condition_attributes);
 
   FBK_ASSERT_MSG(0 == pthread_create(&pick_data.picker_thread , NULL, picker_thread_f, &pick_data), "Failed to start picker thread.");
 
@@ -427,6 +574,7 @@ void fbk_start_picker(const fbk_picker_client_config_s *pick_client_config)
   pick_data.picker_active           = true;
   pick_data.play_as                 = pick_client_config->play_as;
   fbk_mutex_unlock(&pick_data.lock);
+  set_picker_timer(true);
   const fbk_picker_trigger_s trigger = 
   {
     .type = FBK_PICKER_TRIGGER_PICKER_STARTED,
@@ -444,6 +592,7 @@ void fbk_stop_picker()
   pick_data.picker_active           = false;
   pick_data.play_as                 = FTK_COLOR_NONE;
   fbk_mutex_unlock(&pick_data.lock);
+  set_picker_timer(false);
 }
 
 void fbk_trigger_picker(const fbk_picker_trigger_s * trigger)
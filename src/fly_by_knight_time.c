@@ -0,0 +1,193 @@
+/*
+ fly_by_knight_time.c
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Time management for Fly by Knight
+*/
+
+#include <string.h>
+
+#include "fly_by_knight_debug.h"
+#include "fly_by_knight_error.h"
+#include "fly_by_knight_time.h"
+
+void fbk_init_time_control(fbk_time_control_s * time_control)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+
+  memset(time_control, 0, sizeof(fbk_time_control_s));
+  time_control->move_time = FBK_TIME_DEFAULT_MOVE_TIME_MS;
+}
+
+void fbk_set_time_control_level(fbk_time_control_s * time_control, unsigned int moves_per_period, fbk_time_ms_t base_time,
+                                fbk_time_ms_t increment)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+
+  time_control->moves_per_period = moves_per_period;
+  time_control->base_time        = base_time;
+  time_control->increment        = increment;
+  time_control->move_time        = 0;
+  time_control->engine_time      = base_time;
+  time_control->opponent_time    = base_time;
+  time_control->engine_moves     = 0;
+
+  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Time control %u moves in %ldms, %ldms increment",
+                moves_per_period, (long) base_time, (long) increment);
+}
+
+void fbk_set_time_control_move_time(fbk_time_control_s * time_control, fbk_time_ms_t move_time)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+
+  time_control->move_time = move_time;
+
+  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Time control %ldms per move", (long) move_time);
+}
+
+void fbk_reset_time_control(fbk_time_control_s * time_control)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+
+  time_control->engine_time      = time_control->base_time;
+  time_control->opponent_time    = time_control->base_time;
+  time_control->engine_moves     = 0;
+  time_control->max_depth        = 0;
+  time_control->max_nodes        = 0;
+  time_control->nodes_per_second = 0;
+  time_control->ponder_credit    = 0;
+  time_control->easy_moves       = 0;
+  time_control->saved_time       = 0;
+  time_control->banked_time      = 0;
+  time_control->infinite         = false;
+}
+
+void fbk_time_control_move_made(fbk_time_control_s * time_control, fbk_time_ms_t elapsed)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+
+  time_control->engine_time -= elapsed;
+  time_control->engine_time += time_control->increment;
+  time_control->engine_moves++;
+  time_control->banked_time -= time_control->banked_time / FBK_TIME_BANKED_SHARE_DEN;
+
+  if((time_control->moves_per_period > 0) && (0 == (time_control->engine_moves % time_control->moves_per_period)))
+  {
+    /* New period */
+    time_control->engine_time += time_control->base_time;
+  }
+}
+
+fbk_time_ms_t fbk_time_control_elapsed(const fbk_time_control_s * time_control, fbk_time_ms_t wall_time, fbk_node_count_t nodes)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+
+  fbk_time_ms_t ret_val = wall_time;
+
+  if(time_control->nodes_per_second > 0)
+  {
+    ret_val = (fbk_time_ms_t) ((nodes * 1000) / time_control->nodes_per_second);
+  }
+
+  return ret_val;
+}
+
+void fbk_budget_move_time(const fbk_time_control_s * time_control, fbk_move_time_budget_s * budget)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+  FBK_ASSERT_MSG(budget != NULL,       "NULL budget passed.");
+
+  if(time_control->move_time > 0)
+  {
+    budget->soft_limit = time_control->move_time - FBK_TIME_OVERHEAD_MS;
+    budget->hard_limit = budget->soft_limit;
+  }
+  else
+  {
+    const unsigned int  moves_to_go = (time_control->moves_per_period > 0)?
+                                      (time_control->moves_per_period - (time_control->engine_moves % time_control->moves_per_period)):
+                                      FBK_TIME_DEFAULT_MOVES_TO_GO;
+    const fbk_time_ms_t usable      = time_control->engine_time - FBK_TIME_OVERHEAD_MS;
+
+    budget->soft_limit = (usable / moves_to_go) + ((3 * time_control->increment) / 4);
+
+    if(time_control->opponent_time > time_control->engine_time)
+    {
+      /* Behind on the clock, spend proportionally less down to 3/4 of the even share */
+      const fbk_time_ms_t scaled = (time_control->opponent_time > 0)?
+                                   ((budget->soft_limit * time_control->engine_time) / time_control->opponent_time):0;
+      budget->soft_limit = (scaled > ((3 * budget->soft_limit) / 4))?scaled:((3 * budget->soft_limit) / 4);
+    }
+
+    budget->hard_limit = FBK_TIME_HARD_LIMIT_FACTOR * budget->soft_limit;
+    /* Spend a share of the time saved by earlier easy moves, the hard limit stays based on the even share */
+    budget->soft_limit += time_control->banked_time / FBK_TIME_BANKED_SHARE_DEN;
+    if(moves_to_go > 1)
+    {
+      if(budget->hard_limit > (usable / FBK_TIME_HARD_LIMIT_CLOCK_DIVISOR))
+      {
+        budget->hard_limit = usable / FBK_TIME_HARD_LIMIT_CLOCK_DIVISOR;
+      }
+    }
+    else if(budget->hard_limit > usable)
+    {
+      budget->hard_limit = usable;
+    }
+
+    if(budget->soft_limit > budget->hard_limit)
+    {
+      budget->soft_limit = budget->hard_limit;
+    }
+  }
+
+  if(budget->hard_limit < FBK_TIME_MIN_MOVE_TIME_MS)
+  {
+    budget->hard_limit = FBK_TIME_MIN_MOVE_TIME_MS;
+  }
+  if(budget->soft_limit < FBK_TIME_MIN_MOVE_TIME_MS)
+  {
+    budget->soft_limit = FBK_TIME_MIN_MOVE_TIME_MS;
+  }
+}
+
+fbk_time_ms_t fbk_extended_soft_limit(const fbk_move_time_budget_s * budget, unsigned int best_move_changes)
+{
+  FBK_ASSERT_MSG(budget != NULL, "NULL budget passed.");
+
+  const unsigned int  changes = (best_move_changes < FBK_TIME_INSTABILITY_MAX_CHANGES)?best_move_changes:FBK_TIME_INSTABILITY_MAX_CHANGES;
+  const fbk_time_ms_t limit   = (budget->soft_limit * (FBK_TIME_INSTABILITY_DEN + changes)) / FBK_TIME_INSTABILITY_DEN;
+
+  return (limit < budget->hard_limit)?limit:budget->hard_limit;
+}
+
+bool fbk_easy_move(const fbk_move_time_budget_s * budget, fbk_time_ms_t elapsed, const fbk_search_stability_s * stability)
+{
+  FBK_ASSERT_MSG(budget != NULL,    "NULL budget passed.");
+  FBK_ASSERT_MSG(stability != NULL, "NULL stability passed.");
+
+  return (elapsed                              >= (budget->soft_limit / FBK_TIME_EASY_MOVE_SOFT_LIMIT_DEN)) &&
+         (stability->best_move_changes         == 0)                                                    &&
+         (stability->stable_evaluations        >= FBK_TIME_EASY_MOVE_MIN_STABLE_EVALUATIONS)            &&
+         (stability->best_move_depth           >= FBK_TIME_EASY_MOVE_MIN_DEPTH)                         &&
+         (stability->score_gap                 >= FBK_TIME_EASY_MOVE_MIN_SCORE_GAP)                     &&
+         (stability->best_move_effort_permille >= FBK_TIME_EASY_MOVE_MIN_EFFORT_PERMILLE);
+}
+
+void fbk_time_control_easy_move(fbk_time_control_s * time_control, const fbk_move_time_budget_s * budget, fbk_time_ms_t elapsed)
+{
+  FBK_ASSERT_MSG(time_control != NULL, "NULL time control passed.");
+  FBK_ASSERT_MSG(budget != NULL,       "NULL budget passed.");
+
+  time_control->easy_moves++;
+  if(budget->soft_limit > elapsed)
+  {
+    time_control->saved_time += budget->soft_limit - elapsed;
+    /* A fixed time per move can not be carried over */
+    if(0 == time_control->move_time)
+    {
+      time_control->banked_time += budget->soft_limit - elapsed;
+    }
+  }
+}
@@ -0,0 +1,607 @@
+/*
+ fly_by_knight_tune.c
+ Fly by Knight - Chess Engine
+ Edward Sandor
+ October 2026
+
+ Offline Texel tuning of Fly by Knight evaluation parameters.  Fits evaluation parameters to the results of a set of
+ labeled positions by minimizing the error between game results and the win probability predicted from evaluation
+*/
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <farewell_to_king.h>
+
+#include "fly_by_knight.h"
+#include "fly_by_knight_affinity.h"
+#include "fly_by_knight_analysis.h"
+#include "fly_by_knight_debug.h"
+#include "fly_by_knight_error.h"
+#include "fly_by_knight_eval_params.h"
+#include "fly_by_knight_io.h"
+
+#ifndef FBK_RUNTIME_EVAL_PARAMS
+#error "The tuner must be built with runtime evaluation parameters (FBK_RUNTIME_EVAL_PARAMS)."
+#endif
+
+/* Maximum length of a line in a position file */
+#define FBK_TUNE_LINE_SIZE 512
+/* Bounds and iterations when fitting the scaling constant K */
+#define FBK_TUNE_K_MIN         0.0
+#define FBK_TUNE_K_MAX         10.0
+#define FBK_TUNE_K_ITERATIONS  50
+/* Default parameter step, halved each time a full pass finds no improvement until it reaches 1 */
+#define FBK_TUNE_DEFAULT_STEP  (FBK_SCORE_PAWN/100)
+
+/* Logging file, the tuner logs to stderr only */
+bool fbk_log_file_configured = false;
+FILE *fbk_log_file = NULL;
+
+/* Evaluation is linked without the engine, provide its basic services */
+void fbk_exit(int return_code)
+{
+  exit(return_code);
+}
+
+bool fbk_mutex_init(fbk_mutex_t *mutex)
+{
+  return (mutex != NULL) && (0 == pthread_mutex_init(mutex, NULL));
+}
+
+bool fbk_mutex_destroy(fbk_mutex_t *mutex)
+{
+  return (mutex != NULL) && (0 == pthread_mutex_destroy(mutex));
+}
+
+bool fbk_mutex_lock(fbk_mutex_t *mutex)
+{
+  return (mutex != NULL) && (0 == pthread_mutex_lock(mutex));
+}
+
+bool fbk_mutex_unlock(fbk_mutex_t *mutex)
+{
+  return (mutex != NULL) && (0 == pthread_mutex_unlock(mutex));
+}
+
+/* Labeled position */
+typedef struct
+{
+  /* Position with updated board masks */
+  ftk_game_s game;
+  /* Game result for white, 1 win, 0.5 draw, 0 loss */
+  double     result;
+} tune_position_s;
+
+/* Labeled positions to fit */
+typedef struct
+{
+  size_t           count;
+  size_t           capacity;
+  tune_position_s *position;
+} tune_dataset_s;
+
+/* Slice of dataset evaluated by one thread */
+typedef struct
+{
+  pthread_t              thread;
+  const tune_dataset_s  *dataset;
+  size_t                 begin;
+  size_t                 end;
+  double                 k;
+  /* Output sum of squared errors */
+  double                 error_sum;
+} tune_worker_s;
+
+/* Parsed arguments */
+typedef struct
+{
+  unsigned int threads;
+  unsigned int max_iterations;
+  fbk_score_t  step;
+  const char  *output_path;
+} tune_arguments_s;
+
+/**
+ * @brief Parses the game result of an EPD/FEN line, either a quoted PGN result (e.g. c9 "1-0";) or a bracketed
+ *        probability (e.g. [0.5])
+ *
+ * @param text   text following the position
+ * @param result output result for white
+ * @return true if a result was found
+ */
+static bool parse_result(const char * text, double * result)
+{
+  bool ret_val = true;
+  const char * bracket;
+
+  if(strstr(text, "1/2-1/2") != NULL)
+  {
+    *result = 0.5;
+  }
+  else if(strstr(text, "1-0") != NULL)
+  {
+    *result = 1.0;
+  }
+  else if(strstr(text, "0-1") != NULL)
+  {
+    *result = 0.0;
+  }
+  else if((bracket = strchr(text, '[')) != NULL)
+  {
+    char * end;
+    *result = strtod(bracket+1, &end);
+    ret_val = (end != (bracket+1)) && (*result >= 0.0) && (*result <= 1.0);
+  }
+  else
+  {
+    ret_val = false;
+  }
+
+  return ret_val;
+}
+
+/**
+ * @brief Parses a labeled position.  The position is given by the first four FEN fields, optionally followed by the
+ *        halfmove clock and move number, then the result
+ *
+ * @param line     line to parse
+ * @param position output position
+ * @return true if successful
+ */
+static bool parse_position(const char * line, tune_position_s * position)
+{
+  char fen[FBK_TUNE_LINE_SIZE];
+  const char * cursor = line;
+  size_t fen_length = 0;
+  unsigned int field;
+
+  for(field = 0; field < 6; field++)
+  {
+    while(' ' == *cursor)
+    {
+      cursor++;
+    }
+    const char * field_start = cursor;
+    while((*cursor != '\0') && (*cursor != ' ') && (*cursor != '\n') && (*cursor != ';'))
+    {
+      cursor++;
+    }
+    const size_t field_length = cursor - field_start;
+
+    if((0 == field_length) || ((field >= 4) && (strspn(field_start, "0123456789") != field_length)))
+    {
+      /* Clocks are optional in EPD */
+      cursor = field_start;
+      break;
+    }
+    if((fen_length + field_length + 2) > sizeof(fen))
+    {
+      return false;
+    }
+    memcpy(&fen[fen_length], field_start, field_length);
+    fen_length += field_length;
+    fen[fen_length++] = ' ';
+  }
+
+  if(field < 4)
+  {
+    return false;
+  }
+  if(field < 6)
+  {
+    fen_length += snprintf(&fen[fen_length], sizeof(fen) - fen_length, "0 1 ");
+  }
+  fen[fen_length-1] = '\0';
+
+  if(!parse_result(cursor, &position->result))
+  {
+    return false;
+  }
+  if(FTK_SUCCESS != ftk_create_game_from_fen_string(&position->game, fen))
+  {
+    return false;
+  }
+  ftk_update_board_masks(&position->game);
+
+  return true;
+}
+
+/**
+ * @brief Loads labeled positions from a file into dataset, one per line.  Unparsable lines are skipped
+ *
+ * @param dataset dataset to append to
+ * @param path    file to load
+ * @return true if file was read
+ */
+static bool load_dataset(tune_dataset_s * dataset, const char * path)
+{
+  char line[FBK_TUNE_LINE_SIZE];
+  size_t skipped = 0;
+  const size_t initial_count = dataset->count;
+
+  FILE * file = fopen(path, "r");
+  if(NULL == file)
+  {
+    FBK_ERROR_MSG("Failed to open %s (errno %d)", path, errno);
+    return false;
+  }
+
+  while(fgets(line, sizeof(line), file) != NULL)
+  {
+    if(dataset->count == dataset->capacity)
+    {
+      dataset->capacity = (dataset->capacity > 0)?(2*dataset->capacity):1024;
+      dataset->position = realloc(dataset->position, dataset->capacity*sizeof(tune_position_s));
+      FBK_ASSERT_MSG(dataset->position != NULL, "Failed to allocate %zu positions.", dataset->capacity);
+    }
+
+    if(parse_position(line, &dataset->position[dataset->count]))
+    {
+      dataset->count++;
+    }
+    else if(line[strspn(line, " \t\r\n")] != '\0')
+    {
+      skipped++;
+    }
+  }
+
+  fclose(file);
+
+  fprintf(stderr, "Loaded %zu positions from %s (%zu lines skipped)\n", dataset->count - initial_count, path, skipped);
+
+  return true;
+}
+
+/**
+ * @brief Thread summing squared errors of a slice of the dataset
+ */
+static void * tune_worker_thread(void * worker_data)
+{
+  tune_worker_s * worker = (tune_worker_s *) worker_data;
+  double error_sum = 0.0;
+
+  for(size_t i = worker->begin; i < worker->end; i++)
+  {
+    const tune_position_s * position = &worker->dataset->position[i];
+    /* Score in centipawns for white */
+    const double score      = (100.0 * fbk_score_game(&position->game)) / FBK_SCORE_PAWN;
+    const double prediction = 1.0 / (1.0 + pow(10.0, -worker->k * score / 400.0));
+    const double error      = position->result - prediction;
+    error_sum += error*error;
+  }
+
+  worker->error_sum = error_sum;
+
+  return NULL;
+}
+
+/**
+ * @brief Returns the mean squared error of the current evaluation parameters over dataset, evaluated across threads
+ *
+ * @param dataset labeled positions
+ * @param k       scaling constant from score to win probability
+ * @param threads number of threads
+ * @return mean squared error
+ */
+static double mean_squared_error(const tune_dataset_s * dataset, double k, unsigned int threads)
+{
+  tune_worker_s worker[threads];
+  double error_sum = 0.0;
+
+  for(unsigned int i = 0; i < threads; i++)
+  {
+    worker[i].dataset = dataset;
+    worker[i].begin   = (dataset->count * i) / threads;
+    worker[i].end     = (dataset->count * (i+1)) / threads;
+    worker[i].k       = k;
+    FBK_ASSERT_MSG(0 == pthread_create(&worker[i].thread, NULL, tune_worker_thread, &worker[i]), "Failed to create tuning thread.");
+  }
+  for(unsigned int i = 0; i < threads; i++)
+  {
+    FBK_ASSERT_MSG(0 == pthread_join(worker[i].thread, NULL), "Failed to join tuning thread.");
+    error_sum += worker[i].error_sum;
+  }
+
+  return error_sum / dataset->count;
+}
+
+/**
+ * @brief Finds the scaling constant K minimizing the error of the current parameters with a ternary search
+ */
+static double fit_k(const tune_dataset_s * dataset, unsigned int threads)
+{
+  double low  = FBK_TUNE_K_MIN;
+  double high = FBK_TUNE_K_MAX;
+
+  for(unsigned int i = 0; i < FBK_TUNE_K_ITERATIONS; i++)
+  {
+    const double low_third  = low  + (high - low)/3.0;
+    const double high_third = high - (high - low)/3.0;
+
+    if(mean_squared_error(dataset, low_third, threads) < mean_squared_error(dataset, high_third, threads))
+    {
+      high = high_third;
+    }
+    else
+    {
+      low = low_third;
+    }
+  }
+
+  return (low + high)/2.0;
+}
+
+/**
+ * @brief Marks parameters which are not tuned: the king's material value, which only sets the score scale of
+ *        checkmate, and pawn piece-square scores on the first and last rank, where pawns never stand
+ */
+static void mark_frozen_params(bool frozen[])
+{
+  char name[FBK_EVAL_PARAM_NAME_SIZE];
+  unsigned int index;
+
+  if(fbk_find_eval_param("piece_value[5]", &index))
+  {
+    frozen[index] = true;
+  }
+  for(ftk_square_e square = 0; square < FTK_STD_BOARD_SIZE; square++)
+  {
+    if((square < 8) || (square >= 56))
+    {
+      snprintf(name, sizeof(name), "pst_mg[0][%u]", square);
+      if(fbk_find_eval_param(name, &index))
+      {
+        frozen[index] = true;
+      }
+      snprintf(name, sizeof(name), "pst_eg[0][%u]", square);
+      if(fbk_find_eval_param(name, &index))
+      {
+        frozen[index] = true;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Writes current parameters to path, or stdout if path is NULL
+ */
+static void write_params(const char * path)
+{
+  if(NULL == path)
+  {
+    fbk_write_eval_params(&fbk_eval_params, stdout);
+  }
+  else
+  {
+    FILE * file = fopen(path, "w");
+    if(NULL == file)
+    {
+      FBK_ERROR_MSG("Failed to open %s for writing (errno %d)", path, errno);
+    }
+    else
+    {
+      fprintf(file, "# Fly by Knight evaluation parameters\n");
+      fbk_write_eval_params(&fbk_eval_params, file);
+      fclose(file);
+    }
+  }
+}
+
+/**
+ * @brief Fits evaluation parameters with local search, stepping each parameter up or down while the error improves
+ *
+ * @param dataset   labeled positions
+ * @param arguments tuning arguments
+ */
+static void tune(const tune_dataset_s * dataset, const tune_arguments_s * arguments)
+{
+  const unsigned int param_count = fbk_eval_param_count();
+  bool frozen[param_count];
+  char name[FBK_EVAL_PARAM_NAME_SIZE];
+  fbk_score_t step = arguments->step;
+
+  memset(frozen, 0, sizeof(frozen));
+  mark_frozen_params(frozen);
+
+  const double k = fit_k(dataset, arguments->threads);
+  double best_error = mean_squared_error(dataset, k, arguments->threads);
+  fprintf(stderr, "K %.4f, initial error %.8f\n", k, best_error);
+
+  for(unsigned int iteration = 1; iteration <= arguments->max_iterations; iteration++)
+  {
+    unsigned int changed = 0;
+
+    for(unsigned int i = 0; i < param_count; i++)
+    {
+      if(frozen[i])
+      {
+        continue;
+      }
+
+      const fbk_score_t value = fbk_get_eval_param(&fbk_eval_params, i);
+      bool improved = false;
+
+      for(int direction = 1; (direction >= -1) && !improved; direction -= 2)
+      {
+        fbk_set_eval_param(&fbk_eval_params, i, value + (direction*step));
+        const double error = mean_squared_error(dataset, k, arguments->threads);
+        if(error < best_error)
+        {
+          best_error = error;
+          improved   = true;
+        }
+      }
+
+      if(improved)
+      {
+        changed++;
+        fbk_eval_param_name(i, name);
+        FBK_DEBUG_MSG(FBK_DEBUG_MED, "%s %lld -> %lld", name, (long long) value, (long long) fbk_get_eval_param(&fbk_eval_params, i));
+      }
+      else
+      {
+        fbk_set_eval_param(&fbk_eval_params, i, value);
+      }
+    }
+
+    fprintf(stderr, "Iteration %u: error %.8f, %u parameters changed by %lld\n", iteration, best_error, changed, (long long) step);
+
+    if(arguments->output_path != NULL)
+    {
+      /* Save progress so long runs may be stopped at any time */
+      write_params(arguments->output_path);
+    }
+
+    if(0 == changed)
+    {
+      if(step > 1)
+      {
+        step /= 2;
+      }
+      else
+      {
+        break;
+      }
+    }
+  }
+
+  write_params(arguments->output_path);
+}
+
+/**
+ * @brief Display help text
+ */
+static void display_help(FILE * output_stream)
+{
+  fprintf(output_stream,
+          "Usage: flybyknight-tune [OPTION]... FILE...\n"
+          "Fits Fly by Knight evaluation parameters to labeled positions with Texel's tuning method.\n"
+          "Each line of FILE holds a FEN or EPD position followed by its game result, as a PGN result (e.g. c9 \"1-0\";)\n"
+          "or a probability for white (e.g. [0.5]).\n"
+          "  -d#,        --debug=#       debug logging level [0(disabled) - 9(maximum)]\n"
+          "  -e [path],  --eval=[path]   start from evaluation parameters at given 'path' (default built-in)\n"
+          "  -h,         --help          display this help and exit\n"
+          "  -i#,        --iterations=#  stop after # passes over all parameters (default unlimited)\n"
+          "  -j#,        --jobs=#        evaluate with # threads (default one per available core)\n"
+          "  -o [path],  --output=[path] write fitted parameters to 'path' after every pass (default stdout at end)\n"
+          "  -s#,        --step=#        initial parameter step (default %d)\n",
+          FBK_TUNE_DEFAULT_STEP);
+}
+
+int main(int argc, char *argv[])
+{
+  tune_arguments_s arguments;
+  tune_dataset_s   dataset;
+  bool argument_error = false;
+  int option;
+  int option_index = 0;
+  static struct option long_options[] = {
+      {"debug",      required_argument, 0,  'd' },
+      {"eval",       required_argument, 0,  'e' },
+      {"help",       no_argument,       0,  'h' },
+      {"iterations", required_argument, 0,  'i' },
+      {"jobs",       required_argument, 0,  'j' },
+      {"output",     required_argument, 0,  'o' },
+      {"step",       required_argument, 0,  's' },
+      {0,            0,                 0,   0  }
+  };
+
+  memset(&dataset, 0, sizeof(dataset));
+  fbk_init_cpu_affinity();
+  arguments.threads        = fbk_get_available_core_count();
+  arguments.max_iterations = ~0u;
+  arguments.step           = FBK_TUNE_DEFAULT_STEP;
+  arguments.output_path    = NULL;
+
+  while(!argument_error && ((option = getopt_long(argc, argv, "d:e:hi:j:o:s:", long_options, &option_index)) != -1))
+  {
+    switch(option)
+    {
+      case 'd':
+      {
+        int debug = atoi(optarg);
+        if((debug > FBK_DEBUG_MIN) || (debug < FBK_DEBUG_DISABLED))
+        {
+          argument_error = true;
+        }
+        else
+        {
+          fbk_set_debug_level(debug);
+        }
+        break;
+      }
+      case 'e':
+      {
+        argument_error = !fbk_load_eval_params(&fbk_eval_params, optarg);
+        break;
+      }
+      case 'h':
+      {
+        display_help(stdout);
+        return 0;
+      }
+      case 'i':
+      {
+        arguments.max_iterations = atoi(optarg);
+        argument_error = (arguments.max_iterations < 1);
+        break;
+      }
+      case 'j':
+      {
+        arguments.threads = atoi(optarg);
+        argument_error = (arguments.threads < 1);
+        break;
+      }
+      case 'o':
+      {
+        arguments.output_path = optarg;
+        break;
+      }
+      case 's':
+      {
+        arguments.step = atoi(optarg);
+        argument_error = (arguments.step < 1);
+        break;
+      }
+      default:
+      {
+        argument_error = true;
+        break;
+      }
+    }
+  }
+
+  if(argument_error || (optind >= argc))
+  {
+    display_help(stderr);
+    return 1;
+  }
+
+  FBK_ASSERT_MSG(fbk_init_analysis_lut(), "Failed to initialize analysis look-up tables");
+
+  for(int i = optind; i < argc; i++)
+  {
+    if(!load_dataset(&dataset, argv[i]))
+    {
+      return 1;
+    }
+  }
+
+  if(0 == dataset.count)
+  {
+    FBK_ERROR_MSG("No labeled positions loaded.");
+    return 1;
+  }
+
+  tune(&dataset, &arguments);
+
+  free(dataset.position);
+
+  return 0;
+}
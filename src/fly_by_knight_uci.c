@@ -3,22 +3,150 @@
  Fly by Knight - Chess Engine
  Edward Sandor
  December 2020 - 2021
- 
+
  UCI protocol interpetting for Fly by Knight
 */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <farewell_to_king.h>
 #include <farewell_to_king_strings.h>
 
 #include "fly_by_knight.h"
+#include "fly_by_knight_affinity.h"
+#include "fly_by_knight_analysis.h"
+#include "fly_by_knight_analysis_worker.h"
 #include "fly_by_knight_debug.h"
 #include "fly_by_knight_error.h"
+#include "fly_by_knight_io.h"
+#include "fly_by_knight_move_tree.h"
+#include "fly_by_knight_pick.h"
+#include "fly_by_knight_time.h"
 #include "fly_by_knight_uci.h"
+#include "fly_by_knight_version.h"
+
+/* Names of engine options exposed to the GUI */
+#define FBK_UCI_OPTION_THREADS "Threads"
+#define FBK_UCI_OPTION_AUTO_THREADS "Auto Threads"
+#define FBK_UCI_OPTION_HASH    "Hash"
+#define FBK_UCI_OPTION_PONDER  "Ponder"
+#define FBK_UCI_OPTION_THINKING_OUTPUT_INTERVAL "Thinking Output Interval"
+
+/* Maximum worker threads offered to the GUI */
+#define FBK_UCI_MAX_THREADS    1024
+
+#define INFO_OUTPUT_BUFFER_SIZE 1024
+
+/**
+ * @brief Initializes FBK for UCI and identifies the engine and its options
+ *
+ * @param fbk
+ */
+void fbk_init_uci_protocol(fbk_instance_s *fbk)
+{
+  FBK_ASSERT_MSG(fbk != NULL, "NULL fbk pointer passed.");
+
+  fbk->protocol = FBK_PROTOCOL_UCI;
+
+  memset(&fbk->protocol_data, 0, sizeof(fbk_protocol_data_u));
+
+  /* UCI GUIs always expect search information */
+  fbk->config.thinking_output = true;
+
+  FBK_OUTPUT_MSG("id name " FLY_BY_KNIGHT_NAME_VER "\n"
+                 "id author " FLY_BY_KNIGHT_AUTHOR "\n");
+  FBK_OUTPUT_MSG("option name " FBK_UCI_OPTION_THREADS " type spin default %u min 1 max %u\n",
+                 fbk->config.worker_threads, FBK_UCI_MAX_THREADS);
+  FBK_OUTPUT_MSG("option name " FBK_UCI_OPTION_AUTO_THREADS " type check default %s\n",
+                 fbk->config.auto_worker_threads?"true":"false");
+  FBK_OUTPUT_MSG("option name " FBK_UCI_OPTION_HASH " type spin default %u min 0 max %u\n",
+                 FBK_DEFAULT_EVAL_CACHE_SIZE_MB, FBK_MAX_EVAL_CACHE_SIZE_MB);
+  FBK_OUTPUT_MSG("option name " FBK_UCI_OPTION_THINKING_OUTPUT_INTERVAL " type spin default %ld min 0 max %d\n",
+                 (long) fbk->config.thinking_output_interval, FBK_MAX_THINKING_OUTPUT_INTERVAL_MS);
+  FBK_OUTPUT_MSG("option name " FBK_UCI_OPTION_PONDER " type check default false\n"
+                 "uciok\n");
+}
+
+/**
+ * @brief Parses a long algebraic move in the context of given game
+ * 
+ * @param game        game the move is played in
+ * @param move_string move string
+ * @return staged move, invalid if the string is malformed or the move is illegal
+ */
+static ftk_move_s parse_uci_move(ftk_game_s * game, const char * move_string)
+{
+  ftk_square_e   target         = FTK_XX;
+  ftk_square_e   source         = FTK_XX;
+  ftk_type_e     pawn_promotion = FTK_TYPE_EMPTY;
+  ftk_castle_e   castle         = FTK_CASTLE_NONE;
+  ftk_move_s     move;
+
+  ftk_invalidate_move(&move);
+
+  if(FTK_SUCCESS == ftk_long_algebraic_move(move_string, &target, &source, &pawn_promotion, &castle))
+  {
+    move = ftk_stage_move(game, target, source, pawn_promotion);
+  }
+
+  return move;
+}
+
+/**
+ * @brief Counts leading moves of a move list already played from the move tree root to the current node.  Assumes 
+ *        caller holds the game lock and analysis is stopped
+ * 
+ * @param fbk         Fly by Knight instance data
+ * @param moves       move strings from the move tree root
+ * @param move_count  number of move strings
+ * @param path_length output number of moves from the move tree root to the current node
+ * @return number of matching moves
+ */
+static unsigned int match_move_tree_path(fbk_instance_s *fbk, char * const * moves, unsigned int move_count, unsigned int * path_length)
+{
+  unsigned int           matched = 0;
+  ftk_game_s             game    = fbk->game;
+  fbk_move_tree_node_s * node;
+
+  *path_length = 0;
+  for(node = fbk->move_tree.current; node->parent != NULL; node = node->parent)
+  {
+    (*path_length)++;
+  }
+
+  fbk_move_tree_node_s ** path = malloc((*path_length) * sizeof(fbk_move_tree_node_s *));
+  FBK_ASSERT_MSG((path != NULL) || (0 == *path_length), "Failed to allocate move tree path.");
+
+  /* Rewind a copy of the game to the move tree root */
+  unsigned int depth = *path_length;
+  for(node = fbk->move_tree.current; node->parent != NULL; node = node->parent)
+  {
+    path[--depth] = node;
+    FBK_ASSERT_MSG(FTK_SUCCESS == ftk_move_backward(&game, &node->move), "Failed to rewind move tree path.");
+  }
+
+  while((matched < move_count) && (matched < *path_length))
+  {
+    ftk_move_s move = parse_uci_move(&game, moves[matched]);
+    if(!FTK_MOVE_VALID(move) || !FTK_COMPARE_MOVES(move, path[matched]->move))
+    {
+      break;
+    }
+    FBK_ASSERT_MSG(FTK_SUCCESS == ftk_move_forward(&game, &move), "Failed to replay move tree path.");
+    matched++;
+  }
+
+  free(path);
+
+  return matched;
+}
 
 /**
- * @brief Process position command
+ * @brief Process position command.  Moves extending the current game are committed to the existing move tree and moves
+ *        the new move list diverges from are taken back, the tree is only rebuilt when the base position changes
  * 
  * @param fbk Fly by Knight instance data
  * @param input Input string from external process
@@ -26,68 +154,415 @@
 void fbk_process_uci_position_command(fbk_instance_s *fbk, char * input)
 {
   ftk_result_e ftk_result;
+  char *       move_list  = strstr(input, "moves");
+  char **      moves      = NULL;
+  unsigned int move_count = 0;
+  unsigned int matched    = 0;
 
   FBK_DEBUG_MSG(FBK_DEBUG_MED, "Processing position command: %s", input);
 
-  if(strncmp("fen", input, 3) == 0)
+  if((move_list != NULL) && (move_list > input))
+  {
+    /* Terminate the position description before the move list */
+    move_list[-1] = '\0';
+    move_list = &move_list[5];
+
+    char * save_ptr = NULL;
+    for(char * move_string = strtok_r(move_list, " ", &save_ptr); move_string != NULL; move_string = strtok_r(NULL, " ", &save_ptr))
+    {
+      moves = realloc(moves, (move_count+1) * sizeof(char *));
+      FBK_ASSERT_MSG(moves != NULL, "Failed to allocate %u move strings.", move_count+1);
+      moves[move_count++] = move_string;
+    }
+  }
+
+  if((strncmp("fen ", input, 4) != 0) && (strcmp("startpos", input) != 0))
+  {
+    FBK_FATAL_MSG("Cannot process position command: %s", input);
+  }
+
+  /* The picker must not commit while the game is replaced */
+  fbk_stop_picker();
+  fbk_stop_analysis(false);
+
+  bool reuse_tree = (fbk->protocol_data.uci.position_base != NULL) && (strcmp(fbk->protocol_data.uci.position_base, input) == 0);
+  if(reuse_tree)
   {
-    FBK_DEBUG_MSG(FBK_DEBUG_LOW, "FEN position received: %s", &input[4]);
-    ftk_result = ftk_create_game_from_fen_string(&fbk->game, &input[4]);
-    FBK_ASSERT_MSG(FTK_SUCCESS == ftk_result, "Failed to parse FEN string: %s (%u)", &input[4], ftk_result);
+    unsigned int path_length;
+    fbk_mutex_lock(&fbk->game_lock);
+    matched = match_move_tree_path(fbk, moves, move_count, &path_length);
+    fbk_mutex_unlock(&fbk->game_lock);
+
+    /* Take back moves after the point the new move list diverges from the game, e.g. a mispredicted ponder move, 
+       and continue into the actual moves' existing nodes */
+    FBK_DEBUG_MSG(FBK_DEBUG_LOW, "%u of %u moves already played, taking back %u moves", matched, move_count, path_length-matched);
+    for(unsigned int i = matched; i < path_length; i++)
+    {
+      FBK_ASSERT_MSG(true == fbk_undo_move(fbk), "Failed to take back move %u", i);
+    }
   }
-  else if(strncmp("startpos moves", input, 14) == 0)
+
+  if(!reuse_tree)
   {
-    FBK_DEBUG_MSG(FBK_DEBUG_LOW, "startpos received: %s", &input[15]);
+    matched = 0;
     fbk_begin_standard_game(fbk, true);
 
-    char move_string[FTK_MOVE_STRING_SIZE] = {0};
-    ftk_square_e target, source;
-    ftk_type_e     pawn_promotion;
-    ftk_castle_e   castle;
-    ftk_move_s     move;
+    if(strncmp("fen ", input, 4) == 0)
+    {
+      FBK_DEBUG_MSG(FBK_DEBUG_LOW, "FEN position received: %s", &input[4]);
+      ftk_result = ftk_create_game_from_fen_string(&fbk->game, &input[4]);
+      FBK_ASSERT_MSG(FTK_SUCCESS == ftk_result, "Failed to parse FEN string: %s (%u)", &input[4], ftk_result);
+    }
+
+    free(fbk->protocol_data.uci.position_base);
+    fbk->protocol_data.uci.position_base = strdup(input);
+    FBK_ASSERT_MSG(fbk->protocol_data.uci.position_base != NULL, "Failed to copy position.");
+  }
+
+  for(unsigned int i = matched; i < move_count; i++)
+  {
+    FBK_DEBUG_MSG(FBK_DEBUG_MIN, "processing move: %s", moves[i]);
+
+    /* Commit through the move tree so analysis follows the game */
+    ftk_move_s move = parse_uci_move(&fbk->game, moves[i]);
+    FBK_ASSERT_MSG(FTK_MOVE_VALID(move), "Illegal move %s", moves[i]);
+    FBK_ASSERT_MSG(true == fbk_commit_move(fbk, &move), "Failed to commit move %s", moves[i]);
+  }
 
-    for(unsigned int i = 15; true; i++)
+  free(moves);
+}
+
+static void uci_pick_callback(ftk_game_end_e game_result, ftk_move_s move, void * user_data)
+{
+  FBK_ASSERT_MSG(user_data != NULL,"NULL user data pointer passed");
+  fbk_instance_s *fbk = (fbk_instance_s *) user_data;
+
+  FBK_UNUSED(game_result);
+
+  /* Report exactly one best move per 'go' */
+  if(fbk->protocol_data.uci.searching)
+  {
+    fbk->protocol_data.uci.searching = false;
+    fbk->protocol_data.uci.pondering = false;
+
+    if(FTK_MOVE_VALID(move))
     {
-      unsigned int move_string_idx = 0;
-      if(input[i] != ' ' && input[i] != '\0')
+      char move_output[FTK_MOVE_STRING_SIZE]   = "0000";
+      char ponder_output[FTK_MOVE_STRING_SIZE] = "";
+      ftk_move_to_xboard_string(&move, move_output);
+
+      /* Picked move is committed, suggest its best reply for pondering */
+      fbk_mutex_lock(&fbk->game_lock);
+      const ftk_move_s ponder_move = fbk_get_expected_reply(fbk);
+      fbk_mutex_unlock(&fbk->game_lock);
+      if(FTK_MOVE_VALID(ponder_move))
       {
-        FBK_ASSERT_MSG(move_string_idx < FTK_MOVE_STRING_SIZE, "move string exceeded max size: %s", move_string);
-        move_string[move_string_idx] = input[i];
-        move_string_idx++;
+        ftk_move_to_xboard_string(&ponder_move, ponder_output);
       }
-      else if(move_string_idx > 0)
-      {
-        FBK_DEBUG_MSG(FBK_DEBUG_MIN, "processing move: %s", move_string);
-
-        target = FTK_XX;
-        source = FTK_XX;
-        pawn_promotion = FTK_TYPE_EMPTY;
-        castle         = FTK_CASTLE_NONE;
-        ftk_result = ftk_long_algebraic_move(move_string, &target, &source, &pawn_promotion, &castle);          
-        FBK_ASSERT_MSG(FTK_SUCCESS == ftk_result, "Failed to parse move string: %s", move_string);
 
-        move = ftk_move_piece(&fbk->game, target, source, pawn_promotion);
-        FBK_ASSERT_MSG(FTK_XX != move.source, "Illegal move %s", move_string);
-        FBK_ASSERT_MSG(FTK_XX != move.target, "Illegal move %s", move_string);
-
-        memset(move_string, 0, sizeof(move_string));
-        move_string_idx = 0;
+      if(ponder_output[0] != '\0')
+      {
+        FBK_OUTPUT_MSG("bestmove %s ponder %s\n", move_output, ponder_output);
       }
-      if('\0' == input[i])
+      else
       {
-        break;
+        FBK_OUTPUT_MSG("bestmove %s\n", move_output);
       }
     }
+    else
+    {
+      /* No legal moves */
+      FBK_OUTPUT_MSG("bestmove 0000\n");
+    }
+  }
+}
+
+static void uci_best_line_callback(const fbk_picker_best_line_s * best_line, void * user_data)
+{
+  FBK_ASSERT_MSG(user_data != NULL,"NULL user data pointer passed");
+  const fbk_instance_s *fbk = (const fbk_instance_s *) user_data;
+
+  char   info_output_buffer[INFO_OUTPUT_BUFFER_SIZE] = {'\0'};
+  size_t info_output_buffer_length = 0;
+
+  if(!fbk->protocol_data.uci.searching)
+  {
+    return;
+  }
+
+  /* Scores are from the engine's point of view */
+  if(best_line->analysis_data.evaluated && FTK_END_DEFINITIVE(best_line->analysis_data.best_child_result))
+  {
+    const long mate_moves = (2+best_line->analysis_data.best_child_depth)/2;
+    info_output_buffer_length += snprintf(info_output_buffer, INFO_OUTPUT_BUFFER_SIZE, "score mate %ld",
+                                          ((best_line->analysis_data.best_child_depth % 2) == 0)?mate_moves:-mate_moves);
   }
   else
   {
-    FBK_FATAL_MSG("Cannot process position command: %s", input);
+    fbk_score_t score = 0;
+    if(best_line->analysis_data.evaluated)
+    {
+      score = ((best_line->analysis_data.best_child_index < best_line->child_count)?
+               best_line->analysis_data.best_child_score:best_line->analysis_data.base_score)/10;
+    }
+    if(best_line->first_move->move.turn == FTK_COLOR_BLACK)
+    {
+      score *= -1;
+    }
+    info_output_buffer_length += snprintf(info_output_buffer, INFO_OUTPUT_BUFFER_SIZE, "score cp %ld", (long) score);
+  }
+
+  const uint_fast64_t nodes_per_second = (best_line->search_time > 0)?((best_line->searched_node_count*1000)/best_line->search_time):0;
+
+  info_output_buffer_length += snprintf(&info_output_buffer[info_output_buffer_length],
+                                        (INFO_OUTPUT_BUFFER_SIZE-info_output_buffer_length),
+                                        " nodes %lu nps %lu hashfull %u time %ld pv",
+                                        (unsigned long) best_line->searched_node_count,
+                                        (unsigned long) nodes_per_second,
+                                        fbk_eval_cache_permille(),
+                                        (long) best_line->search_time);
+
+  for(const fbk_picker_best_line_node_s * best_line_node = best_line->first_move;
+      (best_line_node != NULL) && (info_output_buffer_length < INFO_OUTPUT_BUFFER_SIZE);
+      best_line_node = best_line_node->next_move)
+  {
+    char move_output[FTK_MOVE_STRING_SIZE] = "0000";
+    ftk_move_to_xboard_string(&best_line_node->move, move_output);
+
+    info_output_buffer_length += snprintf(&info_output_buffer[info_output_buffer_length],
+                                          (INFO_OUTPUT_BUFFER_SIZE-info_output_buffer_length),
+                                          " %s", move_output);
+  }
+
+  FBK_OUTPUT_MSG("info depth %lu seldepth %lu %s\n",
+                 (unsigned long) best_line->analysis_data.best_child_depth+1,
+                 (unsigned long) best_line->analysis_data.max_depth+1,
+                 info_output_buffer);
+}
+
+/**
+ * @brief Returns the value following a 'go' parameter
+ *
+ * @param save_ptr strtok_r state of the 'go' parameters
+ */
+static long next_uci_value(char ** save_ptr)
+{
+  const char * value = strtok_r(NULL, " ", save_ptr);
+
+  return (value != NULL)?atol(value):0;
+}
+
+/**
+ * @brief Process go command, configuring limits and starting the search
+ *
+ * @param fbk Fly by Knight instance data
+ * @param input Parameters following 'go'
+ */
+void fbk_process_uci_go_command(fbk_instance_s *fbk, char * input)
+{
+  fbk_time_ms_t clock[2]     = {0};
+  fbk_time_ms_t increment[2] = {0};
+  bool          clock_given  = false;
+  long          moves_to_go  = 0;
+  long          depth        = 0;
+  long          nodes        = 0;
+  long          move_time    = 0;
+  bool          infinite     = false;
+  bool          ponder       = false;
+  char *        save_ptr     = NULL;
+
+  FBK_DEBUG_MSG(FBK_DEBUG_MED, "Processing go command: %s", input);
+
+  for(char * token = strtok_r(input, " ", &save_ptr); token != NULL; token = strtok_r(NULL, " ", &save_ptr))
+  {
+    if(strcmp("wtime", token) == 0)
+    {
+      clock[0]    = next_uci_value(&save_ptr);
+      clock_given = true;
+    }
+    else if(strcmp("btime", token) == 0)
+    {
+      clock[1]    = next_uci_value(&save_ptr);
+      clock_given = true;
+    }
+    else if(strcmp("winc", token) == 0)
+    {
+      increment[0] = next_uci_value(&save_ptr);
+    }
+    else if(strcmp("binc", token) == 0)
+    {
+      increment[1] = next_uci_value(&save_ptr);
+    }
+    else if(strcmp("movestogo", token) == 0)
+    {
+      moves_to_go = next_uci_value(&save_ptr);
+    }
+    else if(strcmp("depth", token) == 0)
+    {
+      depth = next_uci_value(&save_ptr);
+    }
+    else if(strcmp("nodes", token) == 0)
+    {
+      nodes = next_uci_value(&save_ptr);
+    }
+    else if(strcmp("movetime", token) == 0)
+    {
+      move_time = next_uci_value(&save_ptr);
+    }
+    else if(strcmp("infinite", token) == 0)
+    {
+      infinite = true;
+    }
+    else if(strcmp("ponder", token) == 0)
+    {
+      ponder = true;
+    }
+    else
+    {
+      FBK_DEBUG_MSG(FBK_DEBUG_MED, "Ignoring go parameter '%s'", token);
+    }
+  }
+
+  fbk_mutex_lock(&fbk->game_lock);
+  fbk_time_control_s * time_control = &fbk->time_control;
+  const unsigned int   us           = (FTK_COLOR_WHITE == fbk->game.turn)?0:1;
+
+  if(move_time > 0)
+  {
+    fbk_set_time_control_move_time(time_control, move_time);
+  }
+  else if(clock_given)
+  {
+    /* Each 'go' restates the clocks, so the period always starts now */
+    fbk_set_time_control_level(time_control, (moves_to_go > 0)?moves_to_go:0, clock[us], increment[us]);
+    time_control->opponent_time = clock[us^1];
+  }
+  else if((depth > 0) || (nodes > 0))
+  {
+    fbk_set_time_control_move_time(time_control, FBK_TIME_NO_LIMIT_MS);
+  }
+  else
+  {
+    /* No limits given, search until stopped */
+    infinite = true;
+  }
+  time_control->max_depth        = (depth > 0)?depth:0;
+  time_control->max_nodes        = (nodes > 0)?nodes:0;
+  time_control->nodes_per_second = 0;
+  time_control->infinite         = infinite || ponder;
+  time_control->ponder_credit    = 0;
+
+  /* Start the move clock with the search */
+  clock_gettime(CLOCK_MONOTONIC, &fbk->last_move_time);
+  /* The GUI already played the predicted reply, resolved by 'ponderhit' or 'stop' */
+  fbk->ponder.pending        = ponder;
+  fbk->ponder.predicted_move = fbk->move_tree.current->move;
+  fbk->ponder.start_time     = fbk->last_move_time;
+  fbk_mutex_unlock(&fbk->game_lock);
+  reset_analyzed_nodes();
+
+  fbk->protocol_data.uci.searching = true;
+  fbk->protocol_data.uci.pondering = ponder;
+
+  fbk_picker_client_config_s picker_config = {0};
+
+  picker_config.play_as                 = fbk->game.turn;
+  picker_config.pick_callback           = uci_pick_callback;
+  picker_config.pick_user_data_ptr      = (void*) fbk;
+  picker_config.best_line_callback      = uci_best_line_callback;
+  picker_config.best_line_user_data_ptr = (void*) fbk;
+
+  fbk_start_picker(&picker_config);
+  fbk_start_analysis(&fbk->game, fbk->move_tree.current);
+}
+
+/**
+ * @brief Process setoption command
+ *
+ * @param fbk Fly by Knight instance data
+ * @param input Input following 'setoption name '
+ * @return true if option is known and value is valid
+ */
+bool fbk_process_uci_setoption_command(fbk_instance_s *fbk, char * input)
+{
+  bool   ret_val = true;
+  char * value   = strstr(input, " value ");
+
+  if(value != NULL)
+  {
+    /* Terminate option name */
+    value[0] = '\0';
+    value    = &value[7];
+  }
+
+  if(fbk->protocol_data.uci.searching)
+  {
+    FBK_ERROR_MSG("Cannot set option %s while searching.", input);
+    ret_val = false;
+  }
+  else if((strcmp(FBK_UCI_OPTION_THREADS, input) == 0) && (value != NULL))
+  {
+    const long threads = atol(value);
+    if((threads >= 1) && (threads <= FBK_UCI_MAX_THREADS))
+    {
+      /* An explicit thread count overrides automatic sizing */
+      fbk->config.auto_worker_threads = false;
+      fbk_update_worker_thread_count(threads);
+    }
+    else
+    {
+      ret_val = false;
+    }
+  }
+  else if((strcmp(FBK_UCI_OPTION_AUTO_THREADS, input) == 0) && (value != NULL))
+  {
+    fbk->config.auto_worker_threads = (strcmp("true", value) == 0);
+    if(fbk->config.auto_worker_threads)
+    {
+      fbk_update_worker_thread_count(fbk_get_available_core_count());
+    }
+  }
+  else if((strcmp(FBK_UCI_OPTION_HASH, input) == 0) && (value != NULL))
+  {
+    const long size_mb = atol(value);
+    if((size_mb >= 0) && (size_mb <= FBK_MAX_EVAL_CACHE_SIZE_MB))
+    {
+      /* Workers must not probe the cache while it is replaced */
+      fbk_stop_analysis(false);
+      fbk_init_eval_cache(size_mb);
+    }
+    else
+    {
+      ret_val = false;
+    }
+  }
+  else if((strcmp(FBK_UCI_OPTION_THINKING_OUTPUT_INTERVAL, input) == 0) && (value != NULL))
+  {
+    const long interval = atol(value);
+    if((interval >= 0) && (interval <= FBK_MAX_THINKING_OUTPUT_INTERVAL_MS))
+    {
+      fbk->config.thinking_output_interval = interval;
+    }
+    else
+    {
+      ret_val = false;
+    }
+  }
+  else if(strcmp(FBK_UCI_OPTION_PONDER, input) == 0)
+  {
+    /* Pondering is driven by 'go ponder', nothing to configure */
+  }
+  else
+  {
+    ret_val = false;
   }
+
+  return ret_val;
 }
 
 /**
  * @brief Process input string with UCI protocol
- * 
+ *
  * @param fbk Fly by Knight instance data
  * @param input Input string from external process
  * @return true if input handled
@@ -104,24 +579,80 @@ bool fbk_process_uci_input(fbk_instance_s *fbk, char * input)
   {
     FBK_OUTPUT_MSG("readyok\n");
   }
-  else if(strncmp("position", input, 8) == 0)
+  else if(strncmp("position ", input, 9) == 0)
   {
     fbk_process_uci_position_command(fbk, &input[9]);
   }
   else if(strcmp("stop", input) == 0)
   {
-    //TODO stop ongoing analysis, reset decision maker
-    //TODO return best move and best response (ponder) from decision maker
-    FBK_OUTPUT_MSG("bestmove 0000\n");
+    if(fbk->protocol_data.uci.searching)
+    {
+      if(fbk->protocol_data.uci.pondering)
+      {
+        /* Opponent played a different move than predicted.  Nothing is committed below the predicted move so the next 
+           position can take it back and keep the tree, the best move so far is only reported */
+        fbk_stop_picker();
+        fbk_stop_analysis(false);
+        fbk->protocol_data.uci.searching = false;
+        fbk->protocol_data.uci.pondering = false;
+
+        ftk_move_s missed_move;
+        ftk_invalidate_move(&missed_move);
+        fbk_mutex_lock(&fbk->game_lock);
+        fbk_resolve_ponder(fbk, &missed_move);
+        const ftk_move_s best_move = fbk_get_expected_reply(fbk);
+        fbk_mutex_unlock(&fbk->game_lock);
+
+        char move_output[FTK_MOVE_STRING_SIZE] = "0000";
+        if(FTK_MOVE_VALID(best_move))
+        {
+          ftk_move_to_xboard_string(&best_move, move_output);
+        }
+        FBK_OUTPUT_MSG("bestmove %s\n", move_output);
+      }
+      else
+      {
+        /* Picker reports the best move found so far */
+        const fbk_picker_trigger_s trigger =
+        {
+          .type = FBK_PICKER_TRIGGER_FORCED,
+        };
+        fbk_trigger_picker(&trigger);
+      }
+    }
+  }
+  else if(strcmp("ponderhit", input) == 0)
+  {
+    if(fbk->protocol_data.uci.searching && fbk->protocol_data.uci.pondering)
+    {
+      /* The predicted move was played, continue as a normal search on the engine's clock with the ponder time credited */
+      fbk_mutex_lock(&fbk->game_lock);
+      fbk_resolve_ponder(fbk, &fbk->ponder.predicted_move);
+      fbk->time_control.infinite = false;
+      clock_gettime(CLOCK_MONOTONIC, &fbk->last_move_time);
+      fbk_mutex_unlock(&fbk->game_lock);
+      fbk->protocol_data.uci.pondering = false;
+    }
   }
   else if(strcmp("ucinewgame", input) == 0)
   {
-    //TODO stop ongoing analysis, reset decision maker, flush analysis
     fbk_begin_standard_game(fbk, true);
+    free(fbk->protocol_data.uci.position_base);
+    fbk->protocol_data.uci.position_base = NULL;
+    fbk_mutex_lock(&fbk->game_lock);
+    fbk_reset_time_control(&fbk->time_control);
+    fbk_mutex_unlock(&fbk->game_lock);
+  }
+  else if((strcmp("go", input) == 0) || (strncmp("go ", input, 3) == 0))
+  {
+    fbk_process_uci_go_command(fbk, &input[2]);
   }
-  else if(strcmp("go", input) == 0)
+  else if(strncmp("setoption name ", input, 15) == 0)
   {
-    //TODO start analysis and decision maker based on GUI's instructions
+    if(false == fbk_process_uci_setoption_command(fbk, &input[15]))
+    {
+      FBK_OUTPUT_MSG("info string Unknown option or invalid value: %s\n", &input[15]);
+    }
   }
   else if(strcmp("debug on", input) == 0)
   {
@@ -138,4 +669,4 @@ bool fbk_process_uci_input(fbk_instance_s *fbk, char * input)
   }
 
   return input_handled;
-}
\ No newline at end of file
+}
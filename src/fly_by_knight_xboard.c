@@ -7,18 +7,27 @@
  xboard protocol interpreting for Fly by Knight
 */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <farewell_to_king.h>
 #include <farewell_to_king_strings.h>
 
+#include "fly_by_knight_affinity.h"
 #include "fly_by_knight_analysis_worker.h"
 #include "fly_by_knight_debug.h"
 #include "fly_by_knight_error.h"
 #include "fly_by_knight_pick.h"
+#include "fly_by_knight_time.h"
 #include "fly_by_knight_version.h"
 #include "fly_by_knight_xboard.h"
 
+/* Names of engine-defined options exposed to the GUI */
+#define FBK_XBOARD_OPTION_AUTO_WORKER_THREADS      "Auto Worker Threads"
+#define FBK_XBOARD_OPTION_PIN_WORKER_THREADS       "Pin Worker Threads"
+#define FBK_XBOARD_OPTION_THINKING_OUTPUT_INTERVAL "Thinking Output Interval"
+
 /**
  * @brief Initialized FBK for xboard
  * 
@@ -43,7 +52,7 @@ void fbk_init_xboard_protocol(fbk_instance_s *fbk)
  */
 void fbk_xboard_config_features(fbk_instance_s *fbk)
 {
-  FBK_UNUSED(fbk);
+  FBK_ASSERT_MSG(fbk != NULL, "NULL fbk pointer passed.");
 
   FBK_OUTPUT_MSG("feature done=0\n"
                  "feature ping=1\n"
@@ -51,7 +60,7 @@ void fbk_xboard_config_features(fbk_instance_s *fbk)
                  "feature playother=1\n"
                  "feature san=0\n"
                  "feature usermove=0\n"
-                 "feature time=0\n"
+                 "feature time=1\n"
                  "feature draw=0\n"
                  "feature sigint=0\n"
                  "feature sigterm=0\n"
@@ -63,19 +72,109 @@ void fbk_xboard_config_features(fbk_instance_s *fbk)
                  "feature ics=0\n"
                  "feature name=1\n"
                  "feature pause=0\n"
-                 "feature nps=0\n"
+                 "feature nps=1\n"
                  "feature debug=1\n"
                  "feature memory=0\n"
                  "feature smp=1\n"
                //"feature egt=null\n"
-               //"feature option=null\n"
-                 "feature exclude=0\n"
+                );
+  FBK_OUTPUT_MSG("feature option=\"" FBK_XBOARD_OPTION_AUTO_WORKER_THREADS " -check %u\"\n", fbk->config.auto_worker_threads?1:0);
+  FBK_OUTPUT_MSG("feature option=\"" FBK_XBOARD_OPTION_PIN_WORKER_THREADS " -check %u\"\n", fbk->config.pin_worker_threads?1:0);
+  FBK_OUTPUT_MSG("feature option=\"" FBK_XBOARD_OPTION_THINKING_OUTPUT_INTERVAL " -spin %ld 0 %d\"\n",
+                 (long) fbk->config.thinking_output_interval, FBK_MAX_THINKING_OUTPUT_INTERVAL_MS);
+  FBK_OUTPUT_MSG("feature exclude=0\n"
                  "feature setscore=0\n"
                  "feature highlight=0\n"
                  "feature done=1\n"
                 );
 }
 
+/**
+ * @brief Handle engine-defined option set by the GUI
+ * 
+ * @param fbk 
+ * @param input option string in the form 'NAME=VALUE'
+ * @return true if option is known
+ */
+bool fbk_xboard_process_option(fbk_instance_s *fbk, char * input)
+{
+  bool input_handled = true;
+  char * value = strchr(input, '=');
+
+  FBK_ASSERT_MSG(fbk != NULL, "NULL fbk pointer passed.");
+
+  if(NULL == value)
+  {
+    input_handled = false;
+  }
+  else if(((size_t)(value-input) == strlen(FBK_XBOARD_OPTION_AUTO_WORKER_THREADS)) &&
+          (strncmp(FBK_XBOARD_OPTION_AUTO_WORKER_THREADS, input, value-input) == 0))
+  {
+    fbk->config.auto_worker_threads = (0 != atoi(&value[1]));
+    if(fbk->config.auto_worker_threads)
+    {
+      fbk_update_worker_thread_count(fbk_get_available_core_count());
+    }
+  }
+  else if(((size_t)(value-input) == strlen(FBK_XBOARD_OPTION_PIN_WORKER_THREADS)) &&
+          (strncmp(FBK_XBOARD_OPTION_PIN_WORKER_THREADS, input, value-input) == 0))
+  {
+    fbk_set_worker_thread_pinning(0 != atoi(&value[1]));
+  }
+  else if(((size_t)(value-input) == strlen(FBK_XBOARD_OPTION_THINKING_OUTPUT_INTERVAL)) &&
+          (strncmp(FBK_XBOARD_OPTION_THINKING_OUTPUT_INTERVAL, input, value-input) == 0))
+  {
+    const long interval = atol(&value[1]);
+    input_handled = (interval >= 0) && (interval <= FBK_MAX_THINKING_OUTPUT_INTERVAL_MS);
+    if(input_handled)
+    {
+      fbk->config.thinking_output_interval = interval;
+    }
+  }
+  else
+  {
+    input_handled = false;
+  }
+
+  return input_handled;
+}
+
+/**
+ * @brief Handle 'level MPS BASE INC' command.  BASE is minutes or 'minutes:seconds' and INC is seconds
+ * 
+ * @param fbk 
+ * @param input arguments following 'level'
+ * @return true if arguments are valid
+ */
+bool fbk_xboard_process_level(fbk_instance_s *fbk, const char * input)
+{
+  bool          ret_val = false;
+  unsigned int  moves_per_period;
+  char          base_string[32];
+  double        increment;
+
+  if(3 == sscanf(input, "%u %31s %lf", &moves_per_period, base_string, &increment))
+  {
+    char *        end;
+    fbk_time_ms_t base_time = strtol(base_string, &end, 10)*60*1000;
+
+    if(':' == *end)
+    {
+      base_time += strtol(&end[1], &end, 10)*1000;
+    }
+
+    if(('\0' == *end) && (base_time >= 0) && (increment >= 0))
+    {
+      fbk_mutex_lock(&fbk->game_lock);
+      fbk_set_time_control_level(&fbk->time_control, moves_per_period, base_time, (fbk_time_ms_t) (increment*1000));
+      fbk_mutex_unlock(&fbk->game_lock);
+      ret_val = true;
+    }
+  }
+
+  return ret_val;
+}
+
 /**
  * @brief Handle rejected features
  * 
@@ -219,15 +318,25 @@ bool fbk_process_xboard_input_normal_mode(fbk_instance_s *fbk, char * input, siz
   }
   else if(strncmp("cores", input, 5) == 0)
   {
-    if(input_length > 6)
+    const int cores = (input_length > 6)?atoi(&input[6]):0;
+    if(cores >= 1)
     {
-      fbk_update_worker_thread_count(atoi(&input[6]));
+      /* The GUI's core limit is an upper bound, never start more workers than cores available to this process */
+      const unsigned int available_cores = fbk_get_available_core_count();
+      fbk_update_worker_thread_count(((unsigned int) cores < available_cores)?(unsigned int) cores:available_cores);
     }
     else
     {
       FBK_OUTPUT_MSG("Error (too few parameters): %s\n", input);
     }
   }
+  else if(strncmp("option", input, 6) == 0)
+  {
+    if((input_length <= 7) || (false == fbk_xboard_process_option(fbk, &input[7])))
+    {
+      FBK_OUTPUT_MSG("Error (unknown option): %s\n", input);
+    }
+  }
   else if(strncmp("name", input, 4) == 0)
   {
     if(input_length > 5)
@@ -239,6 +348,44 @@ bool fbk_process_xboard_input_normal_mode(fbk_instance_s *fbk, char * input, siz
       FBK_OUTPUT_MSG("Error (too few parameters): %s\n", input);
     }
   }
+  else if(strncmp("level", input, 5) == 0)
+  {
+    if((input_length <= 6) || (false == fbk_xboard_process_level(fbk, &input[6])))
+    {
+      FBK_OUTPUT_MSG("Error (bad parameters): %s\n", input);
+    }
+  }
+  else if(strncmp("st ", input, 3) == 0)
+  {
+    fbk_mutex_lock(&fbk->game_lock);
+    fbk_set_time_control_move_time(&fbk->time_control, (fbk_time_ms_t) (atof(&input[3])*1000));
+    fbk_mutex_unlock(&fbk->game_lock);
+  }
+  else if(strncmp("sd ", input, 3) == 0)
+  {
+    fbk_mutex_lock(&fbk->game_lock);
+    fbk->time_control.max_depth = atoi(&input[3]);
+    fbk_mutex_unlock(&fbk->game_lock);
+  }
+  else if(strncmp("time ", input, 5) == 0)
+  {
+    /* Clocks are given in centiseconds */
+    fbk_mutex_lock(&fbk->game_lock);
+    fbk->time_control.engine_time = atol(&input[5])*10;
+    fbk_mutex_unlock(&fbk->game_lock);
+  }
+  else if(strncmp("otim ", input, 5) == 0)
+  {
+    fbk_mutex_lock(&fbk->game_lock);
+    fbk->time_control.opponent_time = atol(&input[5])*10;
+    fbk_mutex_unlock(&fbk->game_lock);
+  }
+  else if(strncmp("nps ", input, 4) == 0)
+  {
+    fbk_mutex_lock(&fbk->game_lock);
+    fbk->time_control.nodes_per_second = strtoull(&input[4], NULL, 10);
+    fbk_mutex_unlock(&fbk->game_lock);
+  }
   else if(strcmp("edit", input) == 0)
   {
     FBK_DEBUG_MSG(FBK_DEBUG_HIGH, "Entering xboard edit mode");
@@ -248,6 +395,9 @@ bool fbk_process_xboard_input_normal_mode(fbk_instance_s *fbk, char * input, siz
   else if(strcmp("new", input) == 0)
   {
     fbk_begin_standard_game(fbk, false);
+    fbk_mutex_lock(&fbk->game_lock);
+    fbk_reset_time_control(&fbk->time_control);
+    fbk_mutex_unlock(&fbk->game_lock);
 
     fbk->protocol_data.xboard.mode    = FBK_XBOARD_MODE_WAITING;
     fbk->protocol_data.xboard.play_as = FTK_COLOR_BLACK;
@@ -329,7 +479,7 @@ bool fbk_process_xboard_input_normal_mode(fbk_instance_s *fbk, char * input, siz
 
           if(FTK_MOVE_VALID(move))
           {
-            fbk_stop_analysis(true);
+            fbk_stop_analysis(false);
             FBK_ASSERT_MSG(true == fbk_commit_move(fbk, &move), "Failed to commit move (%u->%u)", move.source, move.target);
           }
           else
@@ -427,7 +577,15 @@ bool manage_xboard_analysis(fbk_instance_s * fbk)
   if( (FBK_XBOARD_MODE_NORMAL == fbk->protocol_data.xboard.mode) &&
       ((fbk->game.turn == fbk->protocol_data.xboard.play_as) || fbk->protocol_data.xboard.ponder))
   {
-    fbk_start_analysis(&fbk->game, fbk->move_tree.current);
+    if((fbk->game.turn == fbk->protocol_data.xboard.play_as) || (FTK_COLOR_NONE == fbk->protocol_data.xboard.play_as))
+    {
+      fbk_start_analysis(&fbk->game, fbk->move_tree.current);
+    }
+    else
+    {
+      /* Opponent's turn, ponder on the predicted reply */
+      fbk_start_pondering(fbk);
+    }
     ret_val = true;
   }
   else
@@ -481,17 +639,41 @@ void xboard_pick_callback(ftk_game_end_e game_result, ftk_move_s move, void * us
   manage_xboard_analysis(fbk);
 }
 
-#define THINKING_OUTPUT_BUFFER_SIZE 1024
 #define SCORE_OUTPUT_BUFFER_SIZE           1024
 
-void xboard_best_line_callback(const fbk_picker_best_line_s * best_line, void * user_data)
+/**
+ * @brief Renders best line in SAN, only when the line changed since last rendered
+ * 
+ * @param xboard    xboard protocol data holding the rendered line
+ * @param best_line best line to render
+ */
+static void render_thinking_line(fbk_xboard_data_s * xboard, const fbk_picker_best_line_s * best_line)
 {
-  FBK_UNUSED(user_data);
+  if(xboard->thinking_line_sequence != best_line->line_sequence)
+  {
+    const fbk_picker_best_line_node_s * best_line_node = best_line->first_move;
+    size_t                              length         = 0;
+    ftk_game_s                          game           = best_line->game;
+
+    xboard->thinking_line[0] = '\0';
+    while((best_line_node != NULL) && (length < FBK_XBOARD_THINKING_LINE_SIZE))
+    {
+      char move_output[FTK_SAN_MOVE_STRING_SIZE] = "@@@@";
+      ftk_move_to_san_string(&game, &best_line_node->move, move_output);
+      FBK_ASSERT_MSG(FTK_SUCCESS == ftk_move_forward(&game, &best_line_node->move), "Failed to apply move.");
+
+      length += snprintf(&xboard->thinking_line[length], (FBK_XBOARD_THINKING_LINE_SIZE-length), " %s", move_output);
 
-  const fbk_picker_best_line_node_s * best_line_node = best_line->first_move;
+      best_line_node = best_line_node->next_move;
+    }
+    xboard->thinking_line_sequence = best_line->line_sequence;
+  }
+}
 
-  char thinking_output_buffer[THINKING_OUTPUT_BUFFER_SIZE] = {'\0'};
-  size_t thinking_output_buffer_length = 0;
+void xboard_best_line_callback(const fbk_picker_best_line_s * best_line, void * user_data)
+{
+  FBK_ASSERT_MSG(user_data != NULL,"NULL user data pointer passed");
+  fbk_instance_s *fbk = (fbk_instance_s *) user_data;
 
   char score_output_buffer[SCORE_OUTPUT_BUFFER_SIZE] = {'\0'};
 
@@ -543,30 +725,17 @@ void xboard_best_line_callback(const fbk_picker_best_line_s * best_line, void *
 
   uint_fast64_t nodes_per_second = (best_line->search_time > 0)?((best_line->searched_node_count*1000)/best_line->search_time):0;
 
-  thinking_output_buffer_length += snprintf(thinking_output_buffer, THINKING_OUTPUT_BUFFER_SIZE, "%lu %s %lu %lu %lu %lu %lu\t",
-                                            best_line->analysis_data.best_child_depth+1,
-                                            score_output_buffer,
-                                            best_line->search_time/10,
-                                            best_line->searched_node_count,
-                                            best_line->analysis_data.max_depth+1,
-                                            nodes_per_second,
-                                            best_line->tbhits);
-
-  ftk_game_s game = best_line->game;
-  while((best_line_node != NULL) && (thinking_output_buffer_length < THINKING_OUTPUT_BUFFER_SIZE))
-  {
-    char move_output[FTK_SAN_MOVE_STRING_SIZE] = "@@@@";
-    ftk_move_to_san_string(&game, &best_line_node->move, move_output);
-    FBK_ASSERT_MSG(FTK_SUCCESS == ftk_move_forward(&game, &best_line_node->move), "Failed to apply move.");
-
-    thinking_output_buffer_length += snprintf(&thinking_output_buffer[thinking_output_buffer_length], 
-                                              (THINKING_OUTPUT_BUFFER_SIZE-thinking_output_buffer_length), 
-                                              " %s", move_output);
-
-    best_line_node = best_line_node->next_move;
-  }
-
-  FBK_OUTPUT_MSG("%s\n", thinking_output_buffer);
+  render_thinking_line(&fbk->protocol_data.xboard, best_line);
+
+  FBK_OUTPUT_MSG("%lu %s %lu %lu %lu %lu %lu\t%s\n",
+                 best_line->analysis_data.best_child_depth+1,
+                 score_output_buffer,
+                 best_line->search_time/10,
+                 best_line->searched_node_count,
+                 best_line->analysis_data.max_depth+1,
+                 nodes_per_second,
+                 best_line->tbhits,
+                 fbk->protocol_data.xboard.thinking_line);
 }
 
 /**
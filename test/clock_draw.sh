@@ -0,0 +1,45 @@
+#!/bin/bash
+# Halfmove clock test.  Analyzes one position with a halfmove clock where its moves reach the fifty and seventy-five move
+# limits, then the same position with a fresh clock.  Draws found in the first runs must not be reused for the second,
+# where white is a queen up and has to be scored as winning.
+#
+# Usage: clock_draw.sh <flybyknight executable> [seconds per analysis]
+
+ENGINE="$1"
+ANALYSIS_SECONDS="${2:-1}"
+
+if [ ! -x "$ENGINE" ]; then
+  echo "Usage: $0 <flybyknight executable> [seconds per analysis]"
+  exit 2
+fi
+
+POSITION="7k/8/8/8/8/8/8/KQ6 w -"
+
+# Analyzes position after given FEN clocks, marking the start of the output with 'pong N'
+analyze()
+{
+  echo "setboard $POSITION - $1"
+  echo "ping $2"
+  echo "analyze"
+  sleep "$ANALYSIS_SECONDS"
+  echo "force"
+}
+
+output=$( (echo "xboard"; echo "protover 2"; echo "post"; echo "force"
+           analyze "99 100"  1
+           analyze "149 150" 2
+           analyze "0 1"     3
+           echo "quit") | "$ENGINE")
+
+# Score of the last thinking line after the fresh clock position was set up
+score=$(echo "$output" | sed -n '/^pong 3/,$p' | grep -E "^[0-9]+ -?[0-9]+ " | tail -n 1 | cut -d ' ' -f 2)
+
+if [ -z "$score" ]; then
+  echo "FAIL: no thinking output for the position with a fresh halfmove clock"
+  exit 1
+elif [ "$score" -le 100 ]; then
+  echo "FAIL: position with a fresh halfmove clock scored $score, draws from a higher clock were reused"
+  exit 1
+fi
+
+echo "ok: position with a fresh halfmove clock scored $score"
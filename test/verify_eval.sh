@@ -0,0 +1,59 @@
+#!/bin/bash
+# Differential evaluation test.  From the starting position and every FEN in the positions directory, 'verify eval'
+# compares the incremental evaluation against a full board scan over random playouts, once per evaluation instruction
+# set.  Instruction sets the machine does not support fall back to the best supported one.
+#
+# Usage: verify_eval.sh <flybyknight executable> <positions directory> [positions per playout]
+
+ENGINE="$1"
+POSITIONS_DIR="$2"
+PLAYOUT_POSITIONS="${3:-2000}"
+
+if [ ! -x "$ENGINE" ] || [ ! -d "$POSITIONS_DIR" ]; then
+  echo "Usage: $0 <flybyknight executable> <positions directory> [positions per playout]"
+  exit 2
+fi
+
+failures=0
+
+# Runs 'verify eval' from given FEN, or the starting position if empty, and checks the result
+verify()
+{
+  local level="$1"
+  local fen="$2"
+  local setboard=""
+  if [ -n "$fen" ]; then
+    setboard="setboard $fen"
+  fi
+
+  local output
+  output=$(printf "xboard\nprotover 2\nforce\n%s\nverify eval %s\nquit\n" "$setboard" "$PLAYOUT_POSITIONS" | "$ENGINE" --simd="$level")
+  local result
+  result=$(echo "$output" | grep "# Verified evaluation")
+
+  if [ -z "$result" ]; then
+    echo "FAIL ($level) ${fen:-startpos}: no verification result"
+    failures=$((failures+1))
+  elif ! echo "$result" | grep -q " 0 mismatches"; then
+    echo "FAIL ($level) ${fen:-startpos}: $result"
+    failures=$((failures+1))
+  else
+    echo "ok   ($level) ${fen:-startpos}: $result"
+  fi
+}
+
+for level in scalar popcnt avx2 neon; do
+  verify "$level" ""
+  for file in "$POSITIONS_DIR"/*.fen; do
+    while IFS= read -r fen || [ -n "$fen" ]; do
+      if [ -n "$fen" ]; then
+        verify "$level" "$fen"
+      fi
+    done < "$file"
+  done
+done
+
+if [ "$failures" -gt 0 ]; then
+  echo "$failures evaluation verifications failed"
+  exit 1
+fi